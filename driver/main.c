@@ -56,8 +56,10 @@ const char HELP[] =
 #include <string.h>
 #include <errno.h>
 #include <assert.h>
+#include <stdint.h>
 
 #include <sys/types.h>
+#include <sys/stat.h>
 #ifdef HAVE_SYS_WAIT_H
 #include <sys/wait.h>
 #endif
@@ -169,6 +171,13 @@ char*compiled_defines_path = 0;
 
 static char iconfig_common_path[4096] = "";
 
+/* The compile cache directory (from IVERILOG_CACHE) if the cache is
+   in use for this compile, and the temporary files that it uses. */
+static const char*cache_dir = 0;
+static char*cache_pp_path = 0;
+static char*cache_deps_path = 0;
+static char*cache_err_path = 0;
+
 int synth_flag = 0;
 int verbose_flag = 0;
 
@@ -344,7 +353,7 @@ static int t_version_only(void)
       return 0;
 }
 
-static void build_preprocess_command(int e_flag)
+static void build_preprocess_command(int e_flag, int pipe_flag)
 {
       snprintf(tmp, sizeof tmp, "%s%civlpp %s%s%s -F\"%s\" -f\"%s\" -p\"%s\"%s",
 	       ivlpp_dir, sep,
@@ -354,7 +363,7 @@ static void build_preprocess_command(int e_flag)
                strchr(warning_flags, 'R') ? " -Wredef-chg " : "",
                defines_path, source_path,
 	       compiled_defines_path,
-	       e_flag ? "" : " | ");
+	       pipe_flag ? " | " : "");
 }
 
 static int t_preprocess_only(void)
@@ -363,7 +372,7 @@ static int t_preprocess_only(void)
       char*cmd;
       unsigned ncmd;
 
-      build_preprocess_command(1);
+      build_preprocess_command(1, 0);
 
       ncmd = strlen(tmp);
       cmd = malloc(ncmd+1);
@@ -408,6 +417,411 @@ static int t_preprocess_only(void)
       return 0;
 }
 
+/*
+ * The compile cache keeps the output of each compile in the directory
+ * named by the IVERILOG_CACHE environment variable. A compile with the
+ * cache first preprocesses the source into a temporary file, then makes
+ * a key from the preprocessed text and from everything else that ivl
+ * reads: the iconfig and target configuration, the system function
+ * tables, the defines (which the library files are preprocessed with)
+ * and the ivl program and target module themselves. If the cache has
+ * an output for the key, it is copied to the output file, the messages
+ * that ivl printed are printed again, and ivl is not run at all.
+ *
+ * The modules that ivl loads from the library directories are not in
+ * the preprocessed text. ivl lists them in a dependency file, and the
+ * cache keeps the list, with a hash of each file, next to the output.
+ * An output is only reused if the library files are all unchanged.
+ */
+typedef struct cache_hash_s {
+      uint64_t a, b;
+} cache_hash_t;
+
+static void cache_hash_init(cache_hash_t*hash)
+{
+      hash->a = 0xcbf29ce484222325ULL;
+      hash->b = 0x9e3779b97f4a7c15ULL;
+}
+
+/*
+ * The first half is FNV-1a, and the second half is a different
+ * multiply and shift mix, so that a key is 128 bits wide.
+ */
+static void cache_hash_bytes(cache_hash_t*hash, const void*data, size_t len)
+{
+      const unsigned char*cp = (const unsigned char*)data;
+      for (size_t idx = 0 ; idx < len ; idx += 1) {
+	    hash->a = (hash->a ^ cp[idx]) * 0x100000001b3ULL;
+	    hash->b = (hash->b + cp[idx]) * 0xff51afd7ed558ccdULL;
+	    hash->b ^= hash->b >> 29;
+      }
+}
+
+static void cache_hash_string(cache_hash_t*hash, const char*text)
+{
+      cache_hash_bytes(hash, text, strlen(text)+1);
+}
+
+static void cache_hash_text(const cache_hash_t*hash, char*buf, size_t nbuf)
+{
+      snprintf(buf, nbuf, "%016llx%016llx",
+	       (unsigned long long)hash->a, (unsigned long long)hash->b);
+}
+
+static int cache_hash_file(cache_hash_t*hash, const char*path)
+{
+      char buf[MAXSIZE];
+      size_t len;
+      FILE*fd = fopen(path, "rb");
+      if (fd == 0)
+	    return -1;
+
+      while ((len = fread(buf, 1, sizeof buf, fd)) > 0)
+	    cache_hash_bytes(hash, buf, len);
+
+      fclose(fd);
+      cache_hash_string(hash, "");
+      return 0;
+}
+
+/*
+ * A rebuilt program of the same version may compile differently, so
+ * the size and time of the ivl program and of the target module are
+ * part of the key.
+ */
+static void cache_hash_program(cache_hash_t*hash, const char*path)
+{
+      struct stat sb;
+      char text[64];
+
+      if (stat(path, &sb) == 0) {
+	    snprintf(text, sizeof text, "%lld:%lld",
+		     (long long)sb.st_size, (long long)sb.st_mtime);
+	    cache_hash_string(hash, text);
+      } else {
+	    cache_hash_string(hash, "");
+      }
+}
+
+/*
+ * The iconfig file names the output file and the temporary files of
+ * this run. These lines are left out of the key.
+ */
+static int cache_skip_config_line(const char*text)
+{
+      return strncmp(text, "out:", 4) == 0
+	  || strncmp(text, "ivlpp:", 6) == 0
+	  || strncmp(text, "depfile:", 8) == 0
+	  || strncmp(text, "depmode:", 8) == 0;
+}
+
+/*
+ * The sys_func lines name the system function tables, and the DLL
+ * flag names the target module, so these files go into the key too.
+ * ivl looks for a relative target module in its own directory.
+ */
+static void cache_hash_config_file(cache_hash_t*hash, char*text)
+{
+      char*cp = strchr(text, '\n');
+      if (cp)
+	    *cp = 0;
+
+      if (strncmp(text, "sys_func:", 9) == 0) {
+	    cache_hash_file(hash, text+9);
+      } else if (strncmp(text, "flag:DLL=", 9) == 0) {
+	    if (text[9] == '/' || text[9] == '\\')
+		  cache_hash_program(hash, text+9);
+	    else {
+		  snprintf(tmp, sizeof tmp, "%s%c%s", base, sep, text+9);
+		  cache_hash_program(hash, tmp);
+	    }
+      }
+}
+
+static int cache_hash_config(cache_hash_t*hash, const char*path)
+{
+      char buf[MAXSIZE];
+      int bol = 1, skip = 0;
+      FILE*fd = fopen(path, "r");
+      if (fd == 0)
+	    return -1;
+
+      while (fgets(buf, sizeof buf, fd)) {
+	    size_t len = strlen(buf);
+	    int eol = len > 0 && buf[len-1] == '\n';
+	    if (bol)
+		  skip = cache_skip_config_line(buf);
+	    if (!skip)
+		  cache_hash_bytes(hash, buf, len);
+	    if (bol && eol && !skip)
+		  cache_hash_config_file(hash, buf);
+	    bol = eol;
+      }
+
+      fclose(fd);
+      cache_hash_string(hash, "");
+      return 0;
+}
+
+static void cache_make_key(char*key, size_t nkey)
+{
+      cache_hash_t hash;
+
+      cache_hash_init(&hash);
+      cache_hash_string(&hash, VERSION VERSION_TAG);
+
+      snprintf(tmp, sizeof tmp, "%s%civl", base, sep);
+      cache_hash_program(&hash, tmp);
+
+      cache_hash_config(&hash, iconfig_path);
+      cache_hash_config(&hash, iconfig_common_path);
+      cache_hash_file(&hash, defines_path);
+      cache_hash_file(&hash, cache_pp_path);
+      cache_hash_text(&hash, key, nkey);
+}
+
+static int copy_file(const char*src, const char*dst)
+{
+      char buf[MAXSIZE];
+      size_t len;
+      int rc = 0;
+      struct stat sb;
+
+      FILE*ifd = fopen(src, "rb");
+      if (ifd == 0)
+	    return -1;
+
+      FILE*ofd = fopen(dst, "wb");
+      if (ofd == 0) {
+	    fclose(ifd);
+	    return -1;
+      }
+
+      while ((len = fread(buf, 1, sizeof buf, ifd)) > 0) {
+	    if (fwrite(buf, 1, len, ofd) != len) {
+		  rc = -1;
+		  break;
+	    }
+      }
+
+      if (ferror(ifd))
+	    rc = -1;
+      fclose(ifd);
+      if (fclose(ofd) != 0)
+	    rc = -1;
+
+	/* The vvp output is executable, so keep the mode. */
+      if (rc == 0 && stat(src, &sb) == 0)
+	    chmod(dst, sb.st_mode & 0777);
+
+      return rc;
+}
+
+/*
+ * Print the messages that ivl wrote to its error file.
+ */
+static void print_file(const char*path, FILE*ofd)
+{
+      char buf[MAXSIZE];
+      size_t len;
+      FILE*ifd = fopen(path, "rb");
+      if (ifd == 0)
+	    return;
+
+      while ((len = fread(buf, 1, sizeof buf, ifd)) > 0)
+	    fwrite(buf, 1, len, ofd);
+
+      fclose(ifd);
+      fflush(ofd);
+}
+
+/*
+ * Return true if the library files that the cached output was made
+ * from (as listed in the .deps file) are all as they were.
+ */
+static int cache_deps_current(const char*deps_path)
+{
+      char buf[MAXSIZE];
+      char text[64];
+      int rc = 1;
+      FILE*fd = fopen(deps_path, "r");
+      if (fd == 0)
+	    return 0;
+
+      while (rc && fgets(buf, sizeof buf, fd)) {
+	    char*cp = strchr(buf, '\n');
+	    if (cp)
+		  *cp = 0;
+	    cp = strchr(buf, ' ');
+	    if (cp == 0) {
+		  rc = 0;
+		  break;
+	    }
+	    *cp++ = 0;
+
+	    cache_hash_t hash;
+	    cache_hash_init(&hash);
+	    if (cache_hash_file(&hash, cp) < 0) {
+		  rc = 0;
+		  break;
+	    }
+	    cache_hash_text(&hash, text, sizeof text);
+	    rc = strcmp(text, buf) == 0;
+      }
+
+      fclose(fd);
+      return rc;
+}
+
+static int cache_fetch(const char*key)
+{
+      char out_path[MAXSIZE];
+      char deps_path[MAXSIZE];
+      char err_path[MAXSIZE];
+
+      snprintf(out_path, sizeof out_path, "%s%c%s.out", cache_dir, sep, key);
+      snprintf(deps_path, sizeof deps_path, "%s%c%s.deps", cache_dir, sep, key);
+      snprintf(err_path, sizeof err_path, "%s%c%s.err", cache_dir, sep, key);
+
+      if (! cache_deps_current(deps_path))
+	    return 0;
+      if (copy_file(out_path, opath) < 0)
+	    return 0;
+
+      if (verbose_flag)
+	    printf("cache: reused %s\n", out_path);
+
+	/* Print the warnings of the compile that made the output. */
+      print_file(err_path, stderr);
+      return 1;
+}
+
+/*
+ * Save the output of a successful compile. The files are written
+ * under temporary names and renamed into place, so that compiles that
+ * run at the same time with the same cache never see part of a file.
+ */
+static void cache_store(const char*key)
+{
+      char out_path[MAXSIZE];
+      char deps_path[MAXSIZE];
+      char err_path[MAXSIZE];
+      char tmp_path[MAXSIZE+16];
+      char buf[MAXSIZE];
+      char text[64];
+
+#ifdef __MINGW32__
+      mkdir(cache_dir);
+#else
+      mkdir(cache_dir, 0777);
+#endif
+
+      snprintf(out_path, sizeof out_path, "%s%c%s.out", cache_dir, sep, key);
+      snprintf(deps_path, sizeof deps_path, "%s%c%s.deps", cache_dir, sep, key);
+      snprintf(err_path, sizeof err_path, "%s%c%s.err", cache_dir, sep, key);
+
+	/* The messages that ivl printed. These are saved first, so
+	   that an output is never reused without them. */
+      snprintf(tmp_path, sizeof tmp_path, "%s.%d", err_path, (int)getpid());
+      if (copy_file(cache_err_path, tmp_path) < 0) {
+	    remove(tmp_path);
+	    fprintf(stderr, "iverilog: cannot write to cache directory %s\n",
+		    cache_dir);
+	    return;
+      }
+      remove(err_path);
+      rename(tmp_path, err_path);
+
+	/* The library files that ivl loaded, and their hashes. */
+      snprintf(tmp_path, sizeof tmp_path, "%s.%d", deps_path, (int)getpid());
+      FILE*ofd = fopen(tmp_path, "w");
+      if (ofd == 0)
+	    return;
+
+      FILE*ifd = fopen(cache_deps_path, "r");
+      while (ifd && fgets(buf, sizeof buf, ifd)) {
+	    char*cp = strchr(buf, '\n');
+	    if (cp)
+		  *cp = 0;
+	    if (buf[0] == 0)
+		  continue;
+
+	    cache_hash_t hash;
+	    cache_hash_init(&hash);
+	    if (cache_hash_file(&hash, buf) < 0)
+		  continue;
+	    cache_hash_text(&hash, text, sizeof text);
+	    fprintf(ofd, "%s %s\n", text, buf);
+      }
+      if (ifd)
+	    fclose(ifd);
+      fclose(ofd);
+      remove(deps_path);
+      rename(tmp_path, deps_path);
+
+      snprintf(tmp_path, sizeof tmp_path, "%s.%d", out_path, (int)getpid());
+      if (copy_file(opath, tmp_path) < 0) {
+	    remove(tmp_path);
+	    remove(deps_path);
+	    return;
+      }
+      remove(out_path);
+      rename(tmp_path, out_path);
+
+      if (verbose_flag)
+	    printf("cache: saved %s\n", out_path);
+}
+
+/*
+ * Make an empty temporary file for the cache, and return its name, or
+ * nil if the file cannot be made.
+ */
+static char*cache_tempfile(const char*str)
+{
+      FILE*tmp_file = 0;
+      char*path = strdup(my_tempfile(str, &tmp_file));
+      if (tmp_file == 0) {
+	    free(path);
+	    return 0;
+      }
+      fclose(tmp_file);
+      return path;
+}
+
+static void cache_remove_tempfile(char**path)
+{
+      if (*path == 0)
+	    return;
+      remove(*path);
+      free(*path);
+      *path = 0;
+}
+
+static void cache_setup(void)
+{
+      cache_dir = getenv("IVERILOG_CACHE");
+      if (cache_dir && *cache_dir == 0)
+	    cache_dir = 0;
+      if (cache_dir == 0)
+	    return;
+
+      if (separate_compilation_flag || depfile || npath
+	  || strcmp(opath, "-") == 0) {
+	    cache_dir = 0;
+	    return;
+      }
+
+      cache_pp_path = cache_tempfile("ivrlp");
+      cache_deps_path = cache_tempfile("ivrld");
+      cache_err_path = cache_tempfile("ivrle");
+      if (cache_pp_path == 0 || cache_deps_path == 0 || cache_err_path == 0) {
+	    cache_remove_tempfile(&cache_pp_path);
+	    cache_remove_tempfile(&cache_deps_path);
+	    cache_remove_tempfile(&cache_err_path);
+	    cache_dir = 0;
+      }
+}
+
 /*
  * This is the default target type. It looks up the bits that are
  * needed to run the command from the configuration file (which is
@@ -415,12 +829,34 @@ static int t_preprocess_only(void)
  */
 static int t_compile(void)
 {
-      unsigned rc;
+      unsigned rc, pp_rc = 0;
+      int cache_hit = 0;
+      char cache_key[64];
+      char*pp_cmd = 0;
+
+	/* With the compile cache, the source is preprocessed into a
+	   file of its own, so that the key can be made from it. */
+      if (cache_dir) {
+	    build_preprocess_command(0, 0);
+	    rc = strlen(tmp);
+	    snprintf(tmp+rc, sizeof tmp - rc, " > \"%s\"", cache_pp_path);
+	    if (verbose_flag)
+		  printf("preprocess: %s\n", tmp);
+
+	    pp_rc = system(tmp);
+	    if (pp_rc != 0) {
+		  pp_cmd = strdup(tmp);
+		  cache_hit = -1;
+	    } else {
+		  cache_make_key(cache_key, sizeof cache_key);
+		  cache_hit = cache_fetch(cache_key);
+	    }
+      }
 
 	/* Start by building the preprocess command line, if required.
 	   This pipes into the main ivl command. */
-      if (!separate_compilation_flag)
-	    build_preprocess_command(0);
+      if (!separate_compilation_flag && !cache_dir)
+	    build_preprocess_command(0, 1);
       else
 	    strcpy(tmp, "");
 
@@ -469,6 +905,9 @@ static int t_compile(void)
 
       if (separate_compilation_flag)
 	    snprintf(tmp, sizeof tmp, " -F\"%s\"", source_path);
+      else if (cache_dir)
+	    snprintf(tmp, sizeof tmp, " -- - < \"%s\" 2> \"%s\"",
+		     cache_pp_path, cache_err_path);
       else
 	    snprintf(tmp, sizeof tmp, " -- -");
       rc = strlen(tmp);
@@ -477,12 +916,29 @@ static int t_compile(void)
       ncmd += rc;
 
 
-      if (verbose_flag)
+      if (verbose_flag && cache_hit == 0)
 	    printf("translate: %s\n", cmd);
 
 
-      rc = system(cmd);
+      if (cache_hit > 0) {
+	    rc = 0;
+      } else if (cache_hit < 0) {
+	    rc = pp_rc;
+      } else {
+	    rc = system(cmd);
+	      /* With the cache, the messages of ivl went to a file so
+		 that they can be saved with the output. */
+	    if (cache_dir) {
+		  print_file(cache_err_path, stderr);
+		  if (rc == 0)
+			cache_store(cache_key);
+	    }
+      }
+
       if ( ! getenv("IVERILOG_ICONFIG")) {
+	    cache_remove_tempfile(&cache_pp_path);
+	    cache_remove_tempfile(&cache_deps_path);
+	    cache_remove_tempfile(&cache_err_path);
 	    remove(source_path);
 	    free(source_path);
 	    remove(iconfig_path);
@@ -493,22 +949,31 @@ static int t_compile(void)
 	    free(compiled_defines_path);
       }
 #ifdef __MINGW32__  /* MinGW just returns the exit status, so return it! */
+      if (pp_cmd)
+	    fprintf(stderr, "errors preprocessing Verilog program.\n");
+      free(pp_cmd);
       free(cmd);
       return rc;
 #else
+	/* If the preprocessing for the cache failed, then ivl was
+	   not run, and the messages are about the preprocessor. */
+      const char*failed_cmd = pp_cmd? pp_cmd : cmd;
       rtn = 0;
       if (rc != 0) {
 	    if (rc == 127) {
-		  fprintf(stderr, "Failed to execute: %s\n", cmd);
+		  fprintf(stderr, "Failed to execute: %s\n", failed_cmd);
 		  rtn = 1;
 	    } else if (WIFEXITED(rc)) {
+		  if (pp_cmd)
+			fprintf(stderr, "errors preprocessing Verilog program.\n");
 		  rtn = WEXITSTATUS(rc);
 	    } else {
-		  fprintf(stderr, "Command signaled: %s\n", cmd);
+		  fprintf(stderr, "Command signaled: %s\n", failed_cmd);
 		  rtn = -1;
 	    }
       }
 
+      free(pp_cmd);
       free(cmd);
       return rtn;
 #endif
@@ -1239,6 +1704,17 @@ int main(int argc, char **argv)
             fprintf(iconfig_file, "depmode:%c\n", depmode);
       }
 
+	/* The compile cache only stands in for a plain compile of the
+	   whole source into an output file. When it is in use, ivl
+	   lists the library files that it loads in a temporary
+	   dependency file of the cache. */
+      if (e_flag == 0 && version_flag == 0)
+	    cache_setup();
+      if (cache_dir) {
+	    fprintf(iconfig_file, "depfile:%s\n", cache_deps_path);
+	    fprintf(iconfig_file, "depmode:a\n");
+      }
+
       while ( (command_filename = get_cmd_file()) ) {
 	    int rc;
 
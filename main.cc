@@ -199,6 +199,12 @@ unsigned long array_size_limit = 16777216;  // Minimum required by IEEE-1364?
 unsigned recursive_mod_limit = 10;
 bool disable_concatz_generation = false;
 
+/*
+ * The number of source files that are preprocessed at the same time
+ * when each file is preprocessed on its own. Zero means one per CPU.
+ */
+static unsigned preprocess_jobs = 0;
+
 /*
  * Verbose messages enabled.
  */
@@ -1084,11 +1090,17 @@ int main(int argc, char*argv[])
       flag_tmp = flags["DISABLE_CONCATZ_GENERATION"];
       if (flag_tmp) disable_concatz_generation = strcmp(flag_tmp,"true")==0;
 
-	/* Parse the input. Make the pform. */
-      int rc = 0;
-      for (unsigned idx = 0; idx < source_files.size(); idx += 1) {
-	    rc += pform_parse(source_files[idx]);
+      flag_tmp = flags["PREPROCESS_JOBS"];
+      if (flag_tmp) preprocess_jobs = strtoul(flag_tmp,NULL,0);
+#if defined(_SC_NPROCESSORS_ONLN)
+      if (preprocess_jobs == 0) {
+	    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+	    preprocess_jobs = ncpu > 0? ncpu : 1;
       }
+#endif
+
+	/* Parse the input. Make the pform. */
+      int rc = pform_parse_files(source_files, preprocess_jobs);
 
       if (pf_path) {
 	    ofstream out (pf_path);
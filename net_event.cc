@@ -120,90 +120,6 @@ unsigned NetEvent::nexpr() const
       return exprref_;
 }
 
-/*
- * A "similar" event is one that has an identical non-nil set of
- * probes.
- */
-void NetEvent::find_similar_event(list<NetEvent*>&event_list)
-{
-      if (probes_ == 0)
-	    return;
-
-      set<NetEvent*> candidate_events;
-
-	/* First, get a list of all the NetEvProbes that are connected
-	   to my first probe. Then use that to create a set of
-	   candidate events. These candidate events are a superset of
-	   the similar events, so I will be culling this list later. */
-      list<NetEvProbe*>first_probes;
-      probes_->find_similar_probes(first_probes);
-
-      for (list<NetEvProbe*>::iterator idx = first_probes.begin()
-		 ; idx != first_probes.end() ; ++ idx ) {
-
-	    candidate_events.insert( (*idx)->event() );
-      }
-
-      if (candidate_events.empty())
-	    return;
-
-	/* Now scan the remaining probes, in each case checking that
-	   the probe event is a candidate event. After each iteration,
-	   events that don't have a similar probe will be removed from
-	   the candidate_events set. If the candidate_events set
-	   becomes empty, then give up. */
-      unsigned probe_count = 1;
-      for (NetEvProbe*cur = probes_->enext_ ; cur;  cur = cur->enext_) {
-	    list<NetEvProbe*>similar_probes;
-	    cur->find_similar_probes(similar_probes);
-
-	    set<NetEvent*> candidate_tmp;
-	    for (list<NetEvProbe*>::iterator idx = similar_probes.begin()
-		       ; idx != similar_probes.end() ; ++ idx ) {
-
-		  NetEvent*tmp = (*idx)->event();
-		  if (candidate_events.find(tmp) != candidate_events.end())
-			candidate_tmp .insert(tmp);
-	    }
-
-	      // None of the candidate events match this probe? Give up!
-	    if (candidate_tmp.empty())
-		  return;
-
-	    candidate_events = candidate_tmp;
-	    probe_count += 1;
-      }
-
-        /* Scan the surviving candidate events. We know that they all
-	   have probes that match the current event's probes. Check
-	   for remaining compatibility details and save the survivors
-	   in the event_list that the caller passed. */
-      for (set<NetEvent*>::iterator idx = candidate_events.begin()
-		 ; idx != candidate_events.end() ; ++ idx ) {
-
-	    NetEvent*tmp = *idx;
-
-	      // This shouldn't be possible?
-	    if (tmp == this)
-		  continue;
-
-              /* For automatic tasks, the VVP runtime holds state for events
-                 in the automatically allocated context. This means we can't
-                 merge similar events in different automatic tasks. */
-            if (scope()->is_auto() && (tmp->scope() != scope()))
-                  continue;
-
-	    unsigned tcnt = 0;
-	    for (NetEvProbe*cur = tmp->probes_ ; cur ; cur = cur->enext_)
-		  tcnt += 1;
-
-	    if (tcnt == probe_count)
-		  event_list .push_back(tmp);
-      }
-
-}
-
-
 void NetEvent::replace_event(NetEvent*that)
 {
       while (wlist_) {
@@ -306,44 +222,6 @@ const NetEvent* NetEvProbe::event() const
       return event_;
 }
 
-/*
- * A similar NetEvProbe is one that is connected to all the same nexa
- * that this probe is connected to, and also is the same edge
- * type. Don't count myself as a similar probe.
- */
-void NetEvProbe::find_similar_probes(list<NetEvProbe*>&plist)
-{
-      Nexus*nex = pin(0).nexus();
-
-      for (Link*lcur = nex->first_nlink(); lcur; lcur = lcur->next_nlink()) {
-	    NetPins*obj = lcur->get_obj();
-	      // Skip NexusSet objects
-	    if (obj == 0)
-		  continue;
-
-	    if (obj->pin_count() != pin_count())
-		  continue;
-
-	    NetEvProbe*tmp = dynamic_cast<NetEvProbe*>(obj);
-	    if (tmp == 0)
-		  continue;
-
-	    if (tmp == this)
-		  continue;
-
-	    if (edge() != tmp->edge())
-		  continue;
-
-	    bool ok_flag = true;
-	    for (unsigned idx = 1 ;  ok_flag && idx < pin_count() ;  idx += 1)
-		  if (! pin(idx).is_linked(tmp->pin(idx)))
-			ok_flag = false;
-
-	    if (ok_flag == true)
-		  plist .push_back(tmp);
-      }
-}
-
 NetEvWait::NetEvWait(NetProc*pr)
 : statement_(pr)
 {
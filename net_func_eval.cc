@@ -21,6 +21,7 @@
 # include  "netmisc.h"
 # include  "compiler.h"
 # include  <typeinfo>
+# include  <cstdio>
 # include  "ivl_assert.h"
 
 using namespace std;
@@ -53,6 +54,70 @@ static NetExpr* fix_assign_value(const NetNet*lhs, NetExpr*rhs)
       return rhs;
 }
 
+/*
+ * Add a value to the key of the result cache. Return false if the
+ * value is not a constant.
+ */
+static bool add_cache_key(const NetExpr*value, string&key)
+{
+      if (const NetEConst*ce = dynamic_cast<const NetEConst*>(value)) {
+	    const verinum&val = ce->value();
+	    key += val.has_sign()? 's' : 'u';
+	    key += val.is_string()? 't' : 'v';
+	    for (unsigned bit = 0 ; bit < val.len() ; bit += 1)
+		  key += "01xz"[val.get(bit)];
+
+      } else if (const NetECReal*re = dynamic_cast<const NetECReal*>(value)) {
+	    char buf[64];
+	    snprintf(buf, sizeof buf, "r%a", re->value().as_double());
+	    key += buf;
+
+      } else {
+	    return false;
+      }
+      key += ',';
+      return true;
+}
+
+/*
+ * Make the key of the result cache from the argument values, after
+ * they are fitted to the ports, and from the values of the parameters
+ * that the function can read. Those are the parameters of the
+ * function scope and of the scopes around it, up to the module (or
+ * package or class) that holds the function. Return false if a value
+ * is not a constant, in which case the result is not cached.
+ */
+static bool make_cache_key(const NetScope*scope, const vector<NetExpr*>&values,
+			   string&key)
+{
+      for (size_t idx = 0 ; idx < values.size() ; idx += 1) {
+	    if (! add_cache_key(values[idx], key))
+		  return false;
+      }
+
+      for ( ; scope ; scope = scope->parent()) {
+	    key += ';';
+	    typedef map<perm_string,NetScope::param_expr_t>::const_iterator param_iter_t;
+	    for (param_iter_t cur = scope->parameters.begin()
+		       ; cur != scope->parameters.end() ; ++ cur) {
+		  if (! add_cache_key(cur->second.val, key))
+			return false;
+	    }
+
+	    if (scope->type() == NetScope::MODULE
+		|| scope->type() == NetScope::PACKAGE
+		|| scope->type() == NetScope::CLASS)
+		  break;
+      }
+      return true;
+}
+
+/*
+ * Functions that are called with many different arguments (table
+ * builders, for example) do not keep more than this many results.
+ */
+static const size_t RESULT_CACHE_LIMIT = 4096;
+
 NetExpr* NetFuncDef::evaluate_function(const LineInfo&loc, const std::vector<NetExpr*>&args) const
 {
 	// Make the context map.
@@ -64,23 +129,49 @@ NetExpr* NetFuncDef::evaluate_function(const LineInfo&loc, const std::vector<Net
 		 << "Evaluate function " << scope()->basename() << endl;
       }
 
+	// Fit the arguments to the ports. This takes over the
+	// argument expressions.
+      ivl_assert(loc, port_count() == args.size());
+      vector<NetExpr*> values (args.size());
+      for (size_t idx = 0 ; idx < port_count() ; idx += 1)
+	    values[idx] = fix_assign_value(port(idx), args[idx]);
+
+	// If the function was called with these values before, the
+	// result is already known.
+      string key;
+      bool cache_flag = make_cache_key(scope(), values, key);
+      if (cache_flag) {
+	    map<string,NetExpr*>::const_iterator hit = result_cache_.find(key);
+	    if (hit != result_cache_.end()) {
+		  for (size_t idx = 0 ; idx < values.size() ; idx += 1)
+			delete values[idx];
+		  if (debug_eval_tree) {
+			cerr << loc.get_fileline() << ": NetFuncDef::evaluate_function: "
+			     << "Reused result " << *hit->second << endl;
+		  }
+		  return hit->second->dup_expr();
+	    }
+      }
+
 	// Put the return value into the map...
       LocalVar&return_var = context_map[scope()->basename()];
       return_var.nwords = 0;
       return_var.value  = 0;
 
 	// Load the input ports into the map...
-      ivl_assert(loc, port_count() == args.size());
       for (size_t idx = 0 ; idx < port_count() ; idx += 1) {
 	    const NetNet*pnet = port(idx);
 	    perm_string aname = pnet->name();
 	    LocalVar&input_var = context_map[aname];
 	    input_var.nwords = 0;
-	    input_var.value  = fix_assign_value(pnet, args[idx]);
+	    input_var.value  = values[idx];
 
 	    if (debug_eval_tree) {
 		  cerr << loc.get_fileline() << ": NetFuncDef::evaluate_function: "
-		       << "   input " << aname << " = " << *args[idx] << endl;
+		       << "   input " << aname << " = ";
+		  if (values[idx]) cerr << *values[idx];
+		  else cerr << "<nil>";
+		  cerr << endl;
 	    }
       }
 
@@ -147,6 +238,8 @@ NetExpr* NetFuncDef::evaluate_function(const LineInfo&loc, const std::vector<Net
 		  else cerr << "<nil>";
 		  cerr << endl;
 	    }
+	    if (res && cache_flag && result_cache_.size() < RESULT_CACHE_LIMIT)
+		  result_cache_[key] = res->dup_expr();
 	    return res;
       }
 
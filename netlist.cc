@@ -2144,6 +2144,9 @@ NetFuncDef::NetFuncDef(NetScope*s, NetNet*result, const vector<NetNet*>&po,
 
 NetFuncDef::~NetFuncDef()
 {
+      for (map<string,NetExpr*>::iterator cur = result_cache_.begin()
+		 ; cur != result_cache_.end() ; ++ cur)
+	    delete cur->second;
 }
 
 const NetNet* NetFuncDef::return_sig() const
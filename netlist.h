@@ -3328,13 +3328,9 @@ class NetEvent : public LineInfo {
 
       void nex_output(NexusSet&);
 
-	// Locate the first event that matches my behavior and
-	// monitors the same signals.
-      void find_similar_event(list<NetEvent*>&);
-
 	// This method replaces pointers to me with pointers to
 	// that. It is typically used to replace similar events
-	// located by the find_similar_event method.
+	// found by the nodangle functor.
       void replace_event(NetEvent*that);
 
     private:
@@ -3461,8 +3457,6 @@ class NetEvProbe  : public NetNode {
       NetEvent* event();
       const NetEvent* event() const;
 
-      void find_similar_probes(list<NetEvProbe*>&);
-
       virtual bool emit_node(struct target_t*) const;
       virtual void dump_node(ostream&, unsigned ind) const;
 
@@ -3598,6 +3592,13 @@ class NetFuncDef : public NetBaseDef {
 
     private:
       NetNet*result_sig_;
+
+	// The results of the constant evaluations so far, keyed by the
+	// argument values and the values of the parameters that the
+	// function can see. A constant function has no state that
+	// lasts from one call to the next, so the same key always
+	// gives the same result.
+      mutable std::map<std::string,NetExpr*> result_cache_;
 };
 
 /*
@@ -28,6 +28,26 @@
 # include  "functor.h"
 # include  "netlist.h"
 # include  "compiler.h"
+# include  <algorithm>
+# include  <map>
+# include  <set>
+# include  <vector>
+
+/*
+ * Two events are similar if they have the same probes, and two probes
+ * are the same if they have the same edge and their pins are connected
+ * to the same nexa in the same order. (The first pass removes the
+ * duplicate probes of each event, so the probes of an event are all
+ * different.) The signature of an event is the sorted list of its
+ * probes, so similar events have equal signatures, and the events are
+ * grouped by their signature. That way each event finds the events
+ * that are similar to it without scanning all the probes on the nexa
+ * that it is connected to, which for a clock that thousands of
+ * processes wait on is slow.
+ */
+typedef pair<NetEvProbe::edge_t, vector<Nexus*> > probe_sig_t;
+typedef vector<probe_sig_t> event_sig_t;
+typedef map<event_sig_t, set<NetEvent*> > event_groups_t;
 
 class nodangle_f  : public functor_t {
     public:
@@ -38,8 +58,49 @@ class nodangle_f  : public functor_t {
       unsigned stotal, etotal;
       bool scontinue, econtinue;
       bool scomplete, ecomplete;
+
+    private:
+      void add_event_(NetEvent*ev);
+      void remove_event_(NetEvent*ev);
+
+      event_groups_t groups_;
+      map<NetEvent*,event_groups_t::iterator> group_of_;
 };
 
+void nodangle_f::add_event_(NetEvent*ev)
+{
+      if (ev->nprobe() == 0)
+	    return;
+
+      event_sig_t sig (ev->nprobe());
+      for (unsigned idx = 0 ;  idx < ev->nprobe() ;  idx += 1) {
+	    NetEvProbe*prb = ev->probe(idx);
+	    sig[idx].first = prb->edge();
+	    sig[idx].second.resize(prb->pin_count());
+	    for (unsigned pin = 0 ;  pin < prb->pin_count() ;  pin += 1)
+		  sig[idx].second[pin] = prb->pin(pin).nexus();
+      }
+      sort(sig.begin(), sig.end());
+
+      event_groups_t::iterator cur = groups_.find(sig);
+      if (cur == groups_.end())
+	    cur = groups_.insert(make_pair(sig, set<NetEvent*>())).first;
+      cur->second.insert(ev);
+      group_of_[ev] = cur;
+}
+
+void nodangle_f::remove_event_(NetEvent*ev)
+{
+      map<NetEvent*,event_groups_t::iterator>::iterator cur = group_of_.find(ev);
+      if (cur == group_of_.end())
+	    return;
+
+      cur->second->second.erase(ev);
+      if (cur->second->second.empty())
+	    groups_.erase(cur->second);
+      group_of_.erase(cur);
+}
+
 void nodangle_f::event(Design*, NetEvent*ev)
 {
       if (ecomplete) return;
@@ -48,6 +109,7 @@ void nodangle_f::event(Design*, NetEvent*ev)
 	   ahead and delete it. There is no use looking further at
 	   it. */
       if ((ev->nwait() + ev->ntrig() + ev->nexpr()) == 0) {
+	    remove_event_(ev);
 	    delete ev;
 	    etotal += 1;
 	    return;
@@ -92,6 +154,7 @@ void nodangle_f::event(Design*, NetEvent*ev)
                         }
                   }
             }
+            add_event_(ev);
             econtinue = true;
       } else {
               /* Postpone examining events in an automatic scope until the
@@ -108,15 +171,27 @@ void nodangle_f::event(Design*, NetEvent*ev)
                   }
             }
 
-              /* Try to find all the events that are similar to me, and
-                 replace their references with references to me. */
-            list<NetEvent*> match;
-            ev->find_similar_event(match);
-            for (list<NetEvent*>::iterator idx = match.begin()
+              /* Find all the events that are similar to me, and replace
+                 their references with references to me. */
+            map<NetEvent*,event_groups_t::iterator>::iterator grp = group_of_.find(ev);
+            if (grp == group_of_.end())
+                  return;
+
+            const set<NetEvent*>&match = grp->second->second;
+            for (set<NetEvent*>::const_iterator idx = match.begin()
                        ; idx != match.end() ; ++ idx ) {
 
                   NetEvent*tmp = *idx;
-                  assert(tmp != ev);
+                  if (tmp == ev)
+                        continue;
+
+                    /* For automatic tasks, the VVP runtime holds state
+                       for events in the automatically allocated context.
+                       This means we can't merge similar events in
+                       different automatic tasks. */
+                  if (ev->scope()->is_auto() && (tmp->scope() != ev->scope()))
+                        continue;
+
 		  tmp ->replace_event(ev);
             }
       }
@@ -58,6 +58,14 @@ extern void pform_dump(std::ostream&out, const PTaskFunc*tf);
  */
 extern int pform_parse(const char*path);
 
+/*
+ * Parse the source files in order. If each file is preprocessed on
+ * its own, the preprocessors of up to "jobs" files run ahead of the
+ * parser, at the same time.
+ */
+extern int pform_parse_files(const std::vector<perm_string>&files,
+			     unsigned jobs);
+
 extern string vl_file;
 
 extern void pform_set_timescale(int units, int prec, const char*file,
@@ -41,6 +41,7 @@
 # include  <cstring>
 # include  <cstdlib>
 # include  <cctype>
+# include  <unistd.h>
 
 # include  "ivl_assert.h"
 # include  "ivl_alloc.h"
@@ -3641,6 +3642,54 @@ void pform_add_modport_port(const struct vlltype&loc,
 FILE*vl_input = 0;
 extern void reset_lexor();
 
+/*
+ * Parse the source that is open in vl_input. The pipe_flag tells if
+ * vl_input is a pipe from the preprocessor or an ordinary file.
+ */
+static int pform_parse_input_(const char*path, bool pipe_flag)
+{
+      if (pform_units.empty() || separate_compilation) {
+	    char unit_name[20];
+	    static unsigned nunits = 0;
+	    if (separate_compilation)
+		  sprintf(unit_name, "$unit#%u", ++nunits);
+	    else
+		  sprintf(unit_name, "$unit");
+
+	    PPackage*unit = new PPackage(lex_strings.make(unit_name), 0);
+	    unit->default_lifetime = LexicalScope::STATIC;
+	    unit->set_file(filename_strings.make(path));
+	    unit->set_lineno(1);
+	    pform_units.push_back(unit);
+
+	    pform_set_timescale(def_ts_units, def_ts_prec, 0, 0);
+
+	    allow_timeunit_decl = true;
+	    allow_timeprec_decl = true;
+
+	    lexical_scope = unit;
+      }
+      reset_lexor();
+      error_count = 0;
+      warn_count = 0;
+      int rc = VLparse();
+
+      if (vl_input != stdin) {
+	    if (pipe_flag)
+		  pclose(vl_input);
+	    else
+		  fclose(vl_input);
+      }
+
+      if (rc) {
+	    cerr << "I give up." << endl;
+	    error_count += 1;
+      }
+
+      destroy_lexor();
+      return error_count;
+}
+
 int pform_parse(const char*path)
 {
       vl_file = path;
@@ -3675,44 +3724,154 @@ int pform_parse(const char*path)
 	    }
       }
 
-      if (pform_units.empty() || separate_compilation) {
-	    char unit_name[20];
-	    static unsigned nunits = 0;
-	    if (separate_compilation)
-		  sprintf(unit_name, "$unit#%u", ++nunits);
-	    else
-		  sprintf(unit_name, "$unit");
+      return pform_parse_input_(path, ivlpp_string != 0);
+}
 
-	    PPackage*unit = new PPackage(lex_strings.make(unit_name), 0);
-	    unit->default_lifetime = LexicalScope::STATIC;
-	    unit->set_file(filename_strings.make(path));
-	    unit->set_lineno(1);
-	    pform_units.push_back(unit);
+/*
+ * When the source files are preprocessed one at a time (separate
+ * compilation), the preprocessing of a file does not depend on the
+ * parse of the files before it. So the preprocessors of the next few
+ * files are started while the parser works on the current one, each
+ * writing into a temporary file. Only the preprocessing is overlapped;
+ * the files are still parsed one at a time in the order given, so the
+ * pform comes out exactly as if they were parsed with pform_parse(),
+ * one after the other. The messages of each preprocessor are held in
+ * a second temporary file and printed just before its file is parsed,
+ * so the diagnostics keep the order of the files.
+ */
+struct pform_prefetch_s {
+      pform_prefetch_s() : proc(0), tmp_path(0), err_path(0) { }
+      FILE*proc;
+      char*tmp_path;
+      char*err_path;
+};
+
+#if !defined(__MINGW32__)
+static char* pform_prefetch_tmp_(void)
+{
+      const char*tmpdir = getenv("TMPDIR");
+      if (tmpdir == 0)
+	    tmpdir = "/tmp";
+
+      char*path = (char*)malloc(strlen(tmpdir) + 16);
+      sprintf(path, "%s/ivlppXXXXXX", tmpdir);
+      int fd = mkstemp(path);
+      if (fd < 0) {
+	    free(path);
+	    return 0;
+      }
+      close(fd);
+      return path;
+}
 
-	    pform_set_timescale(def_ts_units, def_ts_prec, 0, 0);
+static void pform_prefetch_remove_(char*&path)
+{
+      if (path == 0)
+	    return;
 
-	    allow_timeunit_decl = true;
-	    allow_timeprec_decl = true;
+      remove(path);
+      free(path);
+      path = 0;
+}
 
-	    lexical_scope = unit;
+static void pform_prefetch_start_(pform_prefetch_s&cur, const char*path)
+{
+      if (strcmp(path, "-") == 0)
+	    return;
+
+      cur.tmp_path = pform_prefetch_tmp_();
+      cur.err_path = pform_prefetch_tmp_();
+      if (cur.tmp_path == 0 || cur.err_path == 0) {
+	    pform_prefetch_remove_(cur.tmp_path);
+	    pform_prefetch_remove_(cur.err_path);
+	    return;
       }
-      reset_lexor();
-      error_count = 0;
-      warn_count = 0;
-      int rc = VLparse();
 
-      if (vl_input != stdin) {
-	    if (ivlpp_string)
-		  pclose(vl_input);
-	    else
-		  fclose(vl_input);
+      char*cmdline = (char*)malloc(strlen(ivlpp_string) + strlen(path)
+				   + strlen(cur.tmp_path)
+				   + strlen(cur.err_path) + 16);
+      sprintf(cmdline, "%s \"%s\" > \"%s\" 2> \"%s\"", ivlpp_string,
+	      path, cur.tmp_path, cur.err_path);
+
+      if (verbose_flag)
+	    cerr << "Executing: " << cmdline << endl << flush;
+
+      cur.proc = popen(cmdline, "r");
+      free(cmdline);
+      if (cur.proc == 0) {
+	    pform_prefetch_remove_(cur.tmp_path);
+	    pform_prefetch_remove_(cur.err_path);
       }
+}
 
-      if (rc) {
-	    cerr << "I give up." << endl;
-	    error_count += 1;
+/*
+ * Copy the held messages of a preprocessor to stderr.
+ */
+static void pform_prefetch_messages_(const char*err_path)
+{
+      FILE*fd = fopen(err_path, "r");
+      if (fd == 0)
+	    return;
+
+      cerr << flush;
+      char buf[4096];
+      size_t cnt;
+      while ((cnt = fread(buf, 1, sizeof buf, fd)) > 0)
+	    fwrite(buf, 1, cnt, stderr);
+      fflush(stderr);
+      fclose(fd);
+}
+#endif
+
+int pform_parse_files(const vector<perm_string>&files, unsigned jobs)
+{
+      int rc = 0;
+
+#if defined(__MINGW32__)
+      jobs = 1;
+#endif
+      if (ivlpp_string == 0 || jobs < 2 || files.size() < 2) {
+	    for (size_t idx = 0 ; idx < files.size() ; idx += 1)
+		  rc += pform_parse(files[idx]);
+	    return rc;
       }
 
-      destroy_lexor();
-      return error_count;
+#if !defined(__MINGW32__)
+      vector<pform_prefetch_s> pending (files.size());
+      size_t next = 0;
+
+      for (size_t idx = 0 ; idx < files.size() ; idx += 1) {
+	    for ( ; next < files.size() && next < idx + jobs ; next += 1)
+		  pform_prefetch_start_(pending[next], files[next]);
+
+	    pform_prefetch_s&cur = pending[idx];
+	    if (cur.proc == 0) {
+		  rc += pform_parse(files[idx]);
+		  continue;
+	    }
+
+	      /* Wait for the preprocessor to finish the file, then
+		 pass on what it had to say about it. */
+	    pclose(cur.proc);
+	    cur.proc = 0;
+	    pform_prefetch_messages_(cur.err_path);
+
+	    vl_file = files[idx];
+	    vl_input = fopen(cur.tmp_path, "r");
+	    if (vl_input == 0) {
+		  cerr << "Unable to preprocess " << files[idx] << "." << endl;
+		  rc += 1;
+	    } else {
+		  if (verbose_flag)
+			cerr << "...parsing output from preprocessor..."
+			     << endl << flush;
+		  rc += pform_parse_input_(files[idx], false);
+	    }
+
+	    pform_prefetch_remove_(cur.tmp_path);
+	    pform_prefetch_remove_(cur.err_path);
+      }
+#endif
+
+      return rc;
 }
@@ -25,6 +25,7 @@
 # include  <cmath> // Needed to get pow for as_double().
 # include  <cstdio> // Needed to get snprintf for as_string().
 # include  <algorithm>
+# include  <vector>
 
 #if !defined(HAVE_LROUND)
 /*
@@ -43,18 +44,157 @@ extern "C" long int lround(double x)
 
 static verinum::V add_with_carry(verinum::V l, verinum::V r, verinum::V&c);
 
+static const uint64_t WORD_ONES = ~(uint64_t)0;
+
+/*
+ * Return the index of the highest set bit of a word that is not zero.
+ */
+static unsigned highest_bit(uint64_t word)
+{
+      unsigned res = 0;
+      for (unsigned step = 32 ;  step > 0 ;  step /= 2) {
+	    if (word >> step) {
+		  word >>= step;
+		  res += step;
+	    }
+      }
+      return res;
+}
+
+/*
+ * The mask of the low cnt bits of a word.
+ */
+static inline uint64_t low_mask(unsigned cnt)
+{
+      return cnt >= 64? WORD_ONES : (((uint64_t)1 << cnt) - 1);
+}
+
+void verinum::alloc_(unsigned nbits)
+{
+      nbits_ = nbits;
+      unsigned nwords = words_for_(nbits);
+      if (nwords == 0) {
+	    abits_ = 0;
+	    bbits_ = 0;
+	    return;
+      }
+      abits_ = new word_t[2*nwords];
+      bbits_ = abits_ + nwords;
+      for (unsigned idx = 0 ;  idx < 2*nwords ;  idx += 1)
+	    abits_[idx] = 0;
+}
+
+void verinum::clean_top_()
+{
+      unsigned top = nbits_ % WORD_BITS;
+      if (top == 0)
+	    return;
+      unsigned idx = nbits_ / WORD_BITS;
+      abits_[idx] &= low_mask(top);
+      bbits_[idx] &= low_mask(top);
+}
+
+void verinum::fill_(unsigned from, unsigned to, V val)
+{
+      word_t aval = (val & 1)? WORD_ONES : 0;
+      word_t bval = (val & 2)? WORD_ONES : 0;
+
+      while (from < to) {
+	    unsigned idx = from / WORD_BITS;
+	    unsigned off = from % WORD_BITS;
+	    unsigned cnt = min(WORD_BITS - off, to - from);
+	    word_t mask = low_mask(cnt) << off;
+	    abits_[idx] = (abits_[idx] & ~mask) | (aval & mask);
+	    bbits_[idx] = (bbits_[idx] & ~mask) | (bval & mask);
+	    from += cnt;
+      }
+}
+
+/*
+ * Get the (up to) 64 bits of a plane at the bit position pos. The
+ * bits past the end of the plane are zero.
+ */
+static uint64_t plane_word(const uint64_t*plane, unsigned nbits, unsigned pos)
+{
+      if (pos >= nbits)
+	    return 0;
+      unsigned idx = pos / 64;
+      unsigned off = pos % 64;
+      uint64_t res = plane[idx] >> off;
+      if (off && (idx+1)*64 < nbits)
+	    res |= plane[idx+1] << (64 - off);
+      return res;
+}
+
+/*
+ * Put the low cnt (at most 64) bits of the word into the plane at the
+ * bit position pos.
+ */
+static void plane_put(uint64_t*plane, unsigned pos, unsigned cnt, uint64_t word)
+{
+      unsigned idx = pos / 64;
+      unsigned off = pos % 64;
+      uint64_t mask = low_mask(cnt);
+      word &= mask;
+      plane[idx] = (plane[idx] & ~(mask << off)) | (word << off);
+      if (off && off + cnt > 64) {
+	    unsigned shift = 64 - off;
+	    plane[idx+1] = (plane[idx+1] & ~(mask >> shift)) | (word >> shift);
+      }
+}
+
+void verinum::copy_(unsigned off, const verinum&src, unsigned soff, unsigned cnt)
+{
+      assert(off + cnt <= nbits_);
+      assert(soff + cnt <= src.nbits_);
+      for (unsigned idx = 0 ;  idx < cnt ;  idx += WORD_BITS) {
+	    unsigned use = min(WORD_BITS, cnt - idx);
+	    plane_put(abits_, off+idx, use,
+		      plane_word(src.abits_, src.nbits_, soff+idx));
+	    plane_put(bbits_, off+idx, use,
+		      plane_word(src.bbits_, src.nbits_, soff+idx));
+      }
+}
+
+unsigned verinum::top_differ_(unsigned limit, V val) const
+{
+      assert(limit <= nbits_);
+      word_t aval = (val & 1)? WORD_ONES : 0;
+      word_t bval = (val & 2)? WORD_ONES : 0;
+
+      for (unsigned idx = words_for_(limit) ;  idx > 0 ;  idx -= 1) {
+	    word_t diff = (abits_[idx-1] ^ aval) | (bbits_[idx-1] ^ bval);
+	    if (idx*WORD_BITS > limit)
+		  diff &= low_mask(limit % WORD_BITS);
+	    if (diff)
+		  return (idx-1)*WORD_BITS + highest_bit(diff) + 1;
+      }
+      return 0;
+}
+
+verinum::word_t verinum::pad_word_(unsigned idx, bool pad) const
+{
+      unsigned pos = idx * WORD_BITS;
+      if (pos >= nbits_)
+	    return pad? WORD_ONES : 0;
+
+      word_t res = abits_[idx];
+      if (pad && pos + WORD_BITS > nbits_)
+	    res |= WORD_ONES << (nbits_ - pos);
+      return res;
+}
+
 verinum::verinum()
-: bits_(0), nbits_(0), has_len_(false), has_sign_(false), is_single_(false), string_flag_(false)
+: abits_(0), bbits_(0), nbits_(0), has_len_(false), has_sign_(false), is_single_(false), string_flag_(false)
 {
 }
 
 verinum::verinum(const V*bits, unsigned nbits, bool has_len__)
 : has_len_(has_len__), has_sign_(false), is_single_(false), string_flag_(false)
 {
-      nbits_ = nbits;
-      bits_ = new V [nbits];
+      alloc_(nbits);
       for (unsigned idx = 0 ;  idx < nbits ;  idx += 1) {
-	    bits_[idx] = bits[idx];
+	    set(idx, bits[idx]);
       }
 }
 
@@ -115,57 +255,37 @@ verinum::verinum(const string&s)
 : has_len_(true), has_sign_(false), is_single_(false), string_flag_(true)
 {
       string str = process_verilog_string_quotes(s);
-      nbits_ = str.length() * 8;
 
 	// Special case: The string "" is 8 bits of 0.
-      if (nbits_ == 0) {
-	    nbits_ = 8;
-	    bits_ = new V [nbits_];
-	    bits_[0] = V0;
-	    bits_[1] = V0;
-	    bits_[2] = V0;
-	    bits_[3] = V0;
-	    bits_[4] = V0;
-	    bits_[5] = V0;
-	    bits_[6] = V0;
-	    bits_[7] = V0;
+      if (str.length() == 0) {
+	    alloc_(8);
 	    return;
       }
 
-      bits_ = new V [nbits_];
+      alloc_(str.length() * 8);
 
+	// The first character is the most significant byte.
       unsigned idx, cp;
-      V*bp = bits_+nbits_;
       for (idx = nbits_, cp = 0 ;  idx > 0 ;  idx -= 8, cp += 1) {
-	    char ch = str[cp];
-	    *(--bp) = (ch&0x80) ? V1 : V0;
-	    *(--bp) = (ch&0x40) ? V1 : V0;
-	    *(--bp) = (ch&0x20) ? V1 : V0;
-	    *(--bp) = (ch&0x10) ? V1 : V0;
-	    *(--bp) = (ch&0x08) ? V1 : V0;
-	    *(--bp) = (ch&0x04) ? V1 : V0;
-	    *(--bp) = (ch&0x02) ? V1 : V0;
-	    *(--bp) = (ch&0x01) ? V1 : V0;
+	    word_t ch = (unsigned char)str[cp];
+	    abits_[(idx-8) / WORD_BITS] |= ch << ((idx-8) % WORD_BITS);
       }
 }
 
 verinum::verinum(verinum::V val, unsigned n, bool h)
 : has_len_(h), has_sign_(false), is_single_(false), string_flag_(false)
 {
-      nbits_ = n;
-      bits_ = new V[nbits_];
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
-	    bits_[idx] = val;
+      alloc_(n);
+      fill_(0, n, val);
 }
 
 verinum::verinum(uint64_t val, unsigned n)
 : has_len_(true), has_sign_(false), is_single_(false), string_flag_(false)
 {
-      nbits_ = n;
-      bits_ = new V[nbits_];
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    bits_[idx] = (val&1) ? V1 : V0;
-	    val >>= (uint64_t)1;
+      alloc_(n);
+      if (n > 0) {
+	    abits_[0] = val;
+	    clean_top_();
       }
 }
 
@@ -181,9 +301,8 @@ verinum::verinum(double val, bool)
 
 	/* We return `bx for a NaN or +/- infinity. */
       if (val != val || (val && (val == 0.5*val))) {
-	    nbits_ = 1;
-	    bits_ = new V[nbits_];
-	    bits_[0] = Vx;
+	    alloc_(1);
+	    set(0, Vx);
 	    return;
       }
 
@@ -199,15 +318,14 @@ verinum::verinum(double val, bool)
 
 	/* Get the exponent and fractional part of the number. */
       fraction = frexp(val, &exponent);
-      nbits_ = exponent+1;
-      bits_ = new V[nbits_];
+      alloc_(exponent+1);
 
 	/* If the value is small enough just use lround(). */
       if (nbits_ <= BITS_IN_LONG) {
 	    long sval = lround(val);
 	    if (is_neg) sval = -sval;
 	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  bits_[idx] = (sval&1) ? V1 : V0;
+		  set(idx, (sval&1) ? V1 : V0);
 		  sval >>= 1;
 	    }
 	      /* Trim the result. */
@@ -223,7 +341,7 @@ verinum::verinum(double val, bool)
 	    unsigned long bits = (unsigned long) fraction;
 	    fraction = fraction - (double) bits;
 	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  bits_[idx] = (bits&1) ? V1 : V0;
+		  set(idx, (bits&1) ? V1 : V0);
 		  bits >>= 1;
 	    }
       } else {
@@ -233,7 +351,7 @@ verinum::verinum(double val, bool)
 		  unsigned max_idx = (wd+1)*BITS_IN_LONG;
 		  if (max_idx > nbits_) max_idx = nbits_;
 		  for (unsigned idx = wd*BITS_IN_LONG; idx < max_idx; idx += 1) {
-			bits_[idx] = (bits&1) ? V1 : V0;
+			set(idx, (bits&1) ? V1 : V0);
 			bits >>= 1;
 		  }
 		  fraction = ldexp(fraction, BITS_IN_LONG);
@@ -254,63 +372,50 @@ verinum::verinum(double val, bool)
  * extra sign bits that can occur when calculating a negative value. */
 void verinum::signed_trim()
 {
-	/* Do we have any extra digits? */
-      unsigned tlen = nbits_-1;
-      verinum::V sign = bits_[tlen];
-      while ((tlen > 0) && (bits_[tlen] == sign)) tlen -= 1;
-
-	/* tlen now points to the first digit that is not the sign.
-	 * or bit 0. Set the length to include this bit and one proper
-	 * sign bit if needed. */
-      if (bits_[tlen] != sign) tlen += 1;
-      tlen += 1;
+	/* Keep the bits up to the highest bit that is not the sign,
+	   and one proper sign bit. */
+      verinum::V sign = get(nbits_-1);
+      unsigned tlen = top_differ_(nbits_-1, sign) + 1;
 
-	/* Trim the bits if needed. */
+	/* Trim the bits if needed. The planes keep their size. */
       if (tlen < nbits_) {
-	    V* tbits = new V[tlen];
-	    for (unsigned idx = 0; idx < tlen; idx += 1)
-		  tbits[idx] = bits_[idx];
-	    delete[] bits_;
-	    bits_ = tbits;
 	    nbits_ = tlen;
+	    clean_top_();
       }
 }
 
 verinum::verinum(const verinum&that)
 {
       string_flag_ = that.string_flag_;
-      nbits_ = that.nbits_;
-      bits_ = new V[nbits_];
       has_len_ = that.has_len_;
       has_sign_ = that.has_sign_;
       is_single_ = that.is_single_;
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
-	    bits_[idx] = that.bits_[idx];
+      alloc_(that.nbits_);
+      unsigned nwords = words_for_(nbits_);
+      for (unsigned idx = 0 ;  idx < nwords ;  idx += 1) {
+	    abits_[idx] = that.abits_[idx];
+	    bbits_[idx] = that.bbits_[idx];
+      }
 }
 
 verinum::verinum(const verinum&that, unsigned nbits)
 {
       string_flag_ = that.string_flag_ && (that.nbits_ == nbits);
-      nbits_ = nbits;
-      bits_ = new V[nbits_];
       has_len_ = true;
       has_sign_ = that.has_sign_;
       is_single_ = false;
+      alloc_(nbits);
 
       unsigned copy = nbits;
       if (copy > that.nbits_)
 	    copy = that.nbits_;
-      for (unsigned idx = 0 ;  idx < copy ;  idx += 1)
-	    bits_[idx] = that.bits_[idx];
+      copy_(0, that, 0, copy);
 
       if (copy < nbits_) {
-	    if (has_sign_ || that.is_single_) {
-		  for (unsigned idx = copy ;  idx < nbits_ ;  idx += 1)
-			bits_[idx] = bits_[idx-1];
-	    } else {
-		  for (unsigned idx = copy ;  idx < nbits_ ;  idx += 1)
-			bits_[idx] = verinum::V0;
-	    }
+	    if ((has_sign_ || that.is_single_) && copy > 0)
+		  fill_(copy, nbits_, get(copy-1));
+	    else
+		  fill_(copy, nbits_, verinum::V0);
       }
 }
 
@@ -329,28 +434,34 @@ verinum::verinum(int64_t that)
 
       nbits_ += 1;
 
-      bits_ = new V[nbits_];
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    bits_[idx] = (that & 1)? V1 : V0;
-	    that >>= 1;
-      }
+	/* At most 65 bits are needed, and the bits past 64 are
+	   copies of the sign. */
+      unsigned nbits = nbits_;
+      alloc_(nbits);
+      abits_[0] = (uint64_t)that;
+      if (nbits > 64)
+	    fill_(64, nbits, that < 0? V1 : V0);
+      clean_top_();
 }
 
 verinum::~verinum()
 {
-      delete[]bits_;
+      delete[]abits_;
 }
 
 verinum& verinum::operator= (const verinum&that)
 {
       if (this == &that) return *this;
-      if (nbits_ != that.nbits_) {
-            delete[]bits_;
-            nbits_ = that.nbits_;
-            bits_ = new V[that.nbits_];
+      if (words_for_(nbits_) != words_for_(that.nbits_)) {
+            delete[]abits_;
+            alloc_(that.nbits_);
+      }
+      nbits_ = that.nbits_;
+      unsigned nwords = words_for_(nbits_);
+      for (unsigned idx = 0 ;  idx < nwords ;  idx += 1) {
+	    abits_[idx] = that.abits_[idx];
+	    bbits_[idx] = that.bbits_[idx];
       }
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
-	    bits_[idx] = that.bits_[idx];
 
       has_len_ = that.has_len_;
       has_sign_ = that.has_sign_;
@@ -362,23 +473,34 @@ verinum& verinum::operator= (const verinum&that)
 verinum::V verinum::get(unsigned idx) const
 {
       assert(idx < nbits_);
-      return bits_[idx];
+      unsigned wdx = idx / WORD_BITS;
+      unsigned off = idx % WORD_BITS;
+      return (V) (((abits_[wdx] >> off) & 1) | (((bbits_[wdx] >> off) & 1) << 1));
 }
 
 verinum::V verinum::set(unsigned idx, verinum::V val)
 {
       assert(idx < nbits_);
-      return bits_[idx] = val;
+      unsigned wdx = idx / WORD_BITS;
+      word_t mask = (word_t)1 << (idx % WORD_BITS);
+      if (val & 1)
+	    abits_[wdx] |= mask;
+      else
+	    abits_[wdx] &= ~mask;
+      if (val & 2)
+	    bbits_[wdx] |= mask;
+      else
+	    bbits_[wdx] &= ~mask;
+      return val;
 }
 
 void verinum::set(unsigned off, const verinum&val)
 {
       assert(off + val.len() <= nbits_);
-      for (unsigned idx = 0 ; idx < val.len() ; idx += 1)
-	    bits_[off+idx] = val[idx];
+      copy_(off, val, 0, val.len());
 }
 
-unsigned verinum::as_unsigned() const
+uint64_t verinum::as_native_(unsigned width) const
 {
       if (nbits_ == 0)
 	    return 0;
@@ -386,53 +508,28 @@ unsigned verinum::as_unsigned() const
       if (!is_defined())
 	    return 0;
 
-      unsigned val = 0;
-      unsigned mask = 1;
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1, mask <<= 1)
-	    if (bits_[idx] == V1) {
-		  if (mask == 0) return ~mask;
-		  val |= mask;
-	    }
+      uint64_t mask = low_mask(width);
+      if (abits_[0] & ~mask)
+	    return mask;
+      for (unsigned idx = 1 ;  idx < words_for_(nbits_) ;  idx += 1)
+	    if (abits_[idx]) return mask;
 
-      return val;
+      return abits_[0];
 }
 
-unsigned long verinum::as_ulong() const
+unsigned verinum::as_unsigned() const
 {
-      if (nbits_ == 0)
-	    return 0;
-
-      if (!is_defined())
-	    return 0;
-
-      unsigned long val = 0;
-      unsigned long mask = 1;
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1, mask <<= 1)
-	    if (bits_[idx] == V1) {
-		  if (mask == 0) return ~mask;
-		  val |= mask;
-	    }
+      return as_native_(8 * sizeof(unsigned));
+}
 
-      return val;
+unsigned long verinum::as_ulong() const
+{
+      return as_native_(8 * sizeof(unsigned long));
 }
 
 uint64_t verinum::as_ulong64() const
 {
-      if (nbits_ == 0)
-	    return 0;
-
-      if (!is_defined())
-	    return 0;
-
-      uint64_t val = 0;
-      uint64_t mask = 1;
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1, mask <<= 1)
-	    if (bits_[idx] == V1) {
-		  if (mask == 0) return ~mask;
-		  val |= mask;
-	    }
-
-      return val;
+      return as_native_(64);
 }
 
 /*
@@ -465,28 +562,16 @@ signed long verinum::as_long() const
       }
       int lost_bits=0;
 
-      if (has_sign_ && (bits_[nbits_-1] == V1)) {
-	    val = -1;
-	    signed long mask = ~1L;
-	    for (unsigned idx = 0 ;  idx < top ;  idx += 1) {
-		  if (bits_[idx] == V0) val &= mask;
-		  mask = (mask << 1) | 1L;
-	    }
-	    if (diag_top) {
-		  for (unsigned idx = top; idx < diag_top; idx += 1) {
-			if (bits_[idx] == V0) lost_bits=1;
-		  }
-	    }
+	/* The value is defined, so the a plane is the binary value. */
+      uint64_t mask = low_mask(top);
+      if (has_sign_ && (get(nbits_-1) == V1)) {
+	    val = (signed long)(abits_[0] | ~mask);
+	    if (diag_top && top_differ_(diag_top, V1) > top)
+		  lost_bits=1;
       } else {
-	    signed long mask = 1;
-	    for (unsigned idx = 0 ;  idx < top ;  idx += 1, mask <<= 1) {
-		  if (bits_[idx] == V1) val |= mask;
-	    }
-	    if (diag_top) {
-		  for (unsigned idx = top; idx < diag_top; idx += 1) {
-			if (bits_[idx] == V1) lost_bits=1;
-		  }
-	    }
+	    val = (signed long)(abits_[0] & mask);
+	    if (diag_top && top_differ_(diag_top, V0) > top)
+		  lost_bits=1;
       }
 
       if (lost_bits) cerr << "warning: verinum::as_long() truncated " <<
@@ -501,17 +586,17 @@ double verinum::as_double() const
 
       double val = 0.0;
         /* Do we have/want a signed value? */
-      if (has_sign_ && bits_[nbits_-1] == V1) {
+      if (has_sign_ && get(nbits_-1) == V1) {
 	    V carry = V1;
 	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  V sum = add_with_carry(~bits_[idx], V0, carry);
+		  V sum = add_with_carry(~get(idx), V0, carry);
 		  if (sum == V1)
 			val += pow(2.0, (double)idx);
 	    }
 	    val *= -1.0;
       } else {
 	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  if (bits_[idx] == V1)
+		  if (get(idx) == V1)
 			val += pow(2.0, (double)idx);
 	    }
       }
@@ -526,17 +611,11 @@ string verinum::as_string() const
 
       string res;
       for (unsigned idx = nbits_ ;  idx > 0 ;  idx -= 8) {
-	    char char_val = 0;
-	    V*bp = bits_+idx;
-
-	    if (*(--bp) == V1) char_val |= 0x80;
-	    if (*(--bp) == V1) char_val |= 0x40;
-	    if (*(--bp) == V1) char_val |= 0x20;
-	    if (*(--bp) == V1) char_val |= 0x10;
-	    if (*(--bp) == V1) char_val |= 0x08;
-	    if (*(--bp) == V1) char_val |= 0x04;
-	    if (*(--bp) == V1) char_val |= 0x02;
-	    if (*(--bp) == V1) char_val |= 0x01;
+	      /* The bytes do not straddle words. Only the 1 bits
+		 (and not z bits) count. */
+	    unsigned wdx = (idx-8) / WORD_BITS;
+	    unsigned off = (idx-8) % WORD_BITS;
+	    char char_val = (char)((abits_[wdx] & ~bbits_[wdx]) >> off);
 
 	    if (char_val == '"' || char_val == '\\') {
 		  char tmp[5];
@@ -558,55 +637,60 @@ bool verinum::is_before(const verinum&that) const
       if (that.nbits_ > nbits_) return true;
       if (that.nbits_ < nbits_) return false;
 
-      for (unsigned idx = nbits_  ;  idx > 0 ;  idx -= 1) {
-	    if (bits_[idx-1] < that.bits_[idx-1]) return true;
-	    if (bits_[idx-1] > that.bits_[idx-1]) return false;
+	/* The highest bit that differs decides. */
+      for (unsigned idx = words_for_(nbits_) ;  idx > 0 ;  idx -= 1) {
+	    word_t diff = (abits_[idx-1] ^ that.abits_[idx-1])
+			| (bbits_[idx-1] ^ that.bbits_[idx-1]);
+	    if (diff == 0)
+		  continue;
+	    unsigned pos = (idx-1)*WORD_BITS + highest_bit(diff);
+	    return get(pos) < that.get(pos);
       }
       return false;
 }
 
 bool verinum::is_defined() const
 {
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    if (bits_[idx] == Vx) return false;
-	    if (bits_[idx] == Vz) return false;
+      for (unsigned idx = 0 ;  idx < words_for_(nbits_) ;  idx += 1) {
+	    if (bbits_[idx]) return false;
       }
       return true;
 }
 
 bool verinum::is_zero() const
 {
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
-	    if (bits_[idx] != V0) return false;
+      for (unsigned idx = 0 ;  idx < words_for_(nbits_) ;  idx += 1)
+	    if (abits_[idx] || bbits_[idx]) return false;
 
       return true;
 }
 
 bool verinum::is_negative() const
 {
-      return (bits_[nbits_-1] == V1) && has_sign();
+      return (nbits_ > 0) && (get(nbits_-1) == V1) && has_sign();
 }
 
 unsigned verinum::significant_bits() const
 {
-      unsigned sbits = nbits_;
+      if (nbits_ == 0)
+	    return 0;
+
+      unsigned sbits;
 
       if (has_sign_) {
-	    V sign_bit = bits_[sbits-1];
-	    while ((sbits > 1) && (bits_[sbits-2] == sign_bit))
-		  sbits -= 1;
+	    sbits = top_differ_(nbits_-1, get(nbits_-1)) + 1;
       } else {
-	    while ((sbits > 1) && (bits_[sbits-1] == verinum::V0))
-		  sbits -= 1;
+	    sbits = top_differ_(nbits_, verinum::V0);
+	    if (sbits == 0) sbits = 1;
       }
       return sbits;
 }
 
 void verinum::cast_to_int2()
 {
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    if (bits_[idx] == Vx || bits_[idx] == Vz)
-		  bits_[idx] = V0;
+      for (unsigned idx = 0 ;  idx < words_for_(nbits_) ;  idx += 1) {
+	    abits_[idx] &= ~bbits_[idx];
+	    bbits_[idx] = 0;
       }
 }
 
@@ -632,9 +716,7 @@ verinum pad_to_width(const verinum&that, unsigned width)
       }
 
       verinum val(pad, width, that.has_len());
-
-      for (unsigned idx = 0 ;  idx < that.len() ;  idx += 1)
-	    val.set(idx, that[idx]);
+      val.set(0, that);
 
       val.has_sign(that.has_sign());
       if (that.is_string() && (width % 8) == 0) {
@@ -668,9 +750,7 @@ verinum cast_to_width(const verinum&that, unsigned width)
       }
 
       verinum val(pad, width, true);
-
-      for (unsigned idx = 0 ;  idx < that.len() ;  idx += 1)
-	    val.set(idx, that[idx]);
+      val.set(0, that);
 
       val.has_sign(that.has_sign());
       return val;
@@ -695,49 +775,30 @@ verinum trim_vnum(const verinum&that)
 	    return that;
 
       if (that.has_sign()) {
-	    unsigned top = that.len()-1;
-	    verinum::V sign = that.get(top);
-
-	    while ((top > 0) && (that.get(top) == sign))
-		  top -= 1;
-
-	      /* top points to the first digit that is not the
-		 sign. Set the length to include this and one proper
-		 sign bit. */
 
-	    if (that.get(top) != sign)
-		  top += 1;
-
-	    tlen = top+1;
+	      /* Keep the bits up to the highest one that is not the
+		 sign, and one proper sign bit. */
+	    tlen = that.significant_bits();
 
       } else {
 
 	      /* If the result is unsigned and has an indefinite
-		 length, then trim off all but one leading zero. */
-	    unsigned top = that.len()-1;
-	    while ((top > 0) && (that.get(top) == verinum::V0))
-		  top -= 1;
-
-	      /* Now top is the index of the highest non-zero bit. If
-		 that turns out to the highest bit in the vector, then
-		 there is no trimming possible. */
-	    if (top+1 == that.len())
+		 length, then trim off all but one leading zero. If
+		 the highest non-zero bit is the highest bit in the
+		 vector, then there is no trimming possible. */
+	    tlen = that.significant_bits();
+	    if (tlen == that.len() && that.get(tlen-1) != verinum::V0)
 		  return that;
 
 	      /* Make tlen wide enough to include the highest non-zero
-		 bit, plus one extra 0 bit. */
-	    tlen = top+2;
-
-	      /* This can only happen when the verinum is all zeros,
-		 so make it a single bit wide. */
-	    if (that.get(top) == verinum::V0) tlen -= 1;
+		 bit, plus one extra 0 bit, unless the verinum is all
+		 zeros. Then make it a single bit wide. */
+	    if (that.get(tlen-1) != verinum::V0)
+		  tlen += 1;
       }
 
-      verinum tmp (verinum::V0, tlen, false);
-      tmp.has_sign(that.has_sign());
-      for (unsigned idx = 0 ;  idx < tmp.len() ;  idx += 1)
-	    tmp.set(idx, that.get(idx));
-
+      verinum tmp (that, tlen);
+      tmp.has_len(false);
       return tmp;
 }
 
@@ -837,20 +898,58 @@ verinum::V operator == (const verinum&left, const verinum&right)
 		  return verinum::V0;
       }
 
-      unsigned max_len = left.len();
-      if (right.len() > max_len)
-	    max_len = right.len();
+      unsigned min_len = min(left.len(), right.len());
 
-      for (unsigned idx = 0 ;  idx < max_len ;  idx += 1) {
-	    verinum::V left_bit  = idx < left.len() ? left[idx]  : left_pad;
-	    verinum::V right_bit = idx < right.len()? right[idx] : right_pad;
-	    if (left_bit != right_bit)
+	/* The bits past the end of the shorter value must match its
+	   padding. */
+      if (left.top_differ_(left.len(), right_pad) > min_len)
+	    return verinum::V0;
+      if (right.top_differ_(right.len(), left_pad) > min_len)
+	    return verinum::V0;
+
+	/* The common bits must match exactly, x and z included. */
+      for (unsigned idx = 0 ;  idx < verinum::words_for_(min_len) ;  idx += 1) {
+	    verinum::word_t diff = (left.abits_[idx] ^ right.abits_[idx])
+				 | (left.bbits_[idx] ^ right.bbits_[idx]);
+	    if ((idx+1)*verinum::WORD_BITS > min_len)
+		  diff &= low_mask(min_len % verinum::WORD_BITS);
+	    if (diff)
 		  return verinum::V0;
       }
 
       return verinum::V1;
 }
 
+/*
+ * Compare the low len bits of the values, from the most significant
+ * bit down. Return Vx if an x or z bit comes before the first
+ * difference, V0 if left is greater, V1 if left is less, and Vz if
+ * the bits are all the same.
+ */
+static verinum::V compare_common(const uint64_t*left_a, const uint64_t*left_b,
+				 const uint64_t*right_a, const uint64_t*right_b,
+				 unsigned len)
+{
+      for (unsigned idx = (len + 63) / 64 ;  idx > 0 ;  idx -= 1) {
+	    unsigned pos = (idx-1) * 64;
+	    uint64_t la = left_a[idx-1];
+	    uint64_t ra = right_a[idx-1];
+	    uint64_t xz = left_b[idx-1] | right_b[idx-1];
+	    uint64_t stop = xz | (la ^ ra);
+	    if (pos + 64 > len)
+		  stop &= low_mask(len - pos);
+	    if (stop == 0)
+		  continue;
+
+	    unsigned bit = highest_bit(stop);
+	    if ((xz >> bit) & 1)
+		  return verinum::Vx;
+	    return ((la >> bit) & 1)? verinum::V0 : verinum::V1;
+      }
+
+      return verinum::Vz;
+}
+
 verinum::V operator <= (const verinum&left, const verinum&right)
 {
       verinum::V left_pad = verinum::V0;
@@ -866,41 +965,27 @@ verinum::V operator <= (const verinum&left, const verinum&right)
 		  return verinum::V0;
       }
 
-      unsigned idx;
-      for (idx = left.len() ; idx > right.len() ;  idx -= 1) {
-	    if (left[idx-1] != right_pad) {
-		      // A change of padding for a negative left argument
-		      // denotes the left value is less than the right.
-		   return (signed_calc &&
-		           (left_pad == verinum::V1)) ? verinum::V1 :
-		                                        verinum::V0;
-	    }
-      }
+      unsigned min_len = min(left.len(), right.len());
 
-      for (idx = right.len() ; idx > left.len() ;  idx -= 1) {
-	    if (right[idx-1] != left_pad) {
-		      // A change of padding for a negative right argument
-		      // denotes the left value is not less than the right.
-		   return (signed_calc &&
-		           (right_pad == verinum::V1)) ? verinum::V0 :
-		                                         verinum::V1;
-	    }
+      if (left.top_differ_(left.len(), right_pad) > min_len) {
+	      // A change of padding for a negative left argument
+	      // denotes the left value is less than the right.
+	    return (signed_calc &&
+		    (left_pad == verinum::V1)) ? verinum::V1 :
+						 verinum::V0;
       }
 
-      idx = right.len();
-      if (left.len() < idx) idx = left.len();
-
-      while (idx > 0) {
-	    if (left[idx-1] == verinum::Vx) return verinum::Vx;
-	    if (left[idx-1] == verinum::Vz) return verinum::Vx;
-	    if (right[idx-1] == verinum::Vx) return verinum::Vx;
-	    if (right[idx-1] == verinum::Vz) return verinum::Vx;
-	    if (left[idx-1] > right[idx-1]) return verinum::V0;
-	    if (left[idx-1] < right[idx-1]) return verinum::V1;
-	    idx -= 1;
+      if (right.top_differ_(right.len(), left_pad) > min_len) {
+	      // A change of padding for a negative right argument
+	      // denotes the left value is not less than the right.
+	    return (signed_calc &&
+		    (right_pad == verinum::V1)) ? verinum::V0 :
+						  verinum::V1;
       }
 
-      return verinum::V1;
+      verinum::V res = compare_common(left.abits_, left.bbits_,
+				      right.abits_, right.bbits_, min_len);
+      return res == verinum::Vz? verinum::V1 : res;
 }
 
 verinum::V operator < (const verinum&left, const verinum&right)
@@ -918,38 +1003,27 @@ verinum::V operator < (const verinum&left, const verinum&right)
 		  return verinum::V0;
       }
 
-      unsigned idx;
-      for (idx = left.len() ; idx > right.len() ;  idx -= 1) {
-	    if (left[idx-1] != right_pad) {
-		      // A change of padding for a negative left argument
-		      // denotes the left value is less than the right.
-		   return (signed_calc &&
-		           (left_pad == verinum::V1)) ? verinum::V1 :
-		                                        verinum::V0;
-	    }
-      }
+      unsigned min_len = min(left.len(), right.len());
 
-      for (idx = right.len() ; idx > left.len() ;  idx -= 1) {
-	    if (right[idx-1] != left_pad) {
-		      // A change of padding for a negative right argument
-		      // denotes the left value is not less than the right.
-		   return (signed_calc &&
-		           (right_pad == verinum::V1)) ? verinum::V0 :
-		                                         verinum::V1;
-	    }
+      if (left.top_differ_(left.len(), right_pad) > min_len) {
+	      // A change of padding for a negative left argument
+	      // denotes the left value is less than the right.
+	    return (signed_calc &&
+		    (left_pad == verinum::V1)) ? verinum::V1 :
+						 verinum::V0;
       }
 
-      while (idx > 0) {
-	    if (left[idx-1] == verinum::Vx) return verinum::Vx;
-	    if (left[idx-1] == verinum::Vz) return verinum::Vx;
-	    if (right[idx-1] == verinum::Vx) return verinum::Vx;
-	    if (right[idx-1] == verinum::Vz) return verinum::Vx;
-	    if (left[idx-1] > right[idx-1]) return verinum::V0;
-	    if (left[idx-1] < right[idx-1]) return verinum::V1;
-	    idx -= 1;
+      if (right.top_differ_(right.len(), left_pad) > min_len) {
+	      // A change of padding for a negative right argument
+	      // denotes the left value is not less than the right.
+	    return (signed_calc &&
+		    (right_pad == verinum::V1)) ? verinum::V0 :
+						  verinum::V1;
       }
 
-      return verinum::V0;
+      verinum::V res = compare_common(left.abits_, left.bbits_,
+				      right.abits_, right.bbits_, min_len);
+      return res == verinum::Vz? verinum::V0 : res;
 }
 
 static verinum::V add_with_carry(verinum::V l, verinum::V r, verinum::V&c)
@@ -1003,35 +1077,47 @@ static verinum::V add_with_carry(verinum::V l, verinum::V r, verinum::V&c)
 verinum operator ~ (const verinum&left)
 {
       verinum val = left;
-      for (unsigned idx = 0 ;  idx < val.len() ;  idx += 1)
-	    switch (val[idx]) {
-		case verinum::V0:
-		  val.set(idx, verinum::V1);
-		  break;
-		case verinum::V1:
-		  val.set(idx, verinum::V0);
-		  break;
-		default:
-		  val.set(idx, verinum::Vx);
-		  break;
-	    }
+      for (unsigned idx = 0 ;  idx < verinum::words_for_(val.nbits_) ;  idx += 1) {
+	      /* 0 and 1 are flipped, and x and z become x. */
+	    val.abits_[idx] = ~val.abits_[idx] & ~val.bbits_[idx];
+      }
+      val.clean_top_();
 
       return val;
 }
 
 /*
- * Addition and subtraction works a bit at a time, from the least
+ * Addition and subtraction work a word at a time, from the least
  * significant up to the most significant. The result is signed only
  * if both of the operands are signed. If either operand is unsized,
  * the result is expanded as needed to prevent overflow.
  */
 
+void verinum::add_(const verinum&l, bool lpad, const verinum&r, bool rpad,
+		   bool sub)
+{
+      word_t carry = sub? 1 : 0;
+      for (unsigned idx = 0 ;  idx < words_for_(nbits_) ;  idx += 1) {
+	    word_t lval = l.pad_word_(idx, lpad);
+	    word_t rval = r.pad_word_(idx, rpad);
+	    if (sub) rval = ~rval;
+
+	    word_t sum = lval + rval;
+	    word_t next = sum < lval;
+	    sum += carry;
+	    next |= sum < carry;
+	    abits_[idx] = sum;
+	    bbits_[idx] = 0;
+	    carry = next;
+      }
+      clean_top_();
+}
+
 verinum operator + (const verinum&left, const verinum&right)
 {
       const bool has_len_flag = left.has_len() && right.has_len();
       const bool signed_flag = left.has_sign() && right.has_sign();
 
-      unsigned min_len = min(left.len(), right.len());
       unsigned max_len = max(left.len(), right.len());
 
 	// If either the left or right values are undefined, the
@@ -1043,40 +1129,24 @@ verinum operator + (const verinum&left, const verinum&right)
 	    return result;
       }
 
-      verinum::V*val_bits = new verinum::V[max_len+1];
-
-      verinum::V carry = verinum::V0;
-      for (unsigned idx = 0 ;  idx < min_len ;  idx += 1)
-	    val_bits[idx] = add_with_carry(left[idx], right[idx], carry);
-
-      verinum::V rpad = sign_bit(right);
-      verinum::V lpad = sign_bit(left);
-
-      if (left.len() > right.len()) {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(left[idx], rpad, carry);
-
-      } else {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(lpad, right[idx], carry);
-      }
+      verinum result (verinum::V0, max_len+1, has_len_flag);
+      result.add_(left, sign_bit(left) == verinum::V1,
+		  right, sign_bit(right) == verinum::V1, false);
 
       unsigned len = max_len;
       if (!has_len_flag) {
-	    val_bits[max_len] = add_with_carry(lpad, rpad, carry);
 	    if (signed_flag) {
-		  if (val_bits[max_len] != val_bits[max_len-1]) len += 1;
+		  if (result[max_len] != result[max_len-1]) len += 1;
 	    } else {
-		  if (val_bits[max_len] != verinum::V0) len += 1;
+		  if (result[max_len] != verinum::V0) len += 1;
 	    }
       }
-      verinum result (val_bits, len, has_len_flag);
+      if (len < result.nbits_) {
+	    result.nbits_ = len;
+	    result.clean_top_();
+      }
       result.has_sign(signed_flag);
 
-      delete[]val_bits;
-
       return result;
 }
 
@@ -1085,7 +1155,6 @@ verinum operator - (const verinum&left, const verinum&right)
       const bool has_len_flag = left.has_len() && right.has_len();
       const bool signed_flag = left.has_sign() && right.has_sign();
 
-      unsigned min_len = min(left.len(), right.len());
       unsigned max_len = max(left.len(), right.len());
 
 	// If either the left or right values are undefined, the
@@ -1097,36 +1166,20 @@ verinum operator - (const verinum&left, const verinum&right)
 	    return result;
       }
 
-      verinum::V*val_bits = new verinum::V[max_len+1];
-
-      verinum::V carry = verinum::V1;
-      for (unsigned idx = 0 ;  idx < min_len ;  idx += 1)
-	    val_bits[idx] = add_with_carry(left[idx], ~right[idx], carry);
-
-      verinum::V rpad = sign_bit(right);
-      verinum::V lpad = sign_bit(left);
-
-      if (left.len() > right.len()) {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(left[idx], ~rpad, carry);
-
-      } else {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(lpad, ~right[idx], carry);
-      }
+      verinum result (verinum::V0, max_len+1, has_len_flag);
+      result.add_(left, sign_bit(left) == verinum::V1,
+		  right, sign_bit(right) == verinum::V1, true);
 
       unsigned len = max_len;
       if (signed_flag && !has_len_flag) {
-	    val_bits[max_len] = add_with_carry(lpad, ~rpad, carry);
-	    if (val_bits[max_len] != val_bits[max_len-1]) len += 1;
+	    if (result[max_len] != result[max_len-1]) len += 1;
+      }
+      if (len < result.nbits_) {
+	    result.nbits_ = len;
+	    result.clean_top_();
       }
-      verinum result (val_bits, len, has_len_flag);
       result.has_sign(signed_flag);
 
-      delete[]val_bits;
-
       return result;
 }
 
@@ -1145,21 +1198,19 @@ verinum operator - (const verinum&right)
 	    return result;
       }
 
-      verinum::V*val_bits = new verinum::V[len+1];
-
-      verinum::V carry = verinum::V1;
-      for (unsigned idx = 0 ;  idx < len ;  idx += 1)
-	    val_bits[idx] = add_with_carry(verinum::V0, ~right[idx], carry);
+      verinum zero;
+      verinum result (verinum::V0, len+1, has_len_flag);
+      result.add_(zero, false, right, sign_bit(right) == verinum::V1, true);
 
       if (signed_flag && !has_len_flag) {
-	    val_bits[len] = add_with_carry(verinum::V0, ~sign_bit(right), carry);
-	    if (val_bits[len] != val_bits[len-1]) len += 1;
+	    if (result[len] != result[len-1]) len += 1;
+      }
+      if (len < result.nbits_) {
+	    result.nbits_ = len;
+	    result.clean_top_();
       }
-      verinum result (val_bits, len, has_len_flag);
       result.has_sign(signed_flag);
 
-      delete[]val_bits;
-
       return result;
 }
 
@@ -1169,8 +1220,9 @@ verinum operator - (const verinum&right)
  * operand is unsized, the resulting number is as large as the sum of
  * the sizes of the operands.
  *
- * The algorithm used is successive shift and add operations,
- * implemented as the nested loops.
+ * The operands are padded to the width of the result with their sign
+ * bits, and multiplied in 32bit digits, so that the product of two
+ * digits fits in a word.
  */
 verinum operator * (const verinum&left, const verinum&right)
 {
@@ -1193,23 +1245,34 @@ verinum operator * (const verinum&left, const verinum&right)
       verinum result(verinum::V0, len, has_len_flag);
       result.has_sign(signed_flag);
 
-      verinum::V r_sign = sign_bit(right);
-      for (unsigned rdx = 0 ;  rdx < len ;  rdx += 1) {
+      bool l_pad = sign_bit(left) == verinum::V1;
+      bool r_pad = sign_bit(right) == verinum::V1;
 
-	    verinum::V r_bit = rdx < r_len ? right.get(rdx) : r_sign;
-	    if (r_bit == verinum::V0)
+      unsigned ndigits = (len + 31) / 32;
+      vector<uint32_t> l_dig (ndigits), r_dig (ndigits), prod (ndigits, 0);
+      for (unsigned idx = 0 ;  idx < ndigits ;  idx += 1) {
+	    unsigned shift = 32 * (idx % 2);
+	    l_dig[idx] = (uint32_t)(left.pad_word_(idx/2, l_pad) >> shift);
+	    r_dig[idx] = (uint32_t)(right.pad_word_(idx/2, r_pad) >> shift);
+      }
+
+      for (unsigned rdx = 0 ;  rdx < ndigits ;  rdx += 1) {
+	    if (r_dig[rdx] == 0)
 		  continue;
 
-	    verinum::V l_sign = sign_bit(left);
-	    verinum::V carry = verinum::V0;
-	    for (unsigned ldx = 0 ;  ldx < (len - rdx) ;  ldx += 1) {
-		  verinum::V l_bit = ldx < l_len ? left[ldx] : l_sign;
-		  result.set(ldx+rdx, add_with_carry(l_bit,
-						     result[rdx+ldx],
-						     carry));
+	    uint64_t carry = 0;
+	    for (unsigned ldx = 0 ;  ldx < (ndigits - rdx) ;  ldx += 1) {
+		  uint64_t tmp = (uint64_t)l_dig[ldx] * r_dig[rdx]
+			       + prod[ldx+rdx] + carry;
+		  prod[ldx+rdx] = (uint32_t)tmp;
+		  carry = tmp >> 32;
 	    }
       }
 
+      for (unsigned idx = 0 ;  idx < ndigits ;  idx += 1)
+	    result.abits_[idx/2] |= (uint64_t)prod[idx] << (32 * (idx % 2));
+      result.clean_top_();
+
       return trim_vnum(result);
 }
 
@@ -1313,8 +1376,8 @@ verinum operator << (const verinum&that, unsigned shift)
       verinum result(verinum::V0, len, has_len_flag);
       result.has_sign(that.has_sign());
 
-      for (unsigned idx = shift ;  idx < len ;  idx += 1)
-	    result.set(idx, that.get(idx - shift));
+      if (shift < len)
+	    result.copy_(shift, that, 0, len - shift);
 
       return trim_vnum(result);
 }
@@ -1338,8 +1401,7 @@ verinum operator >> (const verinum&that, unsigned shift)
       verinum result(sign_bit, len, has_len_flag);
       result.has_sign(that.has_sign());
 
-      for (unsigned idx = shift ;  idx < that.len() ;  idx += 1)
-	    result.set(idx-shift, that.get(idx));
+      result.copy_(0, that, shift, that.len() - shift);
 
       return trim_vnum(result);
 }
@@ -1445,10 +1507,8 @@ verinum operator / (const verinum&left, const verinum&right)
 		  long l = left.as_long();
 		  long r = right.as_long();
 		  long v = l / r;
-		  for (unsigned idx = 0 ;  idx < use_len ;  idx += 1) {
-			result.set(idx,  (v & 1)? verinum::V1 : verinum::V0);
-			v >>= 1;
-		  }
+		  result = verinum((uint64_t)v, use_len);
+		  result.has_len(has_len_flag);
 
 	    } else {
 		  verinum use_left, use_right;
@@ -1479,10 +1539,8 @@ verinum operator / (const verinum&left, const verinum&right)
 		  unsigned long l = left.as_ulong();
 		  unsigned long r = right.as_ulong();
 		  unsigned long v = l / r;
-		  for (unsigned idx = 0 ;  idx < use_len ;  idx += 1) {
-			result.set(idx,  (v & 1)? verinum::V1 : verinum::V0);
-			v >>= 1;
-		  }
+		  result = verinum((uint64_t)v, use_len);
+		  result.has_len(has_len_flag);
 
 	    } else {
 		  result = unsigned_divide(left, right, false);
@@ -1519,10 +1577,8 @@ verinum operator % (const verinum&left, const verinum&right)
 		  long l = left.as_long();
 		  long r = right.as_long();
 		  long v = l % r;
-		  for (unsigned idx = 0 ;  idx < use_len ;  idx += 1) {
-			result.set(idx,  (v & 1)? verinum::V1 : verinum::V0);
-			v >>= 1;
-		  }
+		  result = verinum((uint64_t)v, use_len);
+		  result.has_len(has_len_flag);
 	    } else {
 		  verinum use_left, use_right;
 		  bool negative = false;
@@ -1548,10 +1604,8 @@ verinum operator % (const verinum&left, const verinum&right)
 		  unsigned long l = left.as_ulong();
 		  unsigned long r = right.as_ulong();
 		  unsigned long v = l % r;
-		  for (unsigned idx = 0 ;  idx < use_len ;  idx += 1) {
-			result.set(idx,  (v & 1)? verinum::V1 : verinum::V0);
-			v >>= 1;
-		  }
+		  result = verinum((uint64_t)v, use_len);
+		  result.has_len(has_len_flag);
 	    } else {
 		  result = unsigned_modulus(left, right);
 	    }
@@ -1573,11 +1627,8 @@ verinum concat(const verinum&left, const verinum&right)
       }
 
       verinum res (verinum::V0, left.len() + right.len());
-      for (unsigned idx = 0 ;  idx < right.len() ;  idx += 1)
-	    res.set(idx, right.get(idx));
-
-      for (unsigned idx = 0 ;  idx < left.len() ;  idx += 1)
-	    res.set(idx+right.len(), left.get(idx));
+      res.set(0, right);
+      res.set(right.len(), left);
 
       return res;
 }
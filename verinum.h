@@ -35,6 +35,13 @@ using namespace std;
  * possible values: 0, 1, x or z. The verinum number is store in
  * little-endian format. This means that if the long value is 2b'10,
  * get(0) is 0 and get(1) is 1.
+ *
+ * The bits are packed into two planes of 64bit words. A bit is the
+ * pair of the bits with the same index in the a and b planes, and the
+ * value of the pair (a + 2*b) is the V value of the bit, so a value
+ * with no x or z bits has an all zero b plane, and the a plane is then
+ * the binary value. The bits above the width in the top words are
+ * kept zero. The arithmetic works on whole words of the a plane.
  */
 class verinum {
 
@@ -112,10 +119,49 @@ class verinum {
       double as_double() const;
       string as_string() const;
     private:
+	// The operators work on the words of their operands.
+      friend V operator == (const verinum&, const verinum&);
+      friend V operator <= (const verinum&, const verinum&);
+      friend V operator <  (const verinum&, const verinum&);
+      friend verinum operator - (const verinum&);
+      friend verinum operator + (const verinum&, const verinum&);
+      friend verinum operator - (const verinum&, const verinum&);
+      friend verinum operator * (const verinum&, const verinum&);
+      friend verinum operator<< (const verinum&, unsigned);
+      friend verinum operator>> (const verinum&, unsigned);
+      friend verinum operator ~ (const verinum&);
+
+      typedef uint64_t word_t;
+      static const unsigned WORD_BITS = 64;
+      static unsigned words_for_(unsigned nbits)
+      { return (nbits + WORD_BITS - 1) / WORD_BITS; }
+
       void signed_trim();
+	// Allocate zeroed planes for nbits bits.
+      void alloc_(unsigned nbits);
+	// Clear the bits above the width in the top words.
+      void clean_top_();
+	// Set the bits [from, to) to the value.
+      void fill_(unsigned from, unsigned to, V val);
+	// Copy cnt bits of src, starting at soff, to this at off.
+      void copy_(unsigned off, const verinum&src, unsigned soff, unsigned cnt);
+	// Return one more than the index of the highest bit below
+	// limit that is not val, or 0 if there is no such bit.
+      unsigned top_differ_(unsigned limit, V val) const;
+	// Return the idx'th word of the a plane, as if the value were
+	// padded to any width with 1 (pad) or 0 bits.
+      word_t pad_word_(unsigned idx, bool pad) const;
+	// The low width bits of the value, or all ones if there are
+	// more bits set.
+      uint64_t as_native_(unsigned width) const;
+	// Set this to the sum (or difference, if sub) of the defined
+	// values l and r, padded with 1 (lpad, rpad) or 0 bits.
+      void add_(const verinum&l, bool lpad, const verinum&r, bool rpad,
+		bool sub);
 
     private:
-      V* bits_;
+      word_t* abits_;
+      word_t* bbits_;
       unsigned nbits_;
       bool has_len_;
       bool has_sign_;
@@ -26,6 +26,7 @@
  * FST_DYNAMIC_ALIAS_DISABLE : dynamic aliases are not processed
  * FST_DYNAMIC_ALIAS2_DISABLE : new encoding for dynamic aliases is not generated
  * FST_WRITEX_DISABLE : fast write I/O routines are disabled
+ * FST_WRITER_PACK_THREADS_DISABLE : compression worker pool for fstWriterSetPackThreads() is not built
  *
  * possible enables:
  *
@@ -51,6 +52,13 @@
 #include <pthread.h>
 #endif
 
+#ifdef HAVE_LIBPTHREAD
+#ifndef FST_WRITER_PACK_THREADS_DISABLE
+#define FST_WRITER_PACK_THREADS
+#include <pthread.h>
+#endif
+#endif
+
 #ifdef __MINGW32__
 #include <windows.h>
 #endif
@@ -118,6 +126,8 @@ void **JenkinsIns(void *base_i, const unsigned char *mem, uint32_t length, uint3
 #define FST_HDR_TIMEZERO_SIZE           (8)
 #define FST_GZIO_LEN                    (32768)
 #define FST_HDR_FOURPACK_DUO_SIZE       (4*1024*1024)
+#define FST_PACK_CHUNK_SIGS             (64)
+#define FST_PACK_CHUNKS_PER_THREAD      (4)
 
 #if defined(__i386__) || defined(__x86_64__) || defined(_AIX)
 #define FST_DO_MISALIGNED_OPS
@@ -704,6 +714,33 @@ unsigned active : 1;
 };
 
 
+/*
+ * compression work that may be handed to the worker pool.  a task
+ * is embedded as the first member of its job, and done is set under
+ * the pool mutex once func() has returned.
+ */
+struct fstWriterTask
+{
+struct fstWriterTask *next;
+void (*func)(struct fstWriterTask *);
+int done;
+};
+
+#ifdef FST_WRITER_PACK_THREADS
+struct fstWriterPool
+{
+pthread_mutex_t mutex;
+pthread_cond_t work_cond;
+pthread_cond_t done_cond;
+struct fstWriterTask *head;
+struct fstWriterTask *tail;
+pthread_t *threads;
+int num_threads;
+int quit;
+};
+#endif
+
+
 struct fstWriterContext
 {
 FILE *handle;
@@ -773,6 +810,10 @@ pthread_attr_t thread_attr;
 struct fstWriterContext *xc_parent;
 #endif
 
+#ifdef FST_WRITER_PACK_THREADS
+struct fstWriterPool *pool;
+#endif
+
 size_t fst_orig_break_size;
 size_t fst_orig_break_add_size;
 
@@ -795,6 +836,165 @@ char *tchn_handle_nam;
 };
 
 
+/*
+ * compression worker pool.  tasks run in any order on the workers,
+ * the writer waits for them in file order so the output is the same
+ * as with no pool at all.
+ */
+#ifdef FST_WRITER_PACK_THREADS
+static void *fstWriterPoolThread(void *ctx)
+{
+struct fstWriterPool *pool = (struct fstWriterPool *)ctx;
+
+pthread_mutex_lock(&pool->mutex);
+for(;;)
+        {
+        struct fstWriterTask *t = pool->head;
+
+        if(t)
+                {
+                if(!(pool->head = t->next)) pool->tail = NULL;
+                pthread_mutex_unlock(&pool->mutex);
+
+                t->func(t);
+
+                pthread_mutex_lock(&pool->mutex);
+                t->done = 1;
+                pthread_cond_broadcast(&pool->done_cond);
+                }
+        else if(pool->quit)
+                {
+                break;
+                }
+                else
+                {
+                pthread_cond_wait(&pool->work_cond, &pool->mutex);
+                }
+        }
+pthread_mutex_unlock(&pool->mutex);
+
+return(NULL);
+}
+
+
+static void fstWriterPoolDestroy(struct fstWriterPool *pool)
+{
+int i;
+
+pthread_mutex_lock(&pool->mutex);
+pool->quit = 1;
+pthread_cond_broadcast(&pool->work_cond);
+pthread_mutex_unlock(&pool->mutex);
+
+for(i=0;i<pool->num_threads;i++)
+        {
+        pthread_join(pool->threads[i], NULL);
+        }
+
+pthread_cond_destroy(&pool->done_cond);
+pthread_cond_destroy(&pool->work_cond);
+pthread_mutex_destroy(&pool->mutex);
+free(pool->threads);
+free(pool);
+}
+
+
+static struct fstWriterPool *fstWriterPoolCreate(int num_threads)
+{
+struct fstWriterPool *pool = calloc(1, sizeof(struct fstWriterPool));
+
+pthread_mutex_init(&pool->mutex, NULL);
+pthread_cond_init(&pool->work_cond, NULL);
+pthread_cond_init(&pool->done_cond, NULL);
+pool->threads = calloc(num_threads, sizeof(pthread_t));
+
+for(pool->num_threads=0;pool->num_threads<num_threads;pool->num_threads++)
+        {
+        if(pthread_create(&pool->threads[pool->num_threads], NULL, fstWriterPoolThread, pool)) break;
+        }
+
+if(!pool->num_threads)
+        {
+        fstWriterPoolDestroy(pool);
+        pool = NULL;
+        }
+
+return(pool);
+}
+#endif
+
+
+/*
+ * hand a task to the pool, or just run it when there is no pool
+ */
+static void fstWriterSubmitTask(struct fstWriterContext *xc, struct fstWriterTask *t, void (*func)(struct fstWriterTask *))
+{
+t->next = NULL;
+t->func = func;
+t->done = 0;
+
+#ifdef FST_WRITER_PACK_THREADS
+if(xc->pool)
+        {
+        struct fstWriterPool *pool = xc->pool;
+
+        pthread_mutex_lock(&pool->mutex);
+        if(pool->tail) pool->tail->next = t; else pool->head = t;
+        pool->tail = t;
+        pthread_cond_signal(&pool->work_cond);
+        pthread_mutex_unlock(&pool->mutex);
+        return;
+        }
+#else
+(void)xc;
+#endif
+
+func(t);
+t->done = 1;
+}
+
+
+/*
+ * wait for a task, running queued tasks in the meantime so the
+ * calling thread also does useful work
+ */
+static void fstWriterWaitTask(struct fstWriterContext *xc, struct fstWriterTask *t)
+{
+#ifdef FST_WRITER_PACK_THREADS
+if(xc->pool)
+        {
+        struct fstWriterPool *pool = xc->pool;
+
+        pthread_mutex_lock(&pool->mutex);
+        while(!t->done)
+                {
+                struct fstWriterTask *t2 = pool->head;
+
+                if(t2)
+                        {
+                        if(!(pool->head = t2->next)) pool->tail = NULL;
+                        pthread_mutex_unlock(&pool->mutex);
+
+                        t2->func(t2);
+
+                        pthread_mutex_lock(&pool->mutex);
+                        t2->done = 1;
+                        pthread_cond_broadcast(&pool->done_cond);
+                        }
+                        else
+                        {
+                        pthread_cond_wait(&pool->done_cond, &pool->mutex);
+                        }
+                }
+        pthread_mutex_unlock(&pool->mutex);
+        }
+#else
+(void)xc;
+(void)t;
+#endif
+}
+
+
 static int fstWriterFseeko(struct fstWriterContext *xc, FILE *stream, off_t offset, int whence)
 {
 int rc = fseeko(stream, offset, whence);
@@ -1222,6 +1422,299 @@ if(xc)
  * only to be called directly by fst code...otherwise must
  * be synced up with time changes
  */
+/*
+ * compression jobs that can run on the worker pool
+ */
+struct fstWriterZJob
+{
+struct fstWriterTask task;      /* must be first */
+unsigned char *src;
+unsigned long srclen;
+unsigned char *dmem;
+unsigned long destlen;
+int level;
+int rc;
+};
+
+
+static void fstWriterZJobFunc(struct fstWriterTask *t)
+{
+struct fstWriterZJob *job = (struct fstWriterZJob *)t;
+
+job->destlen = job->srclen;
+job->dmem = malloc(compressBound(job->destlen));
+job->rc = compress2(job->dmem, &job->destlen, job->src, job->srclen, job->level);
+}
+
+
+struct fstWriterPackedChain
+{
+size_t offs;
+uint32_t len;
+uint32_t hdr;
+uint32_t unc;
+};
+
+struct fstWriterPackJob
+{
+struct fstWriterTask task;      /* must be first */
+struct fstWriterContext *xc;
+fstHandle first, last;          /* valpos_mem index range of the job */
+unsigned char *scratchpad;
+unsigned char *packmem;
+unsigned int packmemlen;
+unsigned char *out;             /* packed chains of the job, back to back */
+size_t out_len, out_alloc;
+struct fstWriterPackedChain chains[FST_PACK_CHUNK_SIGS];
+};
+
+
+/*
+ * unpack the value change chain of one signal into scratchpad (built
+ * backwards from the end) and compress it.  returns the bytes to write
+ * for the chain, *hdr is the uncompressed length when they are
+ * compressed and zero when they are not.  apart from the checkpoint
+ * value of the signal in curval_mem, the writer state is only read here
+ * so different signals can be packed at the same time.
+ */
+static unsigned char *fstWriterPackChain(struct fstWriterContext *xc, uint32_t *vm4ip,
+        unsigned char *scratchpad, unsigned char **packmem, unsigned int *packmemlen,
+        uint32_t *hdr, uint32_t *len, uint32_t *unc)
+{
+unsigned char *vchg_mem = xc->vchg_mem;
+unsigned char *scratchpnt;
+uint32_t offs = vm4ip[2];
+uint32_t next_offs;
+unsigned int wrlen;
+
+scratchpnt = scratchpad + xc->vchg_siz;         /* build this buffer backwards */
+if(vm4ip[1] <= 1)
+        {
+        if(vm4ip[1] == 1)
+                {
+                wrlen = fstGetVarint32Length(vchg_mem + offs + 4); /* used to advance and determine wrlen */
+#ifndef FST_REMOVE_DUPLICATE_VC
+                xc->curval_mem[vm4ip[0]] = vchg_mem[offs + 4 + wrlen]; /* checkpoint variable */
+#endif
+                while(offs)
+                        {
+                        unsigned char val;
+                        uint32_t time_delta, rcv;
+                        next_offs = fstGetUint32(vchg_mem + offs);
+                        offs += 4;
+
+                        time_delta = fstGetVarint32(vchg_mem + offs, (int *)&wrlen);
+                        val = vchg_mem[offs+wrlen];
+                        offs = next_offs;
+
+                        switch(val)
+                                {
+                                case '0':
+                                case '1':               rcv = ((val&1)<<1) | (time_delta<<2);
+                                                        break; /* pack more delta bits in for 0/1 vchs */
+
+                                case 'x': case 'X':     rcv = FST_RCV_X | (time_delta<<4); break;
+                                case 'z': case 'Z':     rcv = FST_RCV_Z | (time_delta<<4); break;
+                                case 'h': case 'H':     rcv = FST_RCV_H | (time_delta<<4); break;
+                                case 'u': case 'U':     rcv = FST_RCV_U | (time_delta<<4); break;
+                                case 'w': case 'W':     rcv = FST_RCV_W | (time_delta<<4); break;
+                                case 'l': case 'L':     rcv = FST_RCV_L | (time_delta<<4); break;
+                                default:                rcv = FST_RCV_D | (time_delta<<4); break;
+                                }
+
+                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, rcv);
+                        }
+                }
+                else
+                {
+                /* variable length */
+                /* fstGetUint32 (next_offs) + fstGetVarint32 (time_delta) + fstGetVarint32 (len) + payload */
+                unsigned char *pnt;
+                uint32_t record_len;
+                uint32_t time_delta;
+
+                while(offs)
+                        {
+                        next_offs = fstGetUint32(vchg_mem + offs);
+                        offs += 4;
+                        pnt = vchg_mem + offs;
+                        offs = next_offs;
+                        time_delta = fstGetVarint32(pnt, (int *)&wrlen);
+                        pnt += wrlen;
+                        record_len = fstGetVarint32(pnt, (int *)&wrlen);
+                        pnt += wrlen;
+
+                        scratchpnt -= record_len;
+                        memcpy(scratchpnt, pnt, record_len);
+
+                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, record_len);
+                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1)); /* reserve | 1 case for future expansion */
+                        }
+                }
+        }
+        else
+        {
+        wrlen = fstGetVarint32Length(vchg_mem + offs + 4); /* used to advance and determine wrlen */
+#ifndef FST_REMOVE_DUPLICATE_VC
+        memcpy(xc->curval_mem + vm4ip[0], vchg_mem + offs + 4 + wrlen, vm4ip[1]); /* checkpoint variable */
+#endif
+        while(offs)
+                {
+                unsigned int idx;
+                char is_binary = 1;
+                unsigned char *pnt;
+                uint32_t time_delta;
+
+                next_offs = fstGetUint32(vchg_mem + offs);
+                offs += 4;
+
+                time_delta = fstGetVarint32(vchg_mem + offs, (int *)&wrlen);
+
+                pnt = vchg_mem+offs+wrlen;
+                offs = next_offs;
+
+                for(idx=0;idx<vm4ip[1];idx++)
+                        {
+                        if((pnt[idx] == '0') || (pnt[idx] == '1'))
+                                {
+                                continue;
+                                }
+                                else
+                                {
+                                is_binary = 0;
+                                break;
+                                }
+                        }
+
+                if(is_binary)
+                        {
+                        unsigned char acc = 0;
+                        /* new algorithm */
+                        idx = ((vm4ip[1]+7) & ~7);
+                        switch(vm4ip[1] & 7)
+                                {
+                                case 0: do {    acc  = (pnt[idx+7-8] & 1) << 0;
+                                case 7:         acc |= (pnt[idx+6-8] & 1) << 1;
+                                case 6:         acc |= (pnt[idx+5-8] & 1) << 2;
+                                case 5:         acc |= (pnt[idx+4-8] & 1) << 3;
+                                case 4:         acc |= (pnt[idx+3-8] & 1) << 4;
+                                case 3:         acc |= (pnt[idx+2-8] & 1) << 5;
+                                case 2:         acc |= (pnt[idx+1-8] & 1) << 6;
+                                case 1:         acc |= (pnt[idx+0-8] & 1) << 7;
+                                                *(--scratchpnt) = acc;
+                                                idx -= 8;
+                                        } while(idx);
+                                }
+
+                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1));
+                        }
+                        else
+                        {
+                        scratchpnt -= vm4ip[1];
+                        memcpy(scratchpnt, pnt, vm4ip[1]);
+
+                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1) | 1);
+                        }
+                }
+        }
+
+wrlen = scratchpad + xc->vchg_siz - scratchpnt;
+*unc = wrlen;
+*hdr = 0;
+*len = wrlen;
+
+if(wrlen > 32)
+        {
+        unsigned long destlen = wrlen;
+        unsigned char *dmem;
+        unsigned int rc;
+
+        if(!xc->fastpack)
+                {
+                if(wrlen <= *packmemlen)
+                        {
+                        dmem = *packmem;
+                        }
+                        else
+                        {
+                        free(*packmem);
+                        dmem = *packmem = malloc(compressBound(*packmemlen = wrlen));
+                        }
+
+                rc = compress2(dmem, &destlen, scratchpnt, wrlen, 4);
+                if(rc == Z_OK)
+                        {
+                        *hdr = wrlen;
+                        *len = destlen;
+                        return(dmem);
+                        }
+                }
+                else
+                {
+                /* this is extremely conservative: fastlz needs +5% for worst case, lz4 needs siz+(siz/255)+16 */
+                if(((wrlen * 2) + 2) <= *packmemlen)
+                        {
+                        dmem = *packmem;
+                        }
+                        else
+                        {
+                        free(*packmem);
+                        dmem = *packmem = malloc(*packmemlen = (wrlen * 2) + 2);
+                        }
+
+                rc = (xc->fourpack) ? LZ4_compress((char *)scratchpnt, (char *)dmem, wrlen) : fastlz_compress(scratchpnt, wrlen, dmem);
+                if(rc < destlen)
+                        {
+                        *hdr = wrlen;
+                        *len = rc;
+                        return(dmem);
+                        }
+                }
+        }
+
+return(scratchpnt);
+}
+
+
+static void fstWriterPackChunk(struct fstWriterTask *t)
+{
+struct fstWriterPackJob *job = (struct fstWriterPackJob *)t;
+struct fstWriterContext *xc = job->xc;
+fstHandle i;
+
+job->out_len = 0;
+for(i=job->first;i<job->last;i++)
+        {
+        uint32_t *vm4ip = &(xc->valpos_mem[4*i]);
+
+        if(vm4ip[2])
+                {
+                struct fstWriterPackedChain *pc = &job->chains[i - job->first];
+                unsigned char *data = fstWriterPackChain(xc, vm4ip, job->scratchpad, &job->packmem, &job->packmemlen,
+                                                         &pc->hdr, &pc->len, &pc->unc);
+
+                if(job->out_len + pc->len > job->out_alloc)
+                        {
+                        job->out_alloc = (job->out_len + pc->len) * 2;
+                        job->out = realloc(job->out, job->out_alloc);
+                        }
+                memcpy(job->out + job->out_len, data, pc->len);
+                pc->offs = job->out_len;
+                job->out_len += pc->len;
+                }
+        }
+}
+
+
+static void fstWriterSubmitPackJob(struct fstWriterContext *xc, struct fstWriterPackJob *job, fstHandle *next)
+{
+job->first = *next;
+job->last = ((xc->maxhandle - job->first) > FST_PACK_CHUNK_SIGS) ? (job->first + FST_PACK_CHUNK_SIGS) : xc->maxhandle;
+*next = job->last;
+fstWriterSubmitTask(xc, &job->task, fstWriterPackChunk);
+}
+
+
 #ifdef FST_WRITER_PARALLEL
 static void fstWriterFlushContextPrivate2(void *ctx)
 #else
@@ -1232,18 +1725,17 @@ static void fstWriterFlushContextPrivate(void *ctx)
 int cnt = 0;
 #endif
 unsigned int i;
-unsigned char *vchg_mem;
 FILE *f;
 off_t fpos, indxpos, endpos;
 uint32_t prevpos;
 int zerocnt;
-unsigned char *scratchpad;
-unsigned char *scratchpnt;
 unsigned char *tmem;
 off_t tlen;
 off_t unc_memreq = 0; /* for reader */
-unsigned char *packmem;
-unsigned int packmemlen;
+struct fstWriterZJob tjob;
+struct fstWriterPackJob *jobs;
+int num_jobs, j;
+fstHandle next;
 uint32_t *vm4ip;
 struct fstWriterContext *xc = (struct fstWriterContext *)ctx;
 #ifdef FST_WRITER_PARALLEL
@@ -1268,283 +1760,63 @@ if((xc->vchg_siz <= 1)||(xc->already_in_flush)) return;
 xc->already_in_flush = 1; /* should really do this with a semaphore */
 
 xc->section_header_only = 0;
-scratchpad = malloc(xc->vchg_siz);
 
-vchg_mem = xc->vchg_mem;
+/* the time table does not change during the flush so it is compressed alongside the value changes */
+fflush(xc->tchn_handle);
+tlen = ftello(xc->tchn_handle);
+fstWriterFseeko(xc, xc->tchn_handle, 0, SEEK_SET);
+
+tmem = fstMmap(NULL, tlen, PROT_READ|PROT_WRITE, MAP_SHARED, fileno(xc->tchn_handle), 0);
+if(tmem)
+        {
+        tjob.src = tmem;
+        tjob.srclen = tlen;
+        tjob.level = 9;
+        fstWriterSubmitTask(xc, &tjob.task, fstWriterZJobFunc);
+        }
 
 f = xc->handle;
 fstWriterVarint(f, xc->maxhandle);      /* emit current number of handles */
 fputc(xc->fourpack ? '4' : (xc->fastpack ? 'F' : 'Z'), f);
 fpos = 1;
 
-packmemlen = 1024;                      /* maintain a running "longest" allocation to */
-packmem = malloc(packmemlen);           /* prevent continual malloc...free every loop iter */
-
-for(i=0;i<xc->maxhandle;i++)
-        {
-        vm4ip = &(xc->valpos_mem[4*i]);
-
-        if(vm4ip[2])
-                {
-                uint32_t offs = vm4ip[2];
-                uint32_t next_offs;
-                unsigned int wrlen;
-
-                vm4ip[2] = fpos;
-
-                scratchpnt = scratchpad + xc->vchg_siz;         /* build this buffer backwards */
-                if(vm4ip[1] <= 1)
-                        {
-                        if(vm4ip[1] == 1)
-                                {
-                                wrlen = fstGetVarint32Length(vchg_mem + offs + 4); /* used to advance and determine wrlen */
-#ifndef FST_REMOVE_DUPLICATE_VC
-                                xc->curval_mem[vm4ip[0]] = vchg_mem[offs + 4 + wrlen]; /* checkpoint variable */
-#endif
-                                while(offs)
-                                        {
-                                        unsigned char val;
-                                        uint32_t time_delta, rcv;
-                                        next_offs = fstGetUint32(vchg_mem + offs);
-                                        offs += 4;
-
-                                        time_delta = fstGetVarint32(vchg_mem + offs, (int *)&wrlen);
-                                        val = vchg_mem[offs+wrlen];
-                                        offs = next_offs;
-
-                                        switch(val)
-                                                {
-                                                case '0':
-                                                case '1':               rcv = ((val&1)<<1) | (time_delta<<2);
-                                                                        break; /* pack more delta bits in for 0/1 vchs */
-
-                                                case 'x': case 'X':     rcv = FST_RCV_X | (time_delta<<4); break;
-                                                case 'z': case 'Z':     rcv = FST_RCV_Z | (time_delta<<4); break;
-                                                case 'h': case 'H':     rcv = FST_RCV_H | (time_delta<<4); break;
-                                                case 'u': case 'U':     rcv = FST_RCV_U | (time_delta<<4); break;
-                                                case 'w': case 'W':     rcv = FST_RCV_W | (time_delta<<4); break;
-                                                case 'l': case 'L':     rcv = FST_RCV_L | (time_delta<<4); break;
-                                                default:                rcv = FST_RCV_D | (time_delta<<4); break;
-                                                }
-
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, rcv);
-                                        }
-                                }
-                                else
-                                {
-                                /* variable length */
-                                /* fstGetUint32 (next_offs) + fstGetVarint32 (time_delta) + fstGetVarint32 (len) + payload */
-                                unsigned char *pnt;
-                                uint32_t record_len;
-                                uint32_t time_delta;
-
-                                while(offs)
-                                        {
-                                        next_offs = fstGetUint32(vchg_mem + offs);
-                                        offs += 4;
-                                        pnt = vchg_mem + offs;
-                                        offs = next_offs;
-                                        time_delta = fstGetVarint32(pnt, (int *)&wrlen);
-                                        pnt += wrlen;
-                                        record_len = fstGetVarint32(pnt, (int *)&wrlen);
-                                        pnt += wrlen;
-
-                                        scratchpnt -= record_len;
-                                        memcpy(scratchpnt, pnt, record_len);
-
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, record_len);
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1)); /* reserve | 1 case for future expansion */
-                                        }
-                                }
-                        }
-                        else
-                        {
-                        wrlen = fstGetVarint32Length(vchg_mem + offs + 4); /* used to advance and determine wrlen */
-#ifndef FST_REMOVE_DUPLICATE_VC
-                        memcpy(xc->curval_mem + vm4ip[0], vchg_mem + offs + 4 + wrlen, vm4ip[1]); /* checkpoint variable */
+/* chains are packed in chunks of signals, several chunks in flight when there are workers */
+#ifdef FST_WRITER_PACK_THREADS
+num_jobs = xc->pool ? (xc->pool->num_threads * FST_PACK_CHUNKS_PER_THREAD) : 1;
+#else
+num_jobs = 1;
 #endif
-                        while(offs)
-                                {
-                                unsigned int idx;
-                                char is_binary = 1;
-                                unsigned char *pnt;
-                                uint32_t time_delta;
-
-                                next_offs = fstGetUint32(vchg_mem + offs);
-                                offs += 4;
-
-                                time_delta = fstGetVarint32(vchg_mem + offs, (int *)&wrlen);
-
-                                pnt = vchg_mem+offs+wrlen;
-                                offs = next_offs;
-
-                                for(idx=0;idx<vm4ip[1];idx++)
-                                        {
-                                        if((pnt[idx] == '0') || (pnt[idx] == '1'))
-                                                {
-                                                continue;
-                                                }
-                                                else
-                                                {
-                                                is_binary = 0;
-                                                break;
-                                                }
-                                        }
+jobs = calloc(num_jobs, sizeof(struct fstWriterPackJob));
+next = 0;
+for(j=0;j<num_jobs;j++)
+        {
+        jobs[j].xc = xc;
+        jobs[j].scratchpad = malloc(xc->vchg_siz);
+        jobs[j].packmemlen = 1024;                      /* maintain a running "longest" allocation to */
+        jobs[j].packmem = malloc(jobs[j].packmemlen);   /* prevent continual malloc...free every loop iter */
+        if(next < xc->maxhandle) fstWriterSubmitPackJob(xc, &jobs[j], &next);
+        }
 
-                                if(is_binary)
-                                        {
-                                        unsigned char acc = 0;
-                                        /* new algorithm */
-                                        idx = ((vm4ip[1]+7) & ~7);
-                                        switch(vm4ip[1] & 7)
-                                                {
-                                                case 0: do {    acc  = (pnt[idx+7-8] & 1) << 0;
-                                                case 7:         acc |= (pnt[idx+6-8] & 1) << 1;
-                                                case 6:         acc |= (pnt[idx+5-8] & 1) << 2;
-                                                case 5:         acc |= (pnt[idx+4-8] & 1) << 3;
-                                                case 4:         acc |= (pnt[idx+3-8] & 1) << 4;
-                                                case 3:         acc |= (pnt[idx+2-8] & 1) << 5;
-                                                case 2:         acc |= (pnt[idx+1-8] & 1) << 6;
-                                                case 1:         acc |= (pnt[idx+0-8] & 1) << 7;
-                                                                *(--scratchpnt) = acc;
-                                                                idx -= 8;
-                                                        } while(idx);
-                                                }
+for(i=0,j=0;i<xc->maxhandle;j=(j+1)%num_jobs)
+        {
+        struct fstWriterPackJob *job = &jobs[j];
 
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1));
-                                        }
-                                        else
-                                        {
-                                        scratchpnt -= vm4ip[1];
-                                        memcpy(scratchpnt, pnt, vm4ip[1]);
+        fstWriterWaitTask(xc, &job->task);
 
-                                        scratchpnt = fstCopyVarint32ToLeft(scratchpnt, (time_delta << 1) | 1);
-                                        }
-                                }
-                        }
+        for(i=job->first;i<job->last;i++)
+                {
+                vm4ip = &(xc->valpos_mem[4*i]);
 
-                wrlen = scratchpad + xc->vchg_siz - scratchpnt;
-                unc_memreq += wrlen;
-                if(wrlen > 32)
+                if(vm4ip[2])
                         {
-                        unsigned long destlen = wrlen;
-                        unsigned char *dmem;
-                        unsigned int rc;
+                        struct fstWriterPackedChain *pc = &job->chains[i - job->first];
+                        unsigned char *data = job->out + pc->offs;
 
-                        if(!xc->fastpack)
-                                {
-                                if(wrlen <= packmemlen)
-                                        {
-                                        dmem = packmem;
-                                        }
-                                        else
-                                        {
-                                        free(packmem);
-                                        dmem = packmem = malloc(compressBound(packmemlen = wrlen));
-                                        }
-
-                                rc = compress2(dmem, &destlen, scratchpnt, wrlen, 4);
-                                if(rc == Z_OK)
-                                        {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                        PPvoid_t pv = JudyHSIns(&PJHSArray, dmem, destlen, NULL);
-                                        if(*pv)
-                                                {
-                                                uint32_t pvi = (intptr_t)(*pv);
-                                                vm4ip[2] = -pvi;
-                                                }
-                                                else
-                                                {
-                                                *pv = (void *)(intptr_t)(i+1);
-#endif
-                                                fpos += fstWriterVarint(f, wrlen);
-                                                fpos += destlen;
-                                                fstFwrite(dmem, destlen, 1, f);
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                                }
-#endif
-                                        }
-                                        else
-                                        {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                        PPvoid_t pv = JudyHSIns(&PJHSArray, scratchpnt, wrlen, NULL);
-                                        if(*pv)
-                                                {
-                                                uint32_t pvi = (intptr_t)(*pv);
-                                                vm4ip[2] = -pvi;
-                                                }
-                                                else
-                                                {
-                                                *pv = (void *)(intptr_t)(i+1);
-#endif
-                                                fpos += fstWriterVarint(f, 0);
-                                                fpos += wrlen;
-                                                fstFwrite(scratchpnt, wrlen, 1, f);
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                                }
-#endif
-                                        }
-                                }
-                                else
-                                {
-                                /* this is extremely conservative: fastlz needs +5% for worst case, lz4 needs siz+(siz/255)+16 */
-                                if(((wrlen * 2) + 2) <= packmemlen)
-                                        {
-                                        dmem = packmem;
-                                        }
-                                        else
-                                        {
-                                        free(packmem);
-                                        dmem = packmem = malloc(packmemlen = (wrlen * 2) + 2);
-                                        }
-
-                                rc = (xc->fourpack) ? LZ4_compress((char *)scratchpnt, (char *)dmem, wrlen) : fastlz_compress(scratchpnt, wrlen, dmem);
-                                if(rc < destlen)
-                                        {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                        PPvoid_t pv = JudyHSIns(&PJHSArray, dmem, rc, NULL);
-                                        if(*pv)
-                                                {
-                                                uint32_t pvi = (intptr_t)(*pv);
-                                                vm4ip[2] = -pvi;
-                                                }
-                                                else
-                                                {
-                                                *pv = (void *)(intptr_t)(i+1);
-#endif
-                                                fpos += fstWriterVarint(f, wrlen);
-                                                fpos += rc;
-                                                fstFwrite(dmem, rc, 1, f);
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                                }
-#endif
-                                        }
-                                        else
-                                        {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                        PPvoid_t pv = JudyHSIns(&PJHSArray, scratchpnt, wrlen, NULL);
-                                        if(*pv)
-                                                {
-                                                uint32_t pvi = (intptr_t)(*pv);
-                                                vm4ip[2] = -pvi;
-                                                }
-                                                else
-                                                {
-                                                *pv = (void *)(intptr_t)(i+1);
-#endif
-                                                fpos += fstWriterVarint(f, 0);
-                                                fpos += wrlen;
-                                                fstFwrite(scratchpnt, wrlen, 1, f);
+                        vm4ip[2] = fpos;
+                        unc_memreq += pc->unc;
 #ifndef FST_DYNAMIC_ALIAS_DISABLE
-                                                }
-#endif
-                                        }
-                                }
-                        }
-                        else
                         {
-#ifndef FST_DYNAMIC_ALIAS_DISABLE
-                        PPvoid_t pv = JudyHSIns(&PJHSArray, scratchpnt, wrlen, NULL);
+                        PPvoid_t pv = JudyHSIns(&PJHSArray, data, pc->len, NULL);
                         if(*pv)
                                 {
                                 uint32_t pvi = (intptr_t)(*pv);
@@ -1554,29 +1826,37 @@ for(i=0;i<xc->maxhandle;i++)
                                 {
                                 *pv = (void *)(intptr_t)(i+1);
 #endif
-                                fpos += fstWriterVarint(f, 0);
-                                fpos += wrlen;
-                                fstFwrite(scratchpnt, wrlen, 1, f);
+                                fpos += fstWriterVarint(f, pc->hdr);
+                                fpos += pc->len;
+                                fstFwrite(data, pc->len, 1, f);
 #ifndef FST_DYNAMIC_ALIAS_DISABLE
                                 }
-#endif
                         }
+#endif
 
-                /* vm4ip[3] = 0; ...redundant with clearing below */
+                        /* vm4ip[3] = 0; ...redundant with clearing below */
 #ifdef FST_DEBUG
-                cnt++;
+                        cnt++;
 #endif
+                        }
                 }
+
+        if(next < xc->maxhandle) fstWriterSubmitPackJob(xc, job, &next);
         }
 
 #ifndef FST_DYNAMIC_ALIAS_DISABLE
 JudyHSFreeArray(&PJHSArray, NULL);
 #endif
 
-free(packmem); packmem = NULL; /* packmemlen = 0; */ /* scan-build */
+for(j=0;j<num_jobs;j++)
+        {
+        free(jobs[j].scratchpad);
+        free(jobs[j].packmem);
+        free(jobs[j].out);
+        }
+free(jobs); jobs = NULL;
 
 prevpos = 0; zerocnt = 0;
-free(scratchpad); scratchpad = NULL;
 
 indxpos = ftello(f);
 xc->secnum++;
@@ -1673,30 +1953,23 @@ endpos = ftello(xc->handle);
 fstWriterUint64(xc->handle, endpos-indxpos);            /* write delta index position at very end of block */
 
 /*emit time changes for block */
-fflush(xc->tchn_handle);
-tlen = ftello(xc->tchn_handle);
-fstWriterFseeko(xc, xc->tchn_handle, 0, SEEK_SET);
-
-tmem = fstMmap(NULL, tlen, PROT_READ|PROT_WRITE, MAP_SHARED, fileno(xc->tchn_handle), 0);
 if(tmem)
         {
-        unsigned long destlen = tlen;
-        unsigned char *dmem = malloc(compressBound(destlen));
-        int rc = compress2(dmem, &destlen, tmem, tlen, 9);
+        fstWriterWaitTask(xc, &tjob.task);
 
-        if((rc == Z_OK) && (((off_t)destlen) < tlen))
+        if((tjob.rc == Z_OK) && (((off_t)tjob.destlen) < tlen))
                 {
-                fstFwrite(dmem, destlen, 1, xc->handle);
+                fstFwrite(tjob.dmem, tjob.destlen, 1, xc->handle);
                 }
                 else /* comparison between compressed / decompressed len tells if compressed */
                 {
                 fstFwrite(tmem, tlen, 1, xc->handle);
-                destlen = tlen;
+                tjob.destlen = tlen;
                 }
-        free(dmem);
+        free(tjob.dmem);
         fstMunmap(tmem, tlen);
         fstWriterUint64(xc->handle, tlen);              /* uncompressed */
-        fstWriterUint64(xc->handle, destlen);           /* compressed */
+        fstWriterUint64(xc->handle, tjob.destlen);      /* compressed */
         fstWriterUint64(xc->handle, xc->tchn_cnt);      /* number of time items */
         }
 
@@ -1852,6 +2125,76 @@ if(xc)
 }
 
 
+/*
+ * hierarchy packing for fstWriterClose().  the gzip variant is only
+ * used with a worker pool, otherwise the hierarchy is streamed into
+ * the file with gzwrite() as before.
+ */
+struct fstWriterHierJob
+{
+struct fstWriterTask task;      /* must be first */
+struct fstWriterContext *xc;
+unsigned char *mem;
+unsigned long packed_len;
+unsigned char *mem_duo;
+int packed_len_duo;
+int fourpack_duo;
+};
+
+
+static void fstWriterHierJobFunc(struct fstWriterTask *t)
+{
+struct fstWriterHierJob *job = (struct fstWriterHierJob *)t;
+struct fstWriterContext *xc = job->xc;
+unsigned char *hmem = fstMmap(NULL, xc->hier_file_len, PROT_READ|PROT_WRITE, MAP_SHARED, fileno(xc->hier_handle), 0);
+
+if(!xc->fourpack)
+        {
+        z_stream strm;
+
+        memset(&strm, 0, sizeof(strm));
+        if(deflateInit2(&strm, 4, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK) /* same stream as gzdopen(fd, "wb4") */
+                {
+                unsigned long maxlen = deflateBound(&strm, xc->hier_file_len);
+
+                job->mem = malloc(maxlen);
+                strm.next_in = hmem;
+                strm.avail_in = xc->hier_file_len;
+                strm.next_out = job->mem;
+                strm.avail_out = maxlen;
+                if(deflate(&strm, Z_FINISH) == Z_STREAM_END)
+                        {
+                        job->packed_len = strm.total_out;
+                        }
+                        else
+                        {
+                        free(job->mem); job->mem = NULL;
+                        }
+                deflateEnd(&strm);
+                }
+        }
+        else
+        {
+        int lz4_maxlen = LZ4_compressBound(xc->hier_file_len);
+
+        job->mem = malloc(lz4_maxlen);
+        job->packed_len = LZ4_compress((char *)hmem, (char *)job->mem, xc->hier_file_len);
+
+        job->fourpack_duo = (!xc->repack_on_close) && (xc->hier_file_len > FST_HDR_FOURPACK_DUO_SIZE); /* double pack when hierarchy is large */
+
+        if(job->fourpack_duo)   /* double packing with LZ4 is faster than gzip */
+                {
+                int lz4_maxlen_duo = LZ4_compressBound(job->packed_len);
+
+                job->mem_duo = malloc(lz4_maxlen_duo);
+                job->packed_len_duo = LZ4_compress((char *)job->mem, (char *)job->mem_duo, job->packed_len);
+                }
+        }
+
+fstMunmap(hmem, xc->hier_file_len);
+}
+
+
 /*
  * close out FST file
  */
@@ -1871,9 +2214,38 @@ if(xc && !xc->already_in_close && !xc->already_in_flush)
         {
         unsigned char *tmem;
         off_t fixup_offs, tlen, hlen;
+        struct fstWriterZJob gjob;
+        struct fstWriterHierJob hjob;
 
         xc->already_in_close = 1; /* never need to zero this out as it is freed at bottom */
 
+        /* the geometry and hierarchy are complete, so pack them while the last block is flushed */
+        fflush(xc->geom_handle);
+        tlen = ftello(xc->geom_handle);
+        tmem = fstMmap(NULL, tlen, PROT_READ|PROT_WRITE, MAP_SHARED, fileno(xc->geom_handle), 0);
+        if(tmem)
+                {
+                gjob.src = tmem;
+                gjob.srclen = tlen;
+                gjob.level = 9;
+                fstWriterSubmitTask(xc, &gjob.task, fstWriterZJobFunc);
+                }
+
+        memset(&hjob, 0, sizeof(hjob));
+        hjob.xc = xc;
+        if(xc->compress_hier)
+                {
+                fflush(xc->hier_handle);
+#ifdef FST_WRITER_PACK_THREADS
+                if(xc->fourpack || (xc->pool && xc->hier_file_len && (xc->hier_file_len == (off_t)(uInt)xc->hier_file_len)))
+#else
+                if(xc->fourpack)
+#endif
+                        {
+                        fstWriterSubmitTask(xc, &hjob.task, fstWriterHierJobFunc);
+                        }
+                }
+
         if(xc->section_header_only && xc->section_header_truncpos && (xc->vchg_siz <= 1) && (!xc->is_initial_time))
                 {
                 fstFtruncate(fileno(xc->handle), xc->section_header_truncpos);
@@ -1905,14 +2277,16 @@ if(xc && !xc->already_in_close && !xc->already_in_flush)
         fstDestroyMmaps(xc, 1);
 
         /* write out geom section */
-        fflush(xc->geom_handle);
-        tlen = ftello(xc->geom_handle);
-        tmem = fstMmap(NULL, tlen, PROT_READ|PROT_WRITE, MAP_SHARED, fileno(xc->geom_handle), 0);
         if(tmem)
                 {
-                unsigned long destlen = tlen;
-                unsigned char *dmem = malloc(compressBound(destlen));
-                int rc = compress2(dmem, &destlen, tmem, tlen, 9);
+                unsigned long destlen;
+                unsigned char *dmem;
+                int rc;
+
+                fstWriterWaitTask(xc, &gjob.task);
+                destlen = gjob.destlen;
+                dmem = gjob.dmem;
+                rc = gjob.rc;
 
                 if((rc != Z_OK) || (((off_t)destlen) > tlen))
                         {
@@ -1988,7 +2362,17 @@ if(xc && !xc->already_in_close && !xc->already_in_flush)
                 fstWriterUint64(xc->handle, 0);                 /* section length */
                 fstWriterUint64(xc->handle, xc->hier_file_len); /* uncompressed length */
 
-                if(!xc->fourpack)
+                if(hjob.task.func)
+                        {
+                        fstWriterWaitTask(xc, &hjob.task);
+                        }
+
+                if(!xc->fourpack && hjob.mem)
+                        {
+                        fstFwrite(hjob.mem, hjob.packed_len, 1, xc->handle);
+                        free(hjob.mem);
+                        }
+                else if(!xc->fourpack)
                         {
                         unsigned char *mem = malloc(FST_GZIO_LEN);
                         zfd = dup(fileno(xc->handle));
@@ -2013,41 +2397,22 @@ if(xc && !xc->already_in_close && !xc->already_in_flush)
                         }
                         else
                         {
-                        int lz4_maxlen;
-                        unsigned char *mem;
-                        unsigned char *hmem;
-                        int packed_len;
-
                         fflush(xc->handle);
 
-                        lz4_maxlen = LZ4_compressBound(xc->hier_file_len);
-                        mem = malloc(lz4_maxlen);
-                        hmem = fstMmap(NULL, xc->hier_file_len, PROT_READ|PROT_WRITE, MAP_SHARED, fileno(xc->hier_handle), 0);
-                        packed_len = LZ4_compress((char *)hmem, (char *)mem, xc->hier_file_len);
-                        fstMunmap(hmem, xc->hier_file_len);
-
-                        fourpack_duo = (!xc->repack_on_close) && (xc->hier_file_len > FST_HDR_FOURPACK_DUO_SIZE); /* double pack when hierarchy is large */
+                        fourpack_duo = hjob.fourpack_duo;
 
                         if(fourpack_duo)        /* double packing with LZ4 is faster than gzip */
                                 {
-                                unsigned char *mem_duo;
-                                int lz4_maxlen_duo;
-                                int packed_len_duo;
-
-                                lz4_maxlen_duo = LZ4_compressBound(packed_len);
-                                mem_duo = malloc(lz4_maxlen_duo);
-                                packed_len_duo = LZ4_compress((char *)mem, (char *)mem_duo, packed_len);
-
-                                fstWriterVarint(xc->handle, packed_len); /* 1st round compressed length */
-                                fstFwrite(mem_duo, packed_len_duo, 1, xc->handle);
-                                free(mem_duo);
+                                fstWriterVarint(xc->handle, hjob.packed_len); /* 1st round compressed length */
+                                fstFwrite(hjob.mem_duo, hjob.packed_len_duo, 1, xc->handle);
+                                free(hjob.mem_duo);
                                 }
                                 else
                                 {
-                                fstFwrite(mem, packed_len, 1, xc->handle);
+                                fstFwrite(hjob.mem, hjob.packed_len, 1, xc->handle);
                                 }
 
-                        free(mem);
+                        free(hjob.mem);
                         }
 
                 fstWriterFseeko(xc, xc->handle, 0, SEEK_END);
@@ -2177,6 +2542,10 @@ if(xc && !xc->already_in_close && !xc->already_in_flush)
         pthread_attr_destroy(&xc->thread_attr);
 #endif
 
+#ifdef FST_WRITER_PACK_THREADS
+        if(xc->pool) fstWriterPoolDestroy(xc->pool);
+#endif
+
         if(xc->path_array)
                 {
 #ifndef _WAVE_HAVE_JUDY
@@ -2486,6 +2855,38 @@ if(xc)
 }
 
 
+/*
+ * compress the value change blocks, the time tables and the geometry
+ * and hierarchy sections on a pool of num_threads worker threads.
+ * zero (the default) packs everything on the calling thread.  blocks
+ * are still written in order, the file is the same either way.
+ */
+void fstWriterSetPackThreads(void *ctx, int num_threads)
+{
+struct fstWriterContext *xc = (struct fstWriterContext *)ctx;
+if(xc)
+        {
+#ifdef FST_WRITER_PACK_THREADS
+#ifdef FST_WRITER_PARALLEL
+        pthread_mutex_lock(&xc->mutex);
+        pthread_mutex_unlock(&xc->mutex);
+#endif
+        if(xc->pool)
+                {
+                fstWriterPoolDestroy(xc->pool);
+                xc->pool = NULL;
+                }
+        if(num_threads > 0)
+                {
+                xc->pool = fstWriterPoolCreate(num_threads);
+                }
+#else
+        (void)num_threads;
+#endif
+        }
+}
+
+
 void fstWriterSetDumpSizeLimit(void *ctx, uint64_t numbytes)
 {
 struct fstWriterContext *xc = (struct fstWriterContext *)ctx;
@@ -44,6 +44,8 @@ struct vcd_info {
       struct vcd_info *next;
       struct vcd_info *dmp_next;
       fstHandle handle;
+      PLI_INT32 type;
+      unsigned size;
       int scheduled;
 };
 
@@ -56,6 +58,19 @@ static long dump_limit = 0;
 static int dump_is_full = 0;
 static int finish_status = 0;
 
+/*
+ * Unless -fst-sync is given, the value changes are sent to the FST
+ * writer by a work thread, the same way as for the VCD dumper. The
+ * simulation thread must call vcd_work_sync() before it uses the
+ * dump_file (or vcd_cur_time) itself.
+ */
+static int dump_sync = 0;
+static int dump_thread = 0;
+static volatile int dump_limit_hit = 0;
+
+/* The number of compression threads given with +fst_threads=N. */
+static int pack_threads = 0;
+
 
 static enum lxm_optimum_mode_e {
       LXM_NONE  = 0,
@@ -89,6 +104,25 @@ static void show_this_item(struct vcd_info*info)
       }
 }
 
+/* Send the value to the work thread. */
+static void queue_this_item(struct vcd_info*info)
+{
+      s_vpi_value value;
+
+      if (info->type == vpiRealVar) {
+	    value.format = vpiRealVal;
+	    vpi_get_value(info->item, &value);
+	    vcd_work_emit_real(info, value.value.real);
+      } else if (info->type == vpiNamedEvent) {
+	    static const s_vpi_vecval one = { 1, 0 };
+	    vcd_work_emit_vector(info, 1, &one);
+      } else {
+	    value.format = vpiVectorVal;
+	    vpi_get_value(info->item, &value);
+	    vcd_work_emit_vector(info, info->size, value.value.vector);
+      }
+}
+
 /* Dump values for a $dumpoff. */
 static void show_this_item_x(struct vcd_info*info)
 {
@@ -150,6 +184,18 @@ static PLI_INT32 variable_cb_2(p_cb_data cause)
       struct vcd_info* info = vcd_dmp_list;
       PLI_UINT64 now = timerec_to_time64(cause->time);
 
+      if (dump_thread) {
+	      /* The work thread emits the time change. */
+	    vcd_work_set_time(now);
+	    do {
+		  queue_this_item(info);
+		  info->scheduled = 0;
+	    } while ((info = info->dmp_next) != 0);
+
+	    vcd_dmp_list = 0;
+	    return 0;
+      }
+
       if (now != vcd_cur_time) {
 	    fstWriterEmitTimeChange(dump_file, now);
 	    vcd_cur_time = now;
@@ -165,6 +211,17 @@ static PLI_INT32 variable_cb_2(p_cb_data cause)
       return 0;
 }
 
+static int dump_limit_exceeded(void)
+{
+      if (dump_thread) {
+	    if (! dump_limit_hit) return 0;
+	    vcd_work_sync();
+	    return 1;
+      }
+
+      return fstWriterGetDumpSizeLimitReached(dump_file);
+}
+
 static PLI_INT32 variable_cb_1(p_cb_data cause)
 {
       struct t_cb_data cb;
@@ -175,7 +232,7 @@ static PLI_INT32 variable_cb_1(p_cb_data cause)
       if (dump_header_pending()) return 0;
       if (info->scheduled) return 0;
 
-      if ((dump_limit > 0) && fstWriterGetDumpSizeLimitReached(dump_file)) {
+      if ((dump_limit > 0) && dump_limit_exceeded()) {
             dump_is_full = 1;
             vpi_printf("WARNING: Dump file limit (%ld bytes) "
                                "exceeded.\n", dump_limit);
@@ -203,6 +260,8 @@ static PLI_INT32 dumpvars_cb(p_cb_data cause)
 
       dumpvars_status = 2;
 
+      vcd_work_sync();
+
       dumpvars_time = timerec_to_time64(cause->time);
       vcd_cur_time = dumpvars_time;
 
@@ -226,6 +285,11 @@ static PLI_INT32 finish_cb(p_cb_data cause)
 
       finish_status = 1;
 
+      if (dump_thread) {
+	    vcd_work_terminate();
+	    dump_thread = 0;
+      }
+
       dumpvars_time = timerec_to_time64(cause->time);
 
       if (!dump_is_off && !dump_is_full && dumpvars_time != vcd_cur_time) {
@@ -292,6 +356,8 @@ static PLI_INT32 sys_dumpoff_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       if (dump_file == 0) return 0;
       if (dump_header_pending()) return 0;
 
+      vcd_work_sync();
+
       now.type = vpiSimTime;
       vpi_get_time(0, &now);
       now64 = timerec_to_time64(&now);
@@ -321,6 +387,8 @@ static PLI_INT32 sys_dumpon_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       if (dump_file == 0) return 0;
       if (dump_header_pending()) return 0;
 
+      vcd_work_sync();
+
       now.type = vpiSimTime;
       vpi_get_time(0, &now);
       now64 = timerec_to_time64(&now);
@@ -347,6 +415,8 @@ static PLI_INT32 sys_dumpall_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       if (dump_file == 0) return 0;
       if (dump_header_pending()) return 0;
 
+      vcd_work_sync();
+
       now.type = vpiSimTime;
       vpi_get_time(0, &now);
       now64 = timerec_to_time64(&now);
@@ -362,6 +432,63 @@ static PLI_INT32 sys_dumpall_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       return 0;
 }
 
+/*
+ * This is the work thread that formats the value changes that the
+ * variable_cb_2 callback queues and passes them to the FST writer.
+ */
+static void* fst_thread(void*arg)
+{
+      char*buf = 0;
+      unsigned buf_size = 0;
+      int run_flag = 1;
+
+      (void)arg; /* Parameter is not used. */
+
+      while (run_flag) {
+	    struct vcd_work_item_s*cell = vcd_work_thread_peek();
+	    struct vcd_info*info = (struct vcd_info*)cell->sym_.info;
+
+	    switch (cell->type) {
+		case WT_EMIT_DOUBLE:
+		case WT_EMIT_VECTOR:
+		  if (cell->time != vcd_cur_time) {
+			fstWriterEmitTimeChange(dump_file, cell->time);
+			vcd_cur_time = cell->time;
+		  }
+
+		  if (cell->type == WT_EMIT_DOUBLE) {
+			fstWriterEmitValueChange(dump_file, info->handle,
+			                         &cell->op_.val_double);
+		  } else {
+			if (cell->wid >= buf_size) {
+			      buf_size = cell->wid + 1;
+			      buf = realloc(buf, buf_size);
+			}
+			vcd_work_vec_to_bits(buf, cell->wid,
+			                     vcd_work_item_vec(cell));
+			fstWriterEmitValueChange(dump_file, info->handle, buf);
+		  }
+
+		  if ((dump_limit > 0) &&
+		      fstWriterGetDumpSizeLimitReached(dump_file))
+			dump_limit_hit = 1;
+		  break;
+
+		case WT_TERMINATE:
+		  run_flag = 0;
+		  break;
+
+		default:
+		  break;
+	    }
+
+	    vcd_work_thread_pop();
+      }
+
+      free(buf);
+      return 0;
+}
+
 static void open_dumpfile(vpiHandle callh)
 {
       if (dump_path == 0) dump_path = strdup("dump.fst");
@@ -412,6 +539,14 @@ static void open_dumpfile(vpiHandle callh)
 	        (lxm_optimum_mode == LXM_BOTH)) {
 		  fstWriterSetRepackOnClose(dump_file, 1);
 	    }
+	    if (pack_threads > 0) {
+		  fstWriterSetPackThreads(dump_file, pack_threads);
+	    }
+
+	    if (!dump_sync) {
+		  vcd_work_start(fst_thread, 0);
+		  dump_thread = 1;
+	    }
       }
 }
 
@@ -453,7 +588,10 @@ static PLI_INT32 sys_dumpfile_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 static PLI_INT32 sys_dumpflush_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 {
       (void)name; /* Parameter is not used. */
-      if (dump_file) fstWriterFlushContext(dump_file);
+      if (dump_file) {
+	    vcd_work_sync();
+	    fstWriterFlushContext(dump_file);
+      }
 
       return 0;
 }
@@ -469,6 +607,7 @@ static PLI_INT32 sys_dumplimit_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
       /* Get the value and set the dump limit. */
       val.format = vpiIntVal;
       vpi_get_value(vpi_scan(argv), &val);
+      vcd_work_sync();
       dump_limit = val.value.integer;
       fstWriterSetDumpSizeLimit(dump_file, dump_limit);
 
@@ -589,6 +728,9 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 	       * scope then just return. */
             if (skip || vpi_get(vpiAutomatic, item)) return;
 
+	      /* Leave out the signals that +dumpfilter rejects. */
+	    if (vcd_filter_skip_var(item, fullname)) return;
+
 	      /* Skip this signal if it has already been included.
 	       * This can only happen for implicitly given signals. */
 	    if (vcd_names_search(&fst_var, fullname)) return;
@@ -643,6 +785,8 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 		  info->time.type = vpiSimTime;
 		  info->item  = item;
 		  info->handle = new_ident;
+		  info->type  = item_type;
+		  info->size  = size;
 		  info->scheduled = 0;
 
 		  cb.time      = &info->time;
@@ -668,7 +812,7 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 	  case vpiNamedBegin:
 	  case vpiNamedFork:
 
-	    if (depth > 0) {
+	    if (depth > 0 && !vcd_filter_skip_scope(fullname)) {
 		  char *instname;
 		  char *defname = NULL;
 		  /* list of types to iterate upon */
@@ -915,6 +1059,12 @@ void sys_fst_register(void)
 		  lxm_optimum_mode = LXM_BOTH;
 	    } else if (strcmp(vlog_info.argv[idx],"-fst-speed-space") == 0) {
 		  lxm_optimum_mode = LXM_BOTH;
+
+	    } else if (strcmp(vlog_info.argv[idx],"-fst-sync") == 0) {
+		  dump_sync = 1;
+
+	    } else if (strncmp(vlog_info.argv[idx],"+fst_threads=",13) == 0) {
+		  pack_threads = atoi(vlog_info.argv[idx]+13);
 	    }
       }
 
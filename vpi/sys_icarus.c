@@ -18,6 +18,8 @@
 
 #include "sys_priv.h"
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
 static PLI_INT32 finish_and_return_calltf(ICARUS_VPI_CONST PLI_BYTE8* name)
 {
@@ -41,6 +43,25 @@ static PLI_INT32 finish_and_return_calltf(ICARUS_VPI_CONST PLI_BYTE8* name)
     return 0;
 }
 
+/*
+ * $save and $incsave ask the run time to write a checkpoint of the
+ * simulation at the end of the current time step. The checkpoint is
+ * restarted with the vvp -r flag, so $restart is not implemented.
+ */
+static PLI_INT32 save_calltf(ICARUS_VPI_CONST PLI_BYTE8* name)
+{
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+      char *path = get_filename(callh, name, vpi_scan(argv));
+
+      vpi_free_object(argv);
+      if (path == 0) return 0;
+
+      vpip_checkpoint_request(path, strcmp(name, "$incsave") == 0);
+      free(path);
+      return 0;
+}
+
 static PLI_INT32 task_not_implemented_compiletf(ICARUS_VPI_CONST PLI_BYTE8* name)
 {
       vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
@@ -82,6 +103,20 @@ void sys_special_register(void)
       tf_data.tfname      = "$finish_and_return";
       tf_data.user_data   = "$finish_and_return";
       res = vpi_register_systf(&tf_data);
+      vpip_make_systf_system_defined(res);
+
+      tf_data.type        = vpiSysTask;
+      tf_data.calltf      = save_calltf;
+      tf_data.compiletf   = sys_one_string_arg_compiletf;
+      tf_data.sizetf      = 0;
+      tf_data.tfname      = "$save";
+      tf_data.user_data   = "$save";
+      res = vpi_register_systf(&tf_data);
+      vpip_make_systf_system_defined(res);
+
+      tf_data.tfname      = "$incsave";
+      tf_data.user_data   = "$incsave";
+      res = vpi_register_systf(&tf_data);
       vpip_make_systf_system_defined(res);
 
 	/* These tasks are not currently implemented. */
@@ -257,21 +292,11 @@ void sys_special_register(void)
       res = vpi_register_systf(&tf_data);
       vpip_make_systf_system_defined(res);
 
-      tf_data.tfname      = "$save";
-      tf_data.user_data   = "$save";
-      res = vpi_register_systf(&tf_data);
-      vpip_make_systf_system_defined(res);
-
       tf_data.tfname      = "$restart";
       tf_data.user_data   = "$restart";
       res = vpi_register_systf(&tf_data);
       vpip_make_systf_system_defined(res);
 
-      tf_data.tfname      = "$incsave";
-      tf_data.user_data   = "$incsave";
-      res = vpi_register_systf(&tf_data);
-      vpip_make_systf_system_defined(res);
-
       tf_data.tfname      = "$scope";
       tf_data.user_data   = "$scope";
       res = vpi_register_systf(&tf_data);
@@ -570,6 +570,8 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
             }
 
             if (skip || vpi_get(vpiAutomatic, item)) break;
+	    if (vcd_filter_skip_var(item, vpi_get_str(vpiFullName, item)))
+		  break;
 
 	    name = vpi_get_str(vpiName, item);
 	    nexus_id = vpi_get(_vpiNexusId, item);
@@ -621,6 +623,8 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 	  case vpiRealVar:
 
             if (skip || vpi_get(vpiAutomatic, item)) break;
+	    if (vcd_filter_skip_var(item, vpi_get_str(vpiFullName, item)))
+		  break;
 
 	    name = vpi_get_str(vpiName, item);
 	    { char*tmp = create_full_name(name);
@@ -658,7 +662,8 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 	  case vpiNamedBegin:
 	  case vpiNamedFork:
 
-	    if (depth > 0) {
+	    if (depth > 0 &&
+	        !vcd_filter_skip_scope(vpi_get_str(vpiFullName, item))) {
 		  const char* fullname = vpi_get_str(vpiFullName, item);
 		  /* list of types to iterate upon */
 		  static int types[] = {
@@ -630,6 +630,8 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
             }
 
             if (skip || vpi_get(vpiAutomatic, item)) break;
+	    if (vcd_filter_skip_var(item, vpi_get_str(vpiFullName, item)))
+		  break;
 
 	    name = vpi_get_str(vpiName, item);
 	    nexus_id = vpi_get(_vpiNexusId, item);
@@ -677,6 +679,8 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 	  case vpiRealVar:
 
             if (skip || vpi_get(vpiAutomatic, item)) break;
+	    if (vcd_filter_skip_var(item, vpi_get_str(vpiFullName, item)))
+		  break;
 
 	    name = vpi_get_str(vpiName, item);
 	    { char*tmp = create_full_name(name);
@@ -710,7 +714,8 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 	  case vpiNamedBegin:
 	  case vpiNamedFork:
 
-	    if (depth > 0) {
+	    if (depth > 0 &&
+	        !vcd_filter_skip_scope(vpi_get_str(vpiFullName, item))) {
 		  const char* fullname = vpi_get_str(vpiFullName, item);
 		  /* list of types to iterate upon */
 		  static int types[] = {
@@ -876,6 +881,9 @@ static void* lxt2_thread(void*arg)
 		  lxt2_wr_emit_value_bit_string(dump_file, cell->sym_.lxt2,
 						0, cell->op_.val_char);
 		  break;
+		case WT_EMIT_VECTOR:
+		    /* Not used by this dumper. */
+		  break;
 		case WT_TERMINATE:
 		  run_flag = 0;
 		  break;
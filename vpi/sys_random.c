@@ -520,11 +520,18 @@ PLI_INT32 sys_random_compiletf(ICARUS_VPI_CONST PLI_BYTE8 *name)
       return 0;
 }
 
+/*
+ * The internal seeds of $random and $urandom. These are saved with a
+ * checkpoint of the simulation so that a restarted simulation gets
+ * the same numbers.
+ */
+static long random_seed = 0;
+static long urandom_seed = 0;
+
 static PLI_INT32 sys_random_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
 {
       vpiHandle callh, argv, seed = 0;
       s_vpi_value val;
-      static long i_seed = 0;
       long a_seed;
 
       (void)name; /* Parameter is not used. */
@@ -539,7 +546,7 @@ static PLI_INT32 sys_random_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
             vpi_free_object(argv);
             vpi_get_value(seed, &val);
             a_seed = val.value.integer;
-      } else a_seed = i_seed;
+      } else a_seed = random_seed;
 
       /* Calculate and return the result. */
       val.value.integer = rtl_dist_uniform(&a_seed, INT_MIN, INT_MAX);
@@ -549,7 +556,7 @@ static PLI_INT32 sys_random_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
       if (seed) {
             val.value.integer = a_seed;
             vpi_put_value(seed, &val, 0, vpiNoDelay);
-      } else i_seed = a_seed;
+      } else random_seed = a_seed;
 
       return 0;
 }
@@ -590,18 +597,37 @@ static PLI_INT32 sys_urandom_range_compiletf(ICARUS_VPI_CONST PLI_BYTE8 *name)
 /* From SystemVerilog. */
 static unsigned long urandom(long *seed, unsigned long max, unsigned long min)
 {
-      static long i_seed = 0;
       unsigned long result;
       long max_i, min_i;
 
       max_i =  max + INT_MIN;
       min_i =  min + INT_MIN;
-      if (seed != 0) i_seed = *seed;
-      result = rtl_dist_uniform(&i_seed, min_i, max_i) - INT_MIN;
-      if (seed != 0) *seed = i_seed;
+      if (seed != 0) urandom_seed = *seed;
+      result = rtl_dist_uniform(&urandom_seed, min_i, max_i) - INT_MIN;
+      if (seed != 0) *seed = urandom_seed;
       return result;
 }
 
+static PLI_INT32 sys_random_save_cb(p_cb_data cb_data)
+{
+      PLI_INT32 id = vpi_get(vpiSaveRestartID, NULL);
+      (void)cb_data; /* Parameter is not used. */
+
+      vpi_put_data(id, (PLI_BYTE8*)&random_seed, sizeof random_seed);
+      vpi_put_data(id, (PLI_BYTE8*)&urandom_seed, sizeof urandom_seed);
+      return 0;
+}
+
+static PLI_INT32 sys_random_restart_cb(p_cb_data cb_data)
+{
+      PLI_INT32 id = vpi_get(vpiSaveRestartID, NULL);
+      (void)cb_data; /* Parameter is not used. */
+
+      vpi_get_data(id, (PLI_BYTE8*)&random_seed, sizeof random_seed);
+      vpi_get_data(id, (PLI_BYTE8*)&urandom_seed, sizeof urandom_seed);
+      return 0;
+}
+
 /* From SystemVerilog. */
 static PLI_INT32 sys_urandom_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
 {
@@ -933,6 +959,7 @@ static PLI_INT32 sys_rand_func_sizetf(PLI_BYTE8 *name)
 void sys_random_register(void)
 {
       s_vpi_systf_data tf_data;
+      s_cb_data cb_data;
       vpiHandle res;
 
       tf_data.type = vpiSysFunc;
@@ -1036,4 +1063,16 @@ void sys_random_register(void)
       tf_data.user_data = "$dist_erlang";
       res = vpi_register_systf(&tf_data);
       vpip_make_systf_system_defined(res);
+
+      cb_data.reason = cbStartOfSave;
+      cb_data.obj = 0;
+      cb_data.time = 0;
+      cb_data.value = 0;
+      cb_data.cb_rtn = sys_random_save_cb;
+      cb_data.user_data = "system";
+      vpi_register_cb(&cb_data);
+
+      cb_data.reason = cbStartOfRestart;
+      cb_data.cb_rtn = sys_random_restart_cb;
+      vpi_register_cb(&cb_data);
 }
@@ -43,6 +43,8 @@ struct vcd_info {
       const char *ident;
       struct vcd_info *next;
       struct vcd_info *dmp_next;
+      PLI_INT32 type;
+      unsigned size;
       int scheduled;
 };
 
@@ -55,6 +57,18 @@ static long dump_limit = 0;
 static int dump_is_full = 0;
 static int finish_status = 0;
 
+/*
+ * Unless -vcd-sync is given, the value changes are formatted and
+ * written by a work thread. The simulation thread only copies the
+ * raw values into the work queue. Anything else that writes to the
+ * dump_file (or reads vcd_cur_time) from the simulation thread must
+ * first call vcd_work_sync() so that the work thread is idle. The
+ * work thread sets dump_limit_hit when the file passes the limit.
+ */
+static int dump_sync = 0;
+static int dump_thread = 0;
+static volatile int dump_limit_hit = 0;
+
 
 static const char*units_names[] = {
       "s",
@@ -124,6 +138,25 @@ static void show_this_item(struct vcd_info*info)
       }
 }
 
+/* Send the value to the work thread. */
+static void queue_this_item(struct vcd_info*info)
+{
+      s_vpi_value value;
+
+      if (info->type == vpiRealVar) {
+	    value.format = vpiRealVal;
+	    vpi_get_value(info->item, &value);
+	    vcd_work_emit_real(info, value.value.real);
+      } else if (info->type == vpiNamedEvent) {
+	    static const s_vpi_vecval one = { 1, 0 };
+	    vcd_work_emit_vector(info, 1, &one);
+      } else {
+	    value.format = vpiVectorVal;
+	    vpi_get_value(info->item, &value);
+	    vcd_work_emit_vector(info, info->size, value.value.vector);
+      }
+}
+
 /* Dump values for a $dumpoff. */
 static void show_this_item_x(struct vcd_info*info)
 {
@@ -182,6 +215,18 @@ static PLI_INT32 variable_cb_2(p_cb_data cause)
       struct vcd_info* info = vcd_dmp_list;
       PLI_UINT64 now = timerec_to_time64(cause->time);
 
+      if (dump_thread) {
+	      /* The work thread writes the time stamp. */
+	    vcd_work_set_time(now);
+	    do {
+		  queue_this_item(info);
+		  info->scheduled = 0;
+	    } while ((info = info->dmp_next) != 0);
+
+	    vcd_dmp_list = 0;
+	    return 0;
+      }
+
       if (now != vcd_cur_time) {
 	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", now);
 	    vcd_cur_time = now;
@@ -197,6 +242,17 @@ static PLI_INT32 variable_cb_2(p_cb_data cause)
       return 0;
 }
 
+static int dump_limit_exceeded(void)
+{
+      if (dump_thread) {
+	    if (! dump_limit_hit) return 0;
+	    vcd_work_sync();
+	    return 1;
+      }
+
+      return ftell(dump_file) > dump_limit;
+}
+
 static PLI_INT32 variable_cb_1(p_cb_data cause)
 {
       struct t_cb_data cb;
@@ -207,7 +263,7 @@ static PLI_INT32 variable_cb_1(p_cb_data cause)
       if (dump_header_pending()) return 0;
       if (info->scheduled) return 0;
 
-      if ((dump_limit > 0) && (ftell(dump_file) > dump_limit)) {
+      if ((dump_limit > 0) && dump_limit_exceeded()) {
             dump_is_full = 1;
             vpi_printf("WARNING: Dump file limit (%ld bytes) "
                                "exceeded.\n", dump_limit);
@@ -237,6 +293,8 @@ static PLI_INT32 dumpvars_cb(p_cb_data cause)
 
       dumpvars_status = 2;
 
+      vcd_work_sync();
+
       dumpvars_time = timerec_to_time64(cause->time);
       vcd_cur_time = dumpvars_time;
 
@@ -260,6 +318,11 @@ static PLI_INT32 finish_cb(p_cb_data cause)
 
       finish_status = 1;
 
+      if (dump_thread) {
+	    vcd_work_terminate();
+	    dump_thread = 0;
+      }
+
       dumpvars_time = timerec_to_time64(cause->time);
 
       if (!dump_is_off && !dump_is_full && dumpvars_time != vcd_cur_time) {
@@ -327,6 +390,8 @@ static PLI_INT32 sys_dumpoff_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       if (dump_file == 0) return 0;
       if (dump_header_pending()) return 0;
 
+      vcd_work_sync();
+
       now.type = vpiSimTime;
       vpi_get_time(0, &now);
       now64 = timerec_to_time64(&now);
@@ -357,6 +422,8 @@ static PLI_INT32 sys_dumpon_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       if (dump_file == 0) return 0;
       if (dump_header_pending()) return 0;
 
+      vcd_work_sync();
+
       now.type = vpiSimTime;
       vpi_get_time(0, &now);
       now64 = timerec_to_time64(&now);
@@ -384,6 +451,8 @@ static PLI_INT32 sys_dumpall_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       if (dump_file == 0) return 0;
       if (dump_header_pending()) return 0;
 
+      vcd_work_sync();
+
       now.type = vpiSimTime;
       vpi_get_time(0, &now);
       now64 = timerec_to_time64(&now);
@@ -400,6 +469,67 @@ static PLI_INT32 sys_dumpall_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       return 0;
 }
 
+/*
+ * This is the work thread that formats and writes the value changes
+ * that the variable_cb_2 callback queues.
+ */
+static void* vcd_thread(void*arg)
+{
+      char*buf = 0;
+      unsigned buf_size = 0;
+      int run_flag = 1;
+
+      (void)arg; /* Parameter is not used. */
+
+      while (run_flag) {
+	    struct vcd_work_item_s*cell = vcd_work_thread_peek();
+	    struct vcd_info*info = (struct vcd_info*)cell->sym_.info;
+
+	    switch (cell->type) {
+		case WT_EMIT_DOUBLE:
+		case WT_EMIT_VECTOR:
+		  if (cell->time != vcd_cur_time) {
+			fprintf(dump_file, "#%" PLI_UINT64_FMT "\n",
+			        (PLI_UINT64)cell->time);
+			vcd_cur_time = cell->time;
+		  }
+
+		  if (cell->type == WT_EMIT_DOUBLE) {
+			fprintf(dump_file, "r%.16g %s\n",
+			        cell->op_.val_double, info->ident);
+		  } else {
+			if (cell->wid >= buf_size) {
+			      buf_size = cell->wid + 1;
+			      buf = realloc(buf, buf_size);
+			}
+			vcd_work_vec_to_bits(buf, cell->wid,
+			                     vcd_work_item_vec(cell));
+			if (info->size == 1)
+			      fprintf(dump_file, "%s%s\n", buf, info->ident);
+			else
+			      fprintf(dump_file, "b%s %s\n",
+			              truncate_bitvec(buf), info->ident);
+		  }
+
+		  if ((dump_limit > 0) && (ftell(dump_file) > dump_limit))
+			dump_limit_hit = 1;
+		  break;
+
+		case WT_TERMINATE:
+		  run_flag = 0;
+		  break;
+
+		default:
+		  break;
+	    }
+
+	    vcd_work_thread_pop();
+      }
+
+      free(buf);
+      return 0;
+}
+
 static void open_dumpfile(vpiHandle callh)
 {
       if (dump_path == 0) dump_path = strdup("dump.vcd");
@@ -444,6 +574,11 @@ static void open_dumpfile(vpiHandle callh)
 	    fprintf(dump_file, "$timescale\n");
 	    fprintf(dump_file, "\t%u%s\n", scale, units_names[udx]);
 	    fprintf(dump_file, "$end\n");
+
+	    if (!dump_sync) {
+		  vcd_work_start(vcd_thread, 0);
+		  dump_thread = 1;
+	    }
       }
 }
 
@@ -485,7 +620,10 @@ static PLI_INT32 sys_dumpfile_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 static PLI_INT32 sys_dumpflush_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 {
       (void)name; /* Parameter is not used. */
-      if (dump_file) fflush(dump_file);
+      if (dump_file) {
+	    vcd_work_sync();
+	    fflush(dump_file);
+      }
 
       return 0;
 }
@@ -501,6 +639,7 @@ static PLI_INT32 sys_dumplimit_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
       /* Get the value and set the dump limit. */
       val.format = vpiIntVal;
       vpi_get_value(vpi_scan(argv), &val);
+      vcd_work_sync();
       dump_limit = val.value.integer;
 
       vpi_free_object(argv);
@@ -618,6 +757,9 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 	       * scope then just return. */
             if (skip || vpi_get(vpiAutomatic, item)) return;
 
+	      /* Leave out the signals that +dumpfilter rejects. */
+	    if (vcd_filter_skip_var(item, fullname)) return;
+
 	      /* Skip this signal if it has already been included.
 	       * This can only happen for implicitly given signals. */
 	    if (vcd_names_search(&vcd_var, fullname)) return;
@@ -632,6 +774,12 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 	    ident = 0;
 	    if (nexus_id) ident = find_nexus_ident(nexus_id);
 
+	      /* Named events do not have a size, but other tools use
+	       * a size of 1 and some viewers do not accept a width of
+	       * zero so we will also use a width of one for events. */
+	    if (item_type == vpiNamedEvent) size = 1;
+	    else size = vpi_get(vpiSize, item);
+
 	    if (!ident) {
 		  ident = strdup(vcdid);
 		  gen_new_vcd_id();
@@ -644,6 +792,8 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 		  info->time.type = vpiSimTime;
 		  info->item  = item;
 		  info->ident = ident;
+		  info->type  = item_type;
+		  info->size  = size;
 		  info->scheduled = 0;
 
 		  cb.time      = &info->time;
@@ -660,12 +810,6 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 		  info->cb    = vpi_register_cb(&cb);
 	    }
 
-	      /* Named events do not have a size, but other tools use
-	       * a size of 1 and some viewers do not accept a width of
-	       * zero so we will also use a width of one for events. */
-	    if (item_type == vpiNamedEvent) size = 1;
-	    else size = vpi_get(vpiSize, item);
-
 	    fprintf(dump_file, "$var %s %u %s %s%s",
 		    type, size, ident, prefix, name);
 
@@ -686,7 +830,7 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 	  case vpiNamedBegin:
 	  case vpiNamedFork:
 
-	    if (depth > 0) {
+	    if (depth > 0 && !vcd_filter_skip_scope(fullname)) {
 		/* list of types to iterate upon */
 		  static int types[] = {
 			/* Value */
@@ -871,9 +1015,20 @@ static PLI_INT32 sys_dumpvars_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 
 void sys_vcd_register(void)
 {
+      int idx;
+      struct t_vpi_vlog_info vlog_info;
       s_vpi_systf_data tf_data;
       vpiHandle res;
 
+	/* Scan the extended arguments, looking for the flag that
+	   keeps the writing on the simulation thread. */
+      vpi_get_vlog_info(&vlog_info);
+
+      for (idx = 0 ;  idx < vlog_info.argc ;  idx += 1) {
+	    if (strcmp(vlog_info.argv[idx],"-vcd-sync") == 0)
+		  dump_sync = 1;
+      }
+
       /* All the compiletf routines are located in vcd_priv.c. */
 
       tf_data.type      = vpiSysTask;
@@ -217,3 +217,274 @@ PLI_INT32 sys_dumpvars_compiletf(ICARUS_VPI_CONST PLI_BYTE8 *name)
 
       return 0;
 }
+
+/*
+ * The +dumpfilter=<arg> argument narrows down what $dumpvars picks up
+ * before any callbacks are installed, so filtered signals cost nothing
+ * while the simulation runs. The argument is either the name of a
+ * control file with one directive per line, or, if it contains an '=',
+ * a list of directives separated by ';'. A directive is key=value with
+ * a ',' separated list of values:
+ *
+ *    include=<glob>,...   only dump signals below a matching scope
+ *                         or matching themselves
+ *    exclude=<glob>,...   do not dump matching scopes or signals
+ *    depth=<n>            do not dump below the n'th scope level
+ *    maxwidth=<n>         do not dump vectors wider than n bits
+ *    kind=<kind>,...      only dump net, reg, real, event and/or
+ *                         memory (array word) signals
+ *
+ * The globs are matched against the full hierarchical name. A '*'
+ * matches any run of characters (including '.') and a '?' matches
+ * any single character. Blank lines and '#' comments are ignored in
+ * a control file.
+ */
+
+#define FILTER_KIND_NET    0x01
+#define FILTER_KIND_REG    0x02
+#define FILTER_KIND_REAL   0x04
+#define FILTER_KIND_EVENT  0x08
+#define FILTER_KIND_MEMORY 0x10
+#define FILTER_KIND_ALL    0x1f
+
+static struct {
+      int loaded;
+      int active;
+      char**include;
+      unsigned ninclude;
+      char**exclude;
+      unsigned nexclude;
+      unsigned depth;
+      unsigned maxwidth;
+      unsigned kinds;
+} dump_filter = { 0, 0, 0, 0, 0, 0, 0, 0, FILTER_KIND_ALL };
+
+/*
+ * Match the glob against the string. If partial is true, then it is
+ * enough for the string to be a prefix of something the glob matches.
+ */
+static int filter_glob(const char*pat, const char*str, int partial)
+{
+      while (*pat) {
+	    if (*pat == '*') {
+		  pat += 1;
+		  do {
+			if (filter_glob(pat, str, partial)) return 1;
+		  } while (*str++);
+		  return 0;
+	    }
+	    if (*str == 0) return partial;
+	    if (*pat != '?' && *pat != *str) return 0;
+	    pat += 1;
+	    str += 1;
+      }
+      return *str == 0;
+}
+
+/*
+ * Match the glob against the name and against all the scope names
+ * that lead to it.
+ */
+static int filter_glob_path(const char*pat, const char*name)
+{
+      char*tmp = strdup(name);
+      char*cp = tmp + strlen(tmp);
+      int rc = 0;
+
+      for (;;) {
+	    if (filter_glob(pat, tmp, 0)) {
+		  rc = 1;
+		  break;
+	    }
+	    while (cp > tmp && *cp != '.') cp -= 1;
+	    if (cp == tmp) break;
+	    *cp = 0;
+      }
+
+      free(tmp);
+      return rc;
+}
+
+/* Return the number of scope levels in a full name. */
+static unsigned filter_levels(const char*name)
+{
+      unsigned levels = 1;
+      unsigned brackets = 0;
+      for ( ; *name ; name += 1) {
+	    if (*name == '[') brackets += 1;
+	    else if (*name == ']' && brackets > 0) brackets -= 1;
+	    else if (*name == '.' && brackets == 0) levels += 1;
+      }
+      return levels;
+}
+
+static void filter_add_globs(char***list, unsigned*count, char*values)
+{
+      char*cp;
+      for (cp = strtok(values, ", \t"); cp; cp = strtok(0, ", \t")) {
+	    *list = realloc(*list, (*count + 1) * sizeof(char*));
+	    (*list)[*count] = strdup(cp);
+	    *count += 1;
+      }
+}
+
+static void filter_directive(char*text)
+{
+      char*key, *value, *end;
+
+	/* Trim any comment and the surrounding white space. */
+      if ((end = strchr(text, '#'))) *end = 0;
+      while (isspace((int)*text)) text += 1;
+      end = text + strlen(text);
+      while (end > text && isspace((int)end[-1])) end -= 1;
+      *end = 0;
+      if (*text == 0) return;
+
+      key = text;
+      value = strchr(text, '=');
+      if (value == 0) {
+	    vpi_printf("WARNING: +dumpfilter: missing '=' in \"%s\".\n", text);
+	    return;
+      }
+      *value++ = 0;
+
+      if (strcmp(key, "include") == 0) {
+	    filter_add_globs(&dump_filter.include, &dump_filter.ninclude, value);
+
+      } else if (strcmp(key, "exclude") == 0) {
+	    filter_add_globs(&dump_filter.exclude, &dump_filter.nexclude, value);
+
+      } else if (strcmp(key, "depth") == 0) {
+	    dump_filter.depth = strtoul(value, 0, 10);
+
+      } else if (strcmp(key, "maxwidth") == 0) {
+	    dump_filter.maxwidth = strtoul(value, 0, 10);
+
+      } else if (strcmp(key, "kind") == 0) {
+	    char*cp;
+	    dump_filter.kinds = 0;
+	    for (cp = strtok(value, ", \t"); cp; cp = strtok(0, ", \t")) {
+		  if (strcmp(cp, "net") == 0) dump_filter.kinds |= FILTER_KIND_NET;
+		  else if (strcmp(cp, "reg") == 0) dump_filter.kinds |= FILTER_KIND_REG;
+		  else if (strcmp(cp, "real") == 0) dump_filter.kinds |= FILTER_KIND_REAL;
+		  else if (strcmp(cp, "event") == 0) dump_filter.kinds |= FILTER_KIND_EVENT;
+		  else if (strcmp(cp, "memory") == 0) dump_filter.kinds |= FILTER_KIND_MEMORY;
+		  else vpi_printf("WARNING: +dumpfilter: unknown kind \"%s\".\n", cp);
+	    }
+
+      } else {
+	    vpi_printf("WARNING: +dumpfilter: unknown directive \"%s\".\n", key);
+	    return;
+      }
+
+      dump_filter.active = 1;
+}
+
+static void filter_load(void)
+{
+      struct t_vpi_vlog_info vlog_info;
+      int idx;
+
+      dump_filter.loaded = 1;
+      vpi_get_vlog_info(&vlog_info);
+
+      for (idx = 0 ;  idx < vlog_info.argc ;  idx += 1) {
+	    const char*arg = vlog_info.argv[idx];
+	    char*text, *cp;
+
+	    if (strncmp(arg, "+dumpfilter=", 12) != 0) continue;
+	    arg += 12;
+
+	    if (strchr(arg, '=')) {
+		  char*next;
+		  text = strdup(arg);
+		  for (cp = text ; cp ; cp = next) {
+			next = strchr(cp, ';');
+			if (next) *next++ = 0;
+			filter_directive(cp);
+		  }
+		  free(text);
+
+	    } else {
+		  char line[4096];
+		  FILE*fd = fopen(arg, "r");
+		  if (fd == 0) {
+			vpi_printf("ERROR: +dumpfilter: cannot open control "
+			           "file %s.\n", arg);
+			continue;
+		  }
+		  while (fgets(line, sizeof line, fd)) filter_directive(line);
+		  fclose(fd);
+	    }
+      }
+}
+
+int vcd_filter_skip_scope(const char*fullname)
+{
+      unsigned idx;
+      int keep;
+
+      if (! dump_filter.loaded) filter_load();
+      if (! dump_filter.active) return 0;
+
+      if (dump_filter.depth && filter_levels(fullname) > dump_filter.depth)
+	    return 1;
+
+      for (idx = 0 ; idx < dump_filter.nexclude ; idx += 1) {
+	    if (filter_glob(dump_filter.exclude[idx], fullname, 0)) return 1;
+      }
+
+	/* The scope is needed if an include matches it or its parents,
+	 * or could match something inside it. */
+      if (dump_filter.ninclude == 0) return 0;
+      keep = 0;
+      for (idx = 0 ; idx < dump_filter.ninclude && !keep ; idx += 1) {
+	    const char*pat = dump_filter.include[idx];
+	    if (filter_glob_path(pat, fullname)) {
+		  keep = 1;
+	    } else {
+		  char*tmp = malloc(strlen(fullname) + 2);
+		  sprintf(tmp, "%s.", fullname);
+		  keep = filter_glob(pat, tmp, 1);
+		  free(tmp);
+	    }
+      }
+
+      return !keep;
+}
+
+int vcd_filter_skip_var(vpiHandle item, const char*fullname)
+{
+      unsigned kind, idx;
+
+      if (! dump_filter.loaded) filter_load();
+      if (! dump_filter.active) return 0;
+
+      switch (vpi_get(vpiType, item)) {
+	  case vpiNet:        kind = FILTER_KIND_NET; break;
+	  case vpiRealVar:    kind = FILTER_KIND_REAL; break;
+	  case vpiNamedEvent: kind = FILTER_KIND_EVENT; break;
+	  case vpiMemoryWord: kind = FILTER_KIND_MEMORY; break;
+	  default:            kind = FILTER_KIND_REG; break;
+      }
+      if ((dump_filter.kinds & kind) == 0) return 1;
+
+      if (dump_filter.maxwidth && (kind & (FILTER_KIND_NET|FILTER_KIND_REG|
+                                           FILTER_KIND_MEMORY))
+          && (unsigned)vpi_get(vpiSize, item) > dump_filter.maxwidth)
+	    return 1;
+
+      if (dump_filter.depth && filter_levels(fullname) > dump_filter.depth + 1)
+	    return 1;
+
+      for (idx = 0 ; idx < dump_filter.nexclude ; idx += 1) {
+	    if (filter_glob_path(dump_filter.exclude[idx], fullname)) return 1;
+      }
+
+      if (dump_filter.ninclude == 0) return 0;
+      for (idx = 0 ; idx < dump_filter.ninclude ; idx += 1) {
+	    if (filter_glob_path(dump_filter.include[idx], fullname)) return 0;
+      }
+
+      return 1;
+}
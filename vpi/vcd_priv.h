@@ -62,6 +62,15 @@ EXTERN void vcd_scope_names_add(const char*name);
 EXTERN int  vcd_scope_names_test(const char*name);
 EXTERN void vcd_scope_names_delete(void);
 
+/*
+ * The dump filter given with +dumpfilter= (see vcd_priv.c). These
+ * return true if $dumpvars must leave out the scope (and everything
+ * in it) or the signal. The full name is passed in because the result
+ * of vpi_get_str() is only valid until the next call.
+ */
+EXTERN int vcd_filter_skip_scope(const char*fullname);
+EXTERN int vcd_filter_skip_var(vpiHandle item, const char*fullname);
+
 /*
  * Implement a work queue that can be used to send commands to a
  * dumper thread.
@@ -71,6 +80,7 @@ typedef enum vcd_work_item_type_e {
       WT_NONE,
       WT_EMIT_BITS,
       WT_EMIT_DOUBLE,
+      WT_EMIT_VECTOR,
       WT_DUMPON,
       WT_DUMPOFF,
       WT_FLUSH,
@@ -79,19 +89,38 @@ typedef enum vcd_work_item_type_e {
 
 struct lxt2_wr_symbol;
 
+/*
+ * Vectors up to this many s_vpi_vecval words are carried in the work
+ * item itself. Wider vectors are copied to the heap.
+ */
+#define VCD_WORK_VEC_INLINE 2
+
 struct vcd_work_item_s {
       vcd_work_item_type_t type;
       uint64_t time;
       union {
 	    struct lxt2_wr_symbol*lxt2;
+	    void*info;
       } sym_;
 
       union {
 	    double val_double;
 	    char*val_char;
+	    s_vpi_vecval*val_vec;
+	    s_vpi_vecval val_vec_inline[VCD_WORK_VEC_INLINE];
       } op_;
+	/* The width of a WT_EMIT_VECTOR value. */
+      unsigned wid;
 };
 
+/*
+ * Get the words of a WT_EMIT_VECTOR work item.
+ */
+#define VCD_WORK_VEC_WORDS(wid) (((wid) + 31) / 32)
+#define vcd_work_item_vec(cell) \
+      (VCD_WORK_VEC_WORDS((cell)->wid) > VCD_WORK_VEC_INLINE \
+	     ? (cell)->op_.val_vec : (cell)->op_.val_vec_inline)
+
 /*
  * The thread_peek and thread_pop functions work as pairs. The work
  * thread processing work items uses vcd_work_thread_peek to look at
@@ -126,6 +155,24 @@ EXTERN void vcd_work_dumpoff(void);
 EXTERN void vcd_work_emit_double(struct lxt2_wr_symbol*sym, double val);
 EXTERN void vcd_work_emit_bits(struct lxt2_wr_symbol*sym, const char*bits);
 
+/*
+ * These are for dumpers that format the values in the work thread.
+ * The info is the dumper's own handle for the item. The vector value
+ * is copied as is, so the caller can pass the vpiVectorVal result
+ * of vpi_get_value directly.
+ */
+EXTERN void vcd_work_emit_real(void*info, double val);
+EXTERN void vcd_work_emit_vector(void*info, unsigned wid,
+				 const s_vpi_vecval*vec);
+
+/*
+ * Convert a vector value to a string of '0', '1', 'x' and 'z'
+ * characters, most significant bit first. The buf must have room
+ * for wid+1 characters.
+ */
+EXTERN void vcd_work_vec_to_bits(char*buf, unsigned wid,
+				 const s_vpi_vecval*vec);
+
 /* The compiletf routines are common for the VCD, LXT and LXT2 dumpers. */
 EXTERN PLI_INT32 sys_dumpvars_compiletf(ICARUS_VPI_CONST PLI_BYTE8 *name);
 
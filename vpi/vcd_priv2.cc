@@ -89,71 +89,121 @@ static const unsigned WORK_QUEUE_SIZE = 128*1024;
 static const unsigned WORK_QUEUE_BATCH_MIN = 4*1024;
 static const unsigned WORK_QUEUE_BATCH_MAX = 32*1024;
 
+/*
+ * The work queue is a ring with one producer (the simulation thread)
+ * and one consumer (the work thread). The indices count up without
+ * wrapping to the ring size, so the fill is always tail-head. (The
+ * ring size is a power of 2, so the item of an index is still right
+ * when the index wraps past the top of an unsigned.) Only
+ * the producer writes work_queue_tail, and only the consumer writes
+ * work_queue_head. An index is stored with release order after the
+ * items it covers are written (or are done with), and is loaded with
+ * acquire order by the other thread, so neither side needs a lock to
+ * pass items. The mutex and the conditions are only used by a thread
+ * that must sleep until the other makes progress. The sleeper sets
+ * its waiting flag before it tests the indices again, and the other
+ * thread tests the flag after it moves its index, so one of them
+ * always sees the other.
+ */
 static struct vcd_work_item_s work_queue[WORK_QUEUE_SIZE];
-static volatile unsigned work_queue_next = 0;
-static volatile unsigned work_queue_fill = 0;
+static unsigned work_queue_head = 0;
+static unsigned work_queue_tail = 0;
 
 static pthread_mutex_t work_queue_mutex = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t  work_queue_is_empty_sig = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  work_queue_progress_sig = PTHREAD_COND_INITIALIZER;
 static pthread_cond_t  work_queue_notempty_sig = PTHREAD_COND_INITIALIZER;
-static pthread_cond_t  work_queue_minfree_sig = PTHREAD_COND_INITIALIZER;
+static bool work_producer_waiting = false;
+static unsigned work_producer_max_fill = 0;
+static bool work_consumer_waiting = false;
 
+/*
+ * The fill of the queue as the producer sees it.
+ */
+static inline unsigned work_queue_fill(void)
+{
+      return work_queue_tail - __atomic_load_n(&work_queue_head, __ATOMIC_ACQUIRE);
+}
 
 extern "C" struct vcd_work_item_s* vcd_work_thread_peek(void)
 {
 	// There must always only be 1 vcd work thread, and only the
-	// work thread decreases the fill, so if the work_queue_fill
-	// is non-zero, I can reliably assume that there is at least
-	// one item that I can peek at. I only need to lock if I must
-	// wait for the work_queue_fill to become non-zero.
-      if (work_queue_fill == 0) {
+	// work thread moves the head, so if the tail is past the
+	// head, I can reliably assume that there is at least one item
+	// that I can peek at. I only need to lock if I must wait for
+	// the producer to release more items.
+      unsigned head = work_queue_head;
+      if (head == __atomic_load_n(&work_queue_tail, __ATOMIC_ACQUIRE)) {
 	    pthread_mutex_lock(&work_queue_mutex);
-	    while (work_queue_fill == 0)
+	    __atomic_store_n(&work_consumer_waiting, true, __ATOMIC_SEQ_CST);
+	    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+	    while (head == __atomic_load_n(&work_queue_tail, __ATOMIC_ACQUIRE))
 		  pthread_cond_wait(&work_queue_notempty_sig, &work_queue_mutex);
+	    __atomic_store_n(&work_consumer_waiting, false, __ATOMIC_RELAXED);
 	    pthread_mutex_unlock(&work_queue_mutex);
       }
 
-      return work_queue + work_queue_next;
+      return work_queue + head % WORK_QUEUE_SIZE;
 }
 
 extern "C" void vcd_work_thread_pop(void)
 {
-      pthread_mutex_lock(&work_queue_mutex);
+      unsigned head = work_queue_head;
 
-      unsigned use_fill = work_queue_fill - 1;
-      work_queue_fill = use_fill;
-
-      unsigned use_next = work_queue_next;
-
-      struct vcd_work_item_s*cell = work_queue + use_next;
+      struct vcd_work_item_s*cell = work_queue + head % WORK_QUEUE_SIZE;
       if (cell->type == WT_EMIT_BITS) {
 	    free(cell->op_.val_char);
+      } else if (cell->type == WT_EMIT_VECTOR
+		 && VCD_WORK_VEC_WORDS(cell->wid) > VCD_WORK_VEC_INLINE) {
+	    free(cell->op_.val_vec);
       }
 
-      use_next += 1;
-      if (use_next >= WORK_QUEUE_SIZE)
-	    use_next = 0;
-      work_queue_next = use_next;
+      head += 1;
+      __atomic_store_n(&work_queue_head, head, __ATOMIC_RELEASE);
+
+      __atomic_thread_fence(__ATOMIC_SEQ_CST);
+      if (! __atomic_load_n(&work_producer_waiting, __ATOMIC_ACQUIRE))
+	    return;
+
+	// Only wake the producer when the fill it waits for is
+	// reached. The tail may be older than the one the producer
+	// released last, but that can only make the fill look
+	// smaller, so the worst case is a wake up that is too early.
+      unsigned use_fill = __atomic_load_n(&work_queue_tail, __ATOMIC_RELAXED) - head;
+      if (use_fill <= __atomic_load_n(&work_producer_max_fill, __ATOMIC_RELAXED)) {
+	    pthread_mutex_lock(&work_queue_mutex);
+	    pthread_cond_signal(&work_queue_progress_sig);
+	    pthread_mutex_unlock(&work_queue_mutex);
+      }
+}
 
-      if (use_fill == WORK_QUEUE_SIZE-WORK_QUEUE_BATCH_MIN)
-	    pthread_cond_signal(&work_queue_minfree_sig);
-      else if (use_fill == 0)
-	    pthread_cond_signal(&work_queue_is_empty_sig);
+/*
+ * Wait until the consumer has taken enough items off the queue that
+ * the fill is no more than max_fill.
+ */
+static void wait_for_consumer(unsigned max_fill)
+{
+      if (work_queue_fill() <= max_fill)
+	    return;
 
+      pthread_mutex_lock(&work_queue_mutex);
+      __atomic_store_n(&work_producer_max_fill, max_fill, __ATOMIC_RELAXED);
+      __atomic_store_n(&work_producer_waiting, true, __ATOMIC_SEQ_CST);
+      __atomic_thread_fence(__ATOMIC_SEQ_CST);
+      while (work_queue_fill() > max_fill)
+	    pthread_cond_wait(&work_queue_progress_sig, &work_queue_mutex);
+      __atomic_store_n(&work_producer_waiting, false, __ATOMIC_RELAXED);
       pthread_mutex_unlock(&work_queue_mutex);
 }
 
 /*
  * Work queue items are created in batches to reduce thread
  * bouncing. When the producer gets a free work item, it actually
- * locks the queue in order to produce a batch. The queue stays locked
- * until the batch is complete. Then the releases the whole lot to the
- * consumer.
+ * claims the free space for a batch. The batch is only released to
+ * the consumer, by moving the tail, when the batch is complete.
  */
 static uint64_t work_queue_next_time = 0;
 static unsigned current_batch_cnt = 0;
 static unsigned current_batch_alloc = 0;
-static unsigned current_batch_base = 0;
 
 extern "C" void vcd_work_start( void* (*fun) (void*), void*arg )
 {
@@ -163,17 +213,9 @@ extern "C" void vcd_work_start( void* (*fun) (void*), void*arg )
 static struct vcd_work_item_s* grab_item(void)
 {
       if (current_batch_alloc == 0) {
-	     pthread_mutex_lock(&work_queue_mutex);
-	     while ((WORK_QUEUE_SIZE-work_queue_fill) < WORK_QUEUE_BATCH_MIN)
-		  pthread_cond_wait(&work_queue_minfree_sig, &work_queue_mutex);
-
-	     current_batch_base = work_queue_next + work_queue_fill;
-	     current_batch_alloc = WORK_QUEUE_SIZE - work_queue_fill;
+	     wait_for_consumer(WORK_QUEUE_SIZE-WORK_QUEUE_BATCH_MIN);
 
-	     pthread_mutex_unlock(&work_queue_mutex);
-
-	     if (current_batch_base >= WORK_QUEUE_SIZE)
-		   current_batch_base -= WORK_QUEUE_SIZE;
+	     current_batch_alloc = WORK_QUEUE_SIZE - work_queue_fill();
 	     if (current_batch_alloc > WORK_QUEUE_BATCH_MAX)
 		   current_batch_alloc = WORK_QUEUE_BATCH_MAX;
 	     current_batch_cnt = 0;
@@ -181,9 +223,7 @@ static struct vcd_work_item_s* grab_item(void)
 
       assert(current_batch_cnt < current_batch_alloc);
 
-      unsigned cur = current_batch_base + current_batch_cnt;
-      if (cur >= WORK_QUEUE_SIZE)
-	    cur -= WORK_QUEUE_SIZE;
+      unsigned cur = (work_queue_tail + current_batch_cnt) % WORK_QUEUE_SIZE;
 
 	// Write the new timestamp into the work item.
       struct vcd_work_item_s*cell = work_queue + cur;
@@ -193,21 +233,23 @@ static struct vcd_work_item_s* grab_item(void)
 
 static void end_batch(void)
 {
-      pthread_mutex_lock(&work_queue_mutex);
-
-      unsigned use_fill = work_queue_fill;
-      bool was_empty_flag = (use_fill==0) && (current_batch_cnt > 0);
-
-      use_fill += current_batch_cnt;
-      work_queue_fill = use_fill;
+      unsigned use_cnt = current_batch_cnt;
 
       current_batch_alloc = 0;
       current_batch_cnt = 0;
 
-      if (was_empty_flag)
-	    pthread_cond_signal(&work_queue_notempty_sig);
+      if (use_cnt == 0)
+	    return;
 
-      pthread_mutex_unlock(&work_queue_mutex);
+      __atomic_store_n(&work_queue_tail, work_queue_tail + use_cnt,
+		       __ATOMIC_RELEASE);
+
+      __atomic_thread_fence(__ATOMIC_SEQ_CST);
+      if (__atomic_load_n(&work_consumer_waiting, __ATOMIC_RELAXED)) {
+	    pthread_mutex_lock(&work_queue_mutex);
+	    pthread_cond_signal(&work_queue_notempty_sig);
+	    pthread_mutex_unlock(&work_queue_mutex);
+      }
 }
 
 static inline void unlock_item(bool flush_batch =false)
@@ -222,12 +264,7 @@ extern "C" void vcd_work_sync(void)
       if (current_batch_alloc > 0)
 	    end_batch();
 
-      if (work_queue_fill > 0) {
-	    pthread_mutex_lock(&work_queue_mutex);
-	    while (work_queue_fill > 0)
-		  pthread_cond_wait(&work_queue_is_empty_sig, &work_queue_mutex);
-	    pthread_mutex_unlock(&work_queue_mutex);
-      }
+      wait_for_consumer(0);
 }
 
 extern "C" void vcd_work_flush(void)
@@ -276,6 +313,50 @@ extern "C" void vcd_work_emit_bits(struct lxt2_wr_symbol*sym, const char* val)
       unlock_item();
 }
 
+extern "C" void vcd_work_emit_real(void*info, double val)
+{
+      struct vcd_work_item_s*cell = grab_item();
+      cell->type = WT_EMIT_DOUBLE;
+      cell->sym_.info = info;
+      cell->op_.val_double = val;
+      unlock_item();
+}
+
+extern "C" void vcd_work_emit_vector(void*info, unsigned wid,
+				     const s_vpi_vecval*vec)
+{
+      struct vcd_work_item_s*cell = grab_item();
+      cell->type = WT_EMIT_VECTOR;
+      cell->sym_.info = info;
+      cell->wid = wid;
+
+      unsigned words = VCD_WORK_VEC_WORDS(wid);
+      s_vpi_vecval*dst = cell->op_.val_vec_inline;
+      if (words > VCD_WORK_VEC_INLINE) {
+	    dst = (s_vpi_vecval*)malloc(words * sizeof(s_vpi_vecval));
+	    cell->op_.val_vec = dst;
+      }
+      memcpy(dst, vec, words * sizeof(s_vpi_vecval));
+
+      unlock_item();
+}
+
+extern "C" void vcd_work_vec_to_bits(char*buf, unsigned wid,
+				     const s_vpi_vecval*vec)
+{
+	/* The aval/bval pairs encode 0, 1, z and x as 00, 10, 01
+	   and 11. */
+      static const char bit_chars[4] = { '0', '1', 'z', 'x' };
+
+      for (unsigned idx = 0 ; idx < wid ; idx += 1) {
+	    const s_vpi_vecval&word = vec[idx / 32];
+	    unsigned sh = idx % 32;
+	    unsigned code = ((word.aval >> sh) & 1) | (((word.bval >> sh) & 1) << 1);
+	    buf[wid-idx-1] = bit_chars[code];
+      }
+      buf[wid] = 0;
+}
+
 extern "C" void vcd_work_terminate(void)
 {
       struct vcd_work_item_s*cell = grab_item();
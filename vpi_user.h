@@ -110,6 +110,22 @@ typedef struct t_vpi_strengthval {
       PLI_INT32 s0, s1;
 } s_vpi_strengthval, *p_vpi_strengthval;
 
+/*
+ * IVL private: This is the value for the _vpiRawVal format. The aval
+ * and bval arrays hold the bits of the value in the vpi_vecval ab
+ * encoding, size bits packed into words of word_bits bits, least
+ * significant word first. The bits past the end of the value in the
+ * last word are undefined. The caller points value.misc at one of
+ * these and the simulator fills it in. The arrays belong to the
+ * simulator, and are only valid until the next call into the VPI.
+ */
+typedef struct t_vpi_rawval {
+      PLI_INT32 size;
+      PLI_INT32 word_bits;
+      const unsigned long *aval;
+      const unsigned long *bval;
+} s_vpi_rawval, *p_vpi_rawval;
+
 /*
  * This structure holds values that are passed back and forth between
  * the simulator and the application.
@@ -250,6 +266,8 @@ typedef struct t_vpi_delay  {
 #define vpiTimeVal     11
 #define vpiObjTypeVal  12
 #define vpiSuppressVal 13
+/* IVL private format, the value is returned in a s_vpi_rawval. */
+#define _vpiRawVal     0x1000005
 
 
 /* SCALAR VALUES */
@@ -356,6 +374,8 @@ typedef struct t_vpi_delay  {
 #   define vpiTriOr        9
 #   define vpiSupply1     10
 #   define vpiSupply0     11
+#define vpiSaveRestartID       23
+#define vpiSaveRestartLocation 24
 #define vpiArray         28
 #define vpiPortIndex     29
 #define vpiEdge          36
@@ -401,6 +421,7 @@ typedef struct t_vpi_delay  {
 #  define _vpiDelaySelMaximum 3
 /* used in vvp/vpi_priv.h  0x1000003 */
 /* used in vvp/vpi_priv.h  0x1000004 */
+/* used as a value format  0x1000005 */
 
 /* DELAY MODES */
 #define vpiNoDelay            1
@@ -583,6 +604,18 @@ extern PLI_INT32 vpi_compare_objects(vpiHandle obj1, vpiHandle obj2);
 extern PLI_INT32 vpi_put_userdata(vpiHandle obj, void*data);
 extern void*vpi_get_userdata(vpiHandle obj);
 
+/*
+ * These functions save and restore data of the VPI module with a
+ * checkpoint of the simulation. vpi_put_data is called from a
+ * cbStartOfSave callback and vpi_get_data from a cbStartOfRestart
+ * or cbEndOfRestart callback. The id is the value that
+ * vpi_get(vpiSaveRestartID, NULL) returns.
+ */
+extern PLI_INT32 vpi_put_data(PLI_INT32 id, PLI_BYTE8*dataLoc,
+                              PLI_INT32 numOfBytes);
+extern PLI_INT32 vpi_get_data(PLI_INT32 id, PLI_BYTE8*dataLoc,
+                              PLI_INT32 numOfBytes);
+
 /*
  * Support for handling errors.
  */
@@ -647,6 +680,12 @@ extern void vpip_mcd_rawwrite(PLI_UINT32 mcd, const char*buf, size_t count);
 extern void vpip_count_drivers(vpiHandle ref, unsigned idx,
                                unsigned counts[4]);
 
+  /* Request a checkpoint of the simulation state to the given file.
+     The checkpoint is written at the end of the current time step.
+     If incremental is not 0, only the state that changed since the
+     last full checkpoint is written. */
+extern void vpip_checkpoint_request(const char*path, int incremental);
+
 /*
  * Stopgap fix for br916. We need to reject any attempt to pass a thread
  * variable to $strobe or $monitor. To do this, we use some private VPI
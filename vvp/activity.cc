@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "activity.h"
+# include  "profile.h"
+# include  "schedule.h"
+# include  "vpi_priv.h"
+# include  "vvp_net.h"
+# include  "statistics.h"
+# include  <string>
+# include  <map>
+# include  <vector>
+# include  <algorithm>
+# include  <typeinfo>
+# include  <climits>
+
+using namespace std;
+
+bool activity_flag = false;
+
+/* Only this many of the busiest nets and scopes are listed. */
+static const size_t ACTIVITY_TOP = 20;
+
+/*
+ * The values received by each net, indexed by the vvp_net_index of
+ * the net. A value is counted on every delivery, so this must be
+ * cheap to get at.
+ */
+static vector<uint64_t> net_counts;
+static map<__vpiScope*,unsigned long> scope_counts;
+
+/*
+ * The counts of the time step that is running, and the totals and
+ * the worst of the time steps that are done.
+ */
+static vvp_time64_t step_time = 0;
+static unsigned long step_events = 0;
+static unsigned long step_deltas = 1;
+
+static unsigned long total_steps = 0;
+static unsigned long total_events = 0;
+static unsigned long total_deltas = 0;
+static unsigned long max_events = 0;
+static vvp_time64_t max_events_time = 0;
+static unsigned long max_deltas = 0;
+static vvp_time64_t max_deltas_time = 0;
+
+void activity_recv(const vvp_net_t*net)
+{
+      unsigned long idx = vvp_net_index(net);
+      if (idx >= net_counts.size()) {
+	    if (idx == ULONG_MAX)
+		  return;
+	    net_counts.resize(count_vvp_nets);
+      }
+      net_counts[idx] += 1;
+}
+
+void activity_event(__vpiScope*scope)
+{
+      scope_counts[scope] += 1;
+}
+
+void activity_run(void)
+{
+      step_events += 1;
+}
+
+void activity_delta(void)
+{
+      step_deltas += 1;
+}
+
+static void finish_step_(void)
+{
+      if (step_events == 0)
+	    return;
+
+      total_steps += 1;
+      total_events += step_events;
+      total_deltas += step_deltas;
+      if (step_events > max_events) {
+	    max_events = step_events;
+	    max_events_time = step_time;
+      }
+      if (step_deltas > max_deltas) {
+	    max_deltas = step_deltas;
+	    max_deltas_time = step_time;
+      }
+}
+
+void activity_step(vvp_time64_t time)
+{
+      finish_step_();
+      step_time = time;
+      step_events = 0;
+      step_deltas = 1;
+}
+
+/*
+ * The nets do not know their names, so find the signals in the scope
+ * tree and name the nets after them.
+ */
+static void name_signals_(__vpiScope*scope, map<const vvp_net_t*,string>&names)
+{
+      for (size_t idx = 0 ; idx < scope->intern.size() ; idx += 1) {
+	    __vpiHandle*item = scope->intern[idx];
+	    if (__vpiScope*sub = dynamic_cast<__vpiScope*>(item)) {
+		  name_signals_(sub, names);
+		  continue;
+	    }
+
+	    __vpiSignal*sig = dynamic_cast<__vpiSignal*>(item);
+	    if (sig == 0 || sig->node == 0)
+		  continue;
+	    if (names.find(sig->node) == names.end())
+		  names[sig->node] = vpi_get_str(vpiFullName, sig);
+      }
+}
+
+static bool by_count(const pair<string,unsigned long>&a,
+		     const pair<string,unsigned long>&b)
+{
+      if (a.second != b.second)
+	    return a.second > b.second;
+      return a.first < b.first;
+}
+
+static void print_counts_(vector< pair<string,unsigned long> >&list,
+			  size_t limit)
+{
+      sort(list.begin(), list.end(), by_count);
+      size_t cnt = list.size() < limit? list.size() : limit;
+      for (size_t idx = 0 ; idx < cnt ; idx += 1)
+	    vpi_mcd_printf(1, "    %12lu %s\n", list[idx].second,
+			   list[idx].first.c_str());
+      if (cnt < list.size())
+	    vpi_mcd_printf(1, "    ... %lu more\n",
+			   (unsigned long)(list.size() - cnt));
+}
+
+void activity_report(void)
+{
+      finish_step_();
+      step_events = 0;
+
+      map<const vvp_net_t*,string> names;
+      __vpiHandle**table;
+      unsigned ntable;
+      vpip_make_root_iterator(table, ntable);
+      for (unsigned idx = 0 ; idx < ntable ; idx += 1) {
+	    if (__vpiScope*scope = dynamic_cast<__vpiScope*>(table[idx]))
+		  name_signals_(scope, names);
+      }
+
+      map<string,unsigned long> type_counts;
+      vector< pair<string,unsigned long> > nets;
+      for (unsigned long idx = 0 ; idx < net_counts.size() ; idx += 1) {
+	    unsigned long cnt = net_counts[idx];
+	    const vvp_net_t*net = vvp_net_at(idx);
+	    if (cnt == 0 || net->fun == 0)
+		  continue;
+	    string type = profile_type_name(&typeid(*net->fun));
+	    type_counts[type] += cnt;
+
+	    map<const vvp_net_t*,string>::iterator name = names.find(net);
+	    if (name != names.end())
+		  nets.push_back(make_pair(name->second, cnt));
+      }
+
+      vpi_mcd_printf(1, "Activity counts:\n");
+      vpi_mcd_printf(1, "  Values received, by functor type:\n");
+      vector< pair<string,unsigned long> > list (type_counts.begin(),
+						 type_counts.end());
+      print_counts_(list, list.size());
+
+      vpi_mcd_printf(1, "  Values received, by signal:\n");
+      print_counts_(nets, ACTIVITY_TOP);
+
+      vpi_mcd_printf(1, "  Events scheduled, by scope:\n");
+      list.clear();
+      for (map<__vpiScope*,unsigned long>::iterator cur = scope_counts.begin()
+		 ; cur != scope_counts.end() ; ++ cur) {
+	    string name = cur->first? vpi_get_str(vpiFullName, cur->first)
+				    : "<nets>";
+	    list.push_back(make_pair(name, cur->second));
+      }
+      print_counts_(list, ACTIVITY_TOP);
+
+      vpi_mcd_printf(1, "  Time steps:\n");
+      vpi_mcd_printf(1, "    %12lu time steps\n", total_steps);
+      if (total_steps == 0)
+	    return;
+      vpi_mcd_printf(1, "    %12lu events, %.1f per step, at most %lu"
+		     " (at time %" TIME_FMT_U ")\n", total_events,
+		     (double)total_events / total_steps,
+		     max_events, max_events_time);
+      vpi_mcd_printf(1, "    %12lu delta cycles, %.1f per step, at most %lu"
+		     " (at time %" TIME_FMT_U ")\n", total_deltas,
+		     (double)total_deltas / total_steps,
+		     max_deltas, max_deltas_time);
+}
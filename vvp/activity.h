@@ -0,0 +1,67 @@
+#ifndef IVL_activity_H
+#define IVL_activity_H
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "config.h"
+
+class vvp_net_t;
+class __vpiScope;
+
+/*
+ * The activity counters (vvp -a) count the values that are delivered
+ * to each net, the events that are scheduled on behalf of each scope,
+ * and the events and delta cycles of each time step. They are always
+ * compiled in, but the net and scheduler code only calls into here
+ * when the activity_flag is set, so while the counters are off they
+ * cost a single well predicted branch.
+ *
+ * The counts point at oscillating loops, glitchy nets and long delta
+ * chains, which otherwise just look like a slow simulation.
+ */
+extern bool activity_flag;
+
+/*
+ * A value (of any kind) was delivered to the functor of the net.
+ */
+extern void activity_recv(const vvp_net_t*net);
+
+/*
+ * An event was scheduled. The scope is the scope of the thread that
+ * the event is for or that scheduled it, or nil if the event comes
+ * from the net functors.
+ */
+extern void activity_event(__vpiScope*scope);
+
+/*
+ * The scheduler calls these as it runs: activity_run() for each event
+ * that it runs, activity_delta() when the active queue is refilled
+ * from the nonblocking or the rwsync queue, and activity_step() when
+ * the simulation advances to a new time.
+ */
+extern void activity_run(void);
+extern void activity_delta(void);
+extern void activity_step(vvp_time64_t time);
+
+/*
+ * Print the counts. This is called when the simulation finishes.
+ */
+extern void activity_report(void);
+
+#endif /* IVL_activity_H */
@@ -19,6 +19,7 @@
 
 # include  "arith.h"
 # include  "schedule.h"
+# include  "checkpoint.h"
 # include  <climits>
 # include  <iostream>
 # include  <cassert>
@@ -35,7 +36,13 @@ vvp_arith_::vvp_arith_(unsigned wid)
       }
 }
 
-void vvp_arith_::dispatch_operand_(vvp_net_ptr_t ptr, vvp_vector4_t bit)
+void vvp_arith_::checkpoint(vvp_checkpoint_t&cp)
+{
+      cp.io(op_a_);
+      cp.io(op_b_);
+}
+
+void vvp_arith_::dispatch_operand_(vvp_net_ptr_t ptr, const vvp_vector4_t&bit)
 {
       unsigned port = ptr.port();
       switch (port) {
@@ -519,6 +526,7 @@ void vvp_arith_pow::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
 vvp_arith_sum::vvp_arith_sum(unsigned wid)
 : vvp_arith_(wid)
 {
+      kind_ = KIND_ARITH_SUM;
 }
 
 vvp_arith_sum::~vvp_arith_sum()
@@ -534,6 +542,18 @@ void vvp_arith_sum::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
 
       vvp_vector4_t value (wid_);
 
+	/* If the sum fits in a word and the operands have no X or Z
+	   bits, then add them as integers. The bits of the operands
+	   past their width read as 0, which is the padding. */
+      if (wid_ > 0 && wid_ <= 8*sizeof(unsigned long)
+	  && op_a_.size() > 0 && op_b_.size() > 0
+	  && ! op_a_.has_xz() && ! op_b_.has_xz()) {
+	    unsigned long sum = op_a_.two_state_word(0) + op_b_.two_state_word(0);
+	    value.setarray(0, wid_, &sum);
+	    net->send_vec4(value, 0);
+	    return;
+      }
+
 	/* Pad input vectors with this value to widen to the desired
 	   output width. */
       const vvp_bit4_t pad = BIT4_0;
@@ -1018,6 +1038,12 @@ vvp_arith_real_::vvp_arith_real_()
       op_b_ = 0.0;
 }
 
+void vvp_arith_real_::checkpoint(vvp_checkpoint_t&cp)
+{
+      cp.io(op_a_);
+      cp.io(op_b_);
+}
+
 void vvp_arith_real_::dispatch_operand_(vvp_net_ptr_t ptr, double bit)
 {
       switch (ptr.port()) {
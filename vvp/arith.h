@@ -41,8 +41,10 @@ class vvp_arith_  : public vvp_net_fun_t {
 			unsigned base, unsigned wid, unsigned vwid,
                         vvp_context_t ctx);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     protected:
-      void dispatch_operand_(vvp_net_ptr_t ptr, vvp_vector4_t bit);
+      void dispatch_operand_(vvp_net_ptr_t ptr, const vvp_vector4_t&bit);
 
     protected:
       unsigned wid_;
@@ -333,6 +335,8 @@ class vvp_arith_real_  : public vvp_net_fun_t {
     public:
       explicit vvp_arith_real_();
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     protected:
       void dispatch_operand_(vvp_net_ptr_t ptr, double bit);
 
@@ -24,6 +24,7 @@
 # include  "vpi_priv.h"
 # include  "vvp_net_sig.h"
 # include  "vvp_darray.h"
+# include  "checkpoint.h"
 # include  "config.h"
 #ifdef CHECK_WITH_VALGRIND
 #include  "vvp_cleanup.h"
@@ -45,6 +46,15 @@ unsigned long count_real_array_words = 0;
 
 static symbol_map_s<struct __vpiArray>* array_table =0;
 
+/*
+ * All the arrays of the design in the order that they are made. The
+ * checkpoint uses the position in this list to name an array. An
+ * alias shares the words of its source, so only the source saves
+ * them.
+ */
+static std::vector<vvp_array_t> array_list;
+static std::vector<bool> array_is_alias;
+
 class vvp_fun_arrayport;
 static void array_attach_port(vvp_array_t, vvp_fun_arrayport*);
 
@@ -798,6 +808,9 @@ vpiHandle vpip_make_array(char*label, const char*name,
 	/* Blindly attach to the scope as an object. */
       vpip_attach_to_current_scope(obj);
 
+      array_list.push_back(obj);
+      array_is_alias.push_back(false);
+
       return obj;
 }
 
@@ -989,6 +1002,8 @@ class vvp_fun_arrayport  : public vvp_net_fun_t {
 
       virtual void check_word_change(unsigned long addr) = 0;
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     protected:
       vvp_array_t arr_;
       vvp_net_t  *net_;
@@ -1015,6 +1030,11 @@ vvp_fun_arrayport::~vvp_fun_arrayport()
 {
 }
 
+void vvp_fun_arrayport::checkpoint(vvp_checkpoint_t&cp)
+{
+      cp.io(addr_);
+}
+
 class vvp_fun_arrayport_sa  : public vvp_fun_arrayport {
 
     public:
@@ -1250,7 +1270,9 @@ void __vpiArray::word_change(unsigned long addr)
       struct __vpiCallback *prev = 0;
 
       while (next) {
-	    array_word_value_callback*cur = dynamic_cast<array_word_value_callback*>(next);
+	      // Only array_word_value_callback objects are put on
+	      // this list, by vpip_array_word_change() and vpip_array_change().
+	    array_word_value_callback*cur = static_cast<array_word_value_callback*>(next);
 	    next = cur->next;
 
 	      // Skip callbacks that are not for me. -1 is for every element.
@@ -1523,11 +1545,98 @@ void compile_array_alias(char*label, char*name, char*src)
       compile_vpi_symbol(label, obj);
       vpip_attach_to_current_scope(obj);
 
+      array_list.push_back(obj);
+      array_is_alias.push_back(true);
+
       free(label);
       free(name);
       free(src);
 }
 
+unsigned long array_checkpoint_count(void)
+{
+      return array_list.size();
+}
+
+unsigned long array_checkpoint_index(vvp_array_t array)
+{
+      for (unsigned long idx = 0 ; idx < array_list.size() ; idx += 1) {
+	    if (array_list[idx] == array)
+		  return idx;
+      }
+      return ULONG_MAX;
+}
+
+vvp_array_t array_checkpoint_at(unsigned long idx)
+{
+      if (idx >= array_list.size())
+	    return 0;
+      return array_list[idx];
+}
+
+/*
+ * Save or restore the words of a variable array. Net arrays keep
+ * their words in nets, and those are saved with the nets.
+ */
+void array_checkpoint(vvp_checkpoint_t&cp, unsigned long idx)
+{
+      vvp_array_t arr = array_list[idx];
+      if (array_is_alias[idx])
+	    return;
+
+      if (arr->vals4) {
+	    vvp_vector4array_sa*vals4 = dynamic_cast<vvp_vector4array_sa*>(arr->vals4);
+	    if (vals4 == 0)
+		  return;
+	    for (unsigned adr = 0 ; adr < vals4->words() ; adr += 1) {
+		  vvp_vector4_t val = vals4->get_word(adr);
+		  cp.io(val);
+		  if (cp.restoring())
+			vals4->set_word(adr, val);
+	    }
+	    return;
+      }
+
+      if (arr->vals == 0)
+	    return;
+
+      size_t words = arr->vals->get_size();
+      if (dynamic_cast<vvp_darray_object*>(arr->vals)) {
+	    for (unsigned adr = 0 ; adr < words && ! cp.restoring() ; adr += 1) {
+		  vvp_object_t val;
+		  arr->vals->get_word(adr, val);
+		  if (! val.test_nil()) {
+			cp.unsupported("class object array");
+			break;
+		  }
+	    }
+
+      } else if (dynamic_cast<vvp_darray_real*>(arr->vals)) {
+	    for (unsigned adr = 0 ; adr < words ; adr += 1) {
+		  double val = 0.0;
+		  if (! cp.restoring()) arr->vals->get_word(adr, val);
+		  cp.io(val);
+		  if (cp.restoring()) arr->vals->set_word(adr, val);
+	    }
+
+      } else if (dynamic_cast<vvp_darray_string*>(arr->vals)) {
+	    for (unsigned adr = 0 ; adr < words ; adr += 1) {
+		  std::string val;
+		  if (! cp.restoring()) arr->vals->get_word(adr, val);
+		  cp.io(val);
+		  if (cp.restoring()) arr->vals->set_word(adr, val);
+	    }
+
+      } else {
+	    for (unsigned adr = 0 ; adr < words ; adr += 1) {
+		  vvp_vector4_t val;
+		  if (! cp.restoring()) arr->vals->get_word(adr, val);
+		  cp.io(val);
+		  if (cp.restoring()) arr->vals->set_word(adr, val);
+	    }
+      }
+}
+
 /*
  * &A<label,addr>
  * This represents a VPI handle for an addressed array. This comes
@@ -20,6 +20,7 @@
 # include  "bufif.h"
 # include  "schedule.h"
 # include  "statistics.h"
+# include  "checkpoint.h"
 # include  <iostream>
 # include  <cassert>
 
@@ -32,6 +33,12 @@ vvp_fun_bufif::vvp_fun_bufif(bool en_invert, bool out_invert,
       count_functors_bufif += 1;
 }
 
+void vvp_fun_bufif::checkpoint(vvp_checkpoint_t&cp)
+{
+      cp.io(bit_);
+      cp.io(en_);
+}
+
 void vvp_fun_bufif::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                               vvp_context_t)
 {
@@ -44,6 +44,8 @@ class vvp_fun_bufif  : public vvp_net_fun_t {
 			unsigned base, unsigned wid, unsigned vwid,
                         vvp_context_t ctx);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       vvp_vector4_t bit_;
       vvp_vector4_t en_;
@@ -0,0 +1,906 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "checkpoint.h"
+# include  "compile.h"
+# include  "statistics.h"
+# include  "vpi_priv.h"
+# include  <map>
+# include  <cstdio>
+# include  <cstdlib>
+# include  <cstring>
+# include  <climits>
+
+using namespace std;
+
+/*
+ * The checkpoint file starts with a header, and the rest of the file
+ * is a list of records. Each record has a tag, an index and the data
+ * that the checkpoint() methods wrote. The tags are:
+ *
+ *    T  - The threads (index 0)
+ *    N  - The functor and filter of a net (index is the net index)
+ *    A  - The words of a variable array (index is the array index)
+ *    Q  - The event queue (index 0)
+ *    V  - The data that VPI modules saved with vpi_put_data (index 0)
+ *    E  - End of the file
+ *
+ * An incremental checkpoint holds only the N and A records that are
+ * different from the full checkpoint that it is based on, along with
+ * the complete T, Q and V records. It names its base checkpoint in
+ * the header, and the records are merged when it is restored.
+ */
+static const char checkpoint_magic[] = "VVPCKPT";
+static const unsigned long checkpoint_version = 1;
+
+enum checkpoint_kind_t { CHECKPOINT_FULL = 0, CHECKPOINT_INCREMENTAL = 1 };
+
+typedef pair<char,unsigned long> record_key_t;
+typedef map<record_key_t,string> record_map_t;
+
+/*
+ * The design is identified by a hash of the input file, the number
+ * of nets and the number of arrays.
+ */
+static uint64_t design_hash = 0;
+static unsigned long design_nets = 0;
+
+  // The tables of the checkpoint that is being saved or restored.
+static vector<__vpiScope*> scope_table;
+static map<__vpiScope*,unsigned long> scope_index;
+static vector<vthread_t> thread_table;
+static map<vthread_t,unsigned long> thread_index;
+static set<vthread_t> final_threads;
+static map<vvp_gen_event_t,vvp_net_t*> claimed_events;
+static map<vvp_net_t*,vvp_gen_event_t> claimed_nets;
+static set<string> unsupported_items;
+
+  // The restore that the -r flag asked for.
+static string restore_path;
+
+  // A save that $save or $incsave asked for.
+static string request_path;
+static bool request_incremental = false;
+
+  // The periodic checkpoints that the -c flag asked for.
+static vvp_time64_t periodic_period = 0;
+static vvp_time64_t periodic_next = 0;
+static string periodic_path;
+
+  // The record hashes of the last full checkpoint, for incremental
+  // checkpoints that are based on it.
+static string base_path;
+static map<record_key_t,uint64_t> base_hashes;
+
+  // Support for vpi_put_data and vpi_get_data.
+static string save_restart_location;
+static PLI_INT32 save_restart_id = 0;
+static map<PLI_INT32,string> vpi_data;
+static map<PLI_INT32,size_t> vpi_data_pos;
+
+static uint64_t fnv_hash(const char*data, size_t len, uint64_t hash = 0xcbf29ce484222325ULL)
+{
+      for (size_t idx = 0 ; idx < len ; idx += 1) {
+	    hash ^= (unsigned char)data[idx];
+	    hash *= 0x100000001b3ULL;
+      }
+      return hash;
+}
+
+vvp_checkpoint_t::vvp_checkpoint_t(bool restoring)
+: restoring_(restoring), pos_(0), current_net_(0)
+{
+}
+
+vvp_checkpoint_t::~vvp_checkpoint_t()
+{
+}
+
+/*
+ * Numbers are written as variable length integers, 7 bits per byte
+ * with the high bit set on all but the last byte.
+ */
+void vvp_checkpoint_t::put_(uint64_t val)
+{
+      while (val >= 0x80) {
+	    data_.push_back((char)(val | 0x80));
+	    val >>= 7;
+      }
+      data_.push_back((char)val);
+}
+
+uint64_t vvp_checkpoint_t::get_(void)
+{
+      uint64_t val = 0;
+      unsigned shift = 0;
+      while (pos_ < data_.size()) {
+	    unsigned char byte = data_[pos_++];
+	    val |= (uint64_t)(byte & 0x7f) << shift;
+	    if ((byte & 0x80) == 0)
+		  break;
+	    shift += 7;
+      }
+      return val;
+}
+
+void vvp_checkpoint_t::io(bool&val)
+{
+      if (restoring_) val = get_() != 0;
+      else put_(val? 1 : 0);
+}
+
+void vvp_checkpoint_t::io(int&val)
+{
+	// Fold the sign into bit 0 so that small negative numbers
+	// are still small.
+      if (restoring_) {
+	    uint64_t tmp = get_();
+	    val = (int)((tmp >> 1) ^ (~(tmp & 1) + 1));
+      } else {
+	    int64_t tmp = val;
+	    put_(((uint64_t)tmp << 1) ^ (uint64_t)(tmp >> 63));
+      }
+}
+
+void vvp_checkpoint_t::io(unsigned&val)
+{
+      if (restoring_) val = get_();
+      else put_(val);
+}
+
+void vvp_checkpoint_t::io(unsigned long&val)
+{
+      if (restoring_) val = get_();
+      else put_(val);
+}
+
+void vvp_checkpoint_t::io(unsigned long long&val)
+{
+      if (restoring_) val = get_();
+      else put_(val);
+}
+
+void vvp_checkpoint_t::io(double&val)
+{
+      uint64_t tmp;
+      if (restoring_) {
+	    tmp = get_();
+	    memcpy(&val, &tmp, sizeof val);
+      } else {
+	    memcpy(&tmp, &val, sizeof tmp);
+	    put_(tmp);
+      }
+}
+
+void vvp_checkpoint_t::io(vvp_bit4_t&val)
+{
+      if (restoring_) val = (vvp_bit4_t)(get_() & 3);
+      else put_(val);
+}
+
+void vvp_checkpoint_t::io(std::string&val)
+{
+      if (restoring_) {
+	    size_t len = get_();
+	    if (len > data_.size() - pos_)
+		  len = data_.size() - pos_;
+	    val = data_.substr(pos_, len);
+	    pos_ += len;
+      } else {
+	    put_(val.size());
+	    data_.append(val);
+      }
+}
+
+void vvp_checkpoint_t::io(vvp_scalar_t&val)
+{
+      if (restoring_) val = vvp_scalar_t((unsigned char)get_());
+      else put_(val.raw());
+}
+
+void vvp_checkpoint_t::io(vvp_vector2_t&val)
+{
+      unsigned wid = val.size();
+      io(wid);
+      if (restoring_) val = vvp_vector2_t(vvp_vector2_t::FILL0, wid);
+
+	// Pack 8 bits into each byte.
+      for (unsigned idx = 0 ; idx < wid ; idx += 8) {
+	    unsigned char byte = 0;
+	    unsigned cnt = wid - idx < 8? wid - idx : 8;
+	    if (restoring_) {
+		  byte = pos_ < data_.size()? data_[pos_++] : 0;
+		  for (unsigned bit = 0 ; bit < cnt ; bit += 1)
+			val.set_bit(idx+bit, (byte >> bit) & 1);
+	    } else {
+		  for (unsigned bit = 0 ; bit < cnt ; bit += 1)
+			byte |= (val.value(idx+bit) & 1) << bit;
+		  data_.push_back((char)byte);
+	    }
+      }
+}
+
+void vvp_checkpoint_t::io(vvp_vector4_t&val)
+{
+      unsigned wid = val.size();
+      io(wid);
+      if (restoring_) val = vvp_vector4_t(wid);
+
+	// Pack 4 bits into each byte.
+      for (unsigned idx = 0 ; idx < wid ; idx += 4) {
+	    unsigned char byte = 0;
+	    unsigned cnt = wid - idx < 4? wid - idx : 4;
+	    if (restoring_) {
+		  byte = pos_ < data_.size()? data_[pos_++] : 0;
+		  for (unsigned bit = 0 ; bit < cnt ; bit += 1)
+			val.set_bit(idx+bit, (vvp_bit4_t)((byte >> 2*bit) & 3));
+	    } else {
+		  for (unsigned bit = 0 ; bit < cnt ; bit += 1)
+			byte |= val.value(idx+bit) << 2*bit;
+		  data_.push_back((char)byte);
+	    }
+      }
+}
+
+void vvp_checkpoint_t::io(vvp_vector8_t&val)
+{
+      unsigned wid = val.size();
+      io(wid);
+      if (restoring_) val = vvp_vector8_t(wid);
+
+      for (unsigned idx = 0 ; idx < wid ; idx += 1) {
+	    if (restoring_) {
+		  unsigned char byte = pos_ < data_.size()? data_[pos_++] : 0;
+		  val.set_bit(idx, vvp_scalar_t(byte));
+	    } else {
+		  data_.push_back((char)val.value(idx).raw());
+	    }
+      }
+}
+
+void vvp_checkpoint_t::io_net(vvp_net_t*&net)
+{
+      if (restoring_) {
+	    unsigned long idx = get_();
+	    net = idx? vvp_net_at(idx-1) : 0;
+	    return;
+      }
+
+      unsigned long idx = net? vvp_net_index(net) : ULONG_MAX;
+      if (net && idx >= design_nets) {
+	    unsupported("links to nets made during the simulation");
+	    put_(0);
+	    return;
+      }
+      put_(net? idx+1 : 0);
+}
+
+void vvp_checkpoint_t::io_array(vvp_array_t&array)
+{
+      if (restoring_) {
+	    unsigned long idx = get_();
+	    array = idx? array_checkpoint_at(idx-1) : 0;
+	    return;
+      }
+
+      unsigned long idx = array? array_checkpoint_index(array) : ULONG_MAX;
+      put_(idx == ULONG_MAX? 0 : idx+1);
+}
+
+void vvp_checkpoint_t::io_thread(vthread_t&thr)
+{
+      if (restoring_) {
+	    unsigned long idx = get_();
+	    thr = (idx && idx <= thread_table.size())? thread_table[idx-1] : 0;
+	    return;
+      }
+
+      put_(thr? checkpoint_thread_index(thr) : 0);
+}
+
+void vvp_checkpoint_t::io_scope(__vpiScope*&scope)
+{
+      if (restoring_) {
+	    unsigned long idx = get_();
+	    scope = (idx && idx <= scope_table.size())? scope_table[idx-1] : 0;
+	    return;
+      }
+
+      map<__vpiScope*,unsigned long>::const_iterator cur = scope_index.find(scope);
+      put_(cur == scope_index.end()? 0 : cur->second+1);
+}
+
+void vvp_checkpoint_t::claim_event(vvp_gen_event_t obj)
+{
+      assert(current_net_);
+      if (restoring_)
+	    claimed_nets[current_net_] = obj;
+      else
+	    claimed_events[obj] = current_net_;
+}
+
+void vvp_checkpoint_t::unsupported(const char*what)
+{
+      unsupported_items.insert(what);
+}
+
+unsigned long checkpoint_thread_index(vthread_t thr)
+{
+      map<vthread_t,unsigned long>::const_iterator cur = thread_index.find(thr);
+      return cur == thread_index.end()? 0 : cur->second+1;
+}
+
+bool checkpoint_thread_is_final(vthread_t thr)
+{
+      return final_threads.find(thr) != final_threads.end();
+}
+
+vvp_net_t* checkpoint_event_net(vvp_gen_event_t obj)
+{
+      map<vvp_gen_event_t,vvp_net_t*>::const_iterator cur = claimed_events.find(obj);
+      return cur == claimed_events.end()? 0 : cur->second;
+}
+
+vvp_gen_event_t checkpoint_net_event(vvp_net_t*net)
+{
+      map<vvp_net_t*,vvp_gen_event_t>::const_iterator cur = claimed_nets.find(net);
+      return cur == claimed_nets.end()? 0 : cur->second;
+}
+
+/*
+ * The scopes are numbered in the order of a depth first walk of the
+ * scope tree, which is the same every time the design is loaded.
+ */
+static void scan_scope_(__vpiScope*scope)
+{
+      scope_index[scope] = scope_table.size();
+      scope_table.push_back(scope);
+
+      for (unsigned idx = 0 ; idx < scope->intern.size() ; idx += 1) {
+	    if (__vpiScope*sub = dynamic_cast<__vpiScope*>(scope->intern[idx]))
+		  scan_scope_(sub);
+      }
+}
+
+static void make_scope_table_(void)
+{
+      scope_table.clear();
+      scope_index.clear();
+
+      __vpiHandle**table;
+      unsigned ntable;
+      vpip_make_root_iterator(table, ntable);
+      for (unsigned idx = 0 ; idx < ntable ; idx += 1) {
+	    if (__vpiScope*scope = dynamic_cast<__vpiScope*>(table[idx]))
+		  scan_scope_(scope);
+      }
+}
+
+static void collect_threads_(vector<vthread_t>&threads)
+{
+      for (size_t idx = 0 ; idx < scope_table.size() ; idx += 1) {
+	    set<vthread_t>&list = scope_table[idx]->threads;
+	    threads.insert(threads.end(), list.begin(), list.end());
+      }
+}
+
+static void clear_tables_(void)
+{
+      thread_table.clear();
+      thread_index.clear();
+      final_threads.clear();
+      claimed_events.clear();
+      claimed_nets.clear();
+}
+
+/*
+ * Run the functor and filter of a net through the checkpoint. A
+ * functor or filter that is shared with an earlier net is only
+ * done once.
+ */
+static void checkpoint_net_(vvp_checkpoint_t&cp, unsigned long idx,
+			    set<void*>&done)
+{
+      vvp_net_t*net = vvp_net_at(idx);
+      cp.set_current_net(net);
+
+      if (net->fun && done.insert(net->fun).second)
+	    net->fun->checkpoint(cp);
+      if (net->fil && done.insert(net->fil).second)
+	    net->fil->checkpoint(cp);
+
+      cp.set_current_net(0);
+}
+
+static void checkpoint_vpi_data_(vvp_checkpoint_t&cp)
+{
+      unsigned long count = vpi_data.size();
+      cp.io(count);
+
+      if (cp.restoring()) {
+	    vpi_data.clear();
+	    vpi_data_pos.clear();
+	    for (unsigned long idx = 0 ; idx < count ; idx += 1) {
+		  unsigned id = 0;
+		  string data;
+		  cp.io(id);
+		  cp.io(data);
+		  vpi_data[id] = data;
+	    }
+	    return;
+      }
+
+      for (map<PLI_INT32,string>::iterator cur = vpi_data.begin()
+		 ; cur != vpi_data.end() ; ++cur) {
+	    unsigned id = cur->first;
+	    cp.io(id);
+	    cp.io(cur->second);
+      }
+}
+
+static void write_record_(vvp_checkpoint_t&out, char tag, unsigned long idx,
+			  const string&data)
+{
+      unsigned long tmp_tag = tag;
+      out.io(tmp_tag);
+      out.io(idx);
+      string tmp = data;
+      out.io(tmp);
+}
+
+/*
+ * Write a checkpoint of the current state. This is only called
+ * between time steps, when the current time step is complete.
+ */
+static void checkpoint_save_(const string&path, bool incremental)
+{
+      if (incremental && base_path.empty()) {
+	    vpi_mcd_printf(1, "Warning: no full checkpoint for the incremental "
+			   "checkpoint %s, saving all the state.\n", path.c_str());
+	    incremental = false;
+      }
+
+      save_restart_location = path;
+      save_restart_id = 0;
+      vpi_data.clear();
+      vpiSaveRestart(cbStartOfSave);
+
+      clear_tables_();
+      unsupported_items.clear();
+      make_scope_table_();
+      collect_threads_(thread_table);
+      for (size_t idx = 0 ; idx < thread_table.size() ; idx += 1)
+	    thread_index[thread_table[idx]] = idx;
+      schedule_checkpoint_final_threads(final_threads);
+
+      vvp_checkpoint_t out (false);
+      string magic = checkpoint_magic;
+      out.io(magic);
+      unsigned long version = checkpoint_version;
+      unsigned long kind = incremental? CHECKPOINT_INCREMENTAL : CHECKPOINT_FULL;
+      unsigned long long hash = design_hash;
+      unsigned long nets = design_nets;
+      unsigned long arrays = array_checkpoint_count();
+      unsigned long long time = schedule_simtime();
+      string base = incremental? base_path : string();
+      out.io(version);
+      out.io(kind);
+      out.io(hash);
+      out.io(nets);
+      out.io(arrays);
+      out.io(time);
+      out.io(base);
+
+      map<record_key_t,uint64_t> hashes;
+
+      vvp_checkpoint_t cp (false);
+      vthread_checkpoint(cp, thread_table);
+      write_record_(out, 'T', 0, cp.data());
+
+	// The functors claim their events as they are saved, so the
+	// nets must be saved before the event queue.
+      set<void*> done;
+      for (unsigned long idx = 0 ; idx < design_nets ; idx += 1) {
+	    vvp_checkpoint_t ncp (false);
+	    checkpoint_net_(ncp, idx, done);
+	    record_key_t key ('N', idx);
+	    uint64_t rec_hash = fnv_hash(ncp.data().data(), ncp.data().size());
+	    if (incremental) {
+		  if (base_hashes[key] != rec_hash)
+			write_record_(out, 'N', idx, ncp.data());
+	    } else {
+		  hashes[key] = rec_hash;
+		  if (! ncp.data().empty())
+			write_record_(out, 'N', idx, ncp.data());
+	    }
+      }
+
+      for (unsigned long idx = 0 ; idx < arrays ; idx += 1) {
+	    vvp_checkpoint_t acp (false);
+	    array_checkpoint(acp, idx);
+	    record_key_t key ('A', idx);
+	    uint64_t rec_hash = fnv_hash(acp.data().data(), acp.data().size());
+	    if (incremental) {
+		  if (base_hashes[key] != rec_hash)
+			write_record_(out, 'A', idx, acp.data());
+	    } else {
+		  hashes[key] = rec_hash;
+		  if (! acp.data().empty())
+			write_record_(out, 'A', idx, acp.data());
+	    }
+      }
+
+      vvp_checkpoint_t qcp (false);
+      schedule_checkpoint(qcp);
+      write_record_(out, 'Q', 0, qcp.data());
+
+      vvp_checkpoint_t vcp (false);
+      checkpoint_vpi_data_(vcp);
+      write_record_(out, 'V', 0, vcp.data());
+
+      unsigned long end_tag = 'E';
+      out.io(end_tag);
+
+	// The cbEndOfSave callbacks run even if the file cannot be
+	// written, so that the VPI users see the end of every save
+	// that they saw start.
+      bool ok_flag = false;
+      if (FILE*fd = fopen(path.c_str(), "wb")) {
+	    size_t rc = fwrite(out.data().data(), 1, out.data().size(), fd);
+	    ok_flag = rc == out.data().size();
+	    if (fclose(fd) != 0)
+		  ok_flag = false;
+      }
+
+      if (! ok_flag) {
+	    perror(path.c_str());
+
+      } else {
+	    if (! incremental) {
+		  base_path = path;
+		  base_hashes.swap(hashes);
+	    }
+
+	    for (set<string>::const_iterator cur = unsupported_items.begin()
+		       ; cur != unsupported_items.end() ; ++cur) {
+		  vpi_mcd_printf(1, "Warning: checkpoint %s does not include %s.\n",
+				 path.c_str(), cur->c_str());
+	    }
+
+	    if (verbose_flag)
+		  vpi_mcd_printf(1, " ...saved %s checkpoint %s at time %" TIME_FMT_U "\n",
+				 incremental? "incremental" : "full", path.c_str(),
+				 schedule_simtime());
+      }
+
+      clear_tables_();
+      vpiSaveRestart(cbEndOfSave);
+}
+
+/*
+ * Read the records of a checkpoint file into the map. An
+ * incremental checkpoint first reads its base checkpoint, then
+ * replaces the records that it holds.
+ */
+static bool checkpoint_load_(const string&path, record_map_t&records,
+			     vvp_time64_t&time, bool base_only)
+{
+      FILE*fd = fopen(path.c_str(), "rb");
+      if (fd == 0) {
+	    perror(path.c_str());
+	    return false;
+      }
+
+      vvp_checkpoint_t in (true);
+      char buf[64*1024];
+      size_t rc;
+      while ((rc = fread(buf, 1, sizeof buf, fd)) > 0)
+	    in.data().append(buf, rc);
+      fclose(fd);
+
+      string magic;
+      in.io(magic);
+      if (magic != checkpoint_magic) {
+	    vpi_mcd_printf(1, "%s: Not a vvp checkpoint file.\n", path.c_str());
+	    return false;
+      }
+
+      unsigned long version = 0, kind = 0, nets = 0, arrays = 0;
+      unsigned long long hash = 0, ckpt_time = 0;
+      string base;
+      in.io(version);
+      in.io(kind);
+      in.io(hash);
+      in.io(nets);
+      in.io(arrays);
+      in.io(ckpt_time);
+      in.io(base);
+
+      if (version != checkpoint_version) {
+	    vpi_mcd_printf(1, "%s: Unsupported checkpoint version %lu.\n",
+			   path.c_str(), version);
+	    return false;
+      }
+      if (hash != design_hash || nets != design_nets
+	  || arrays != array_checkpoint_count()) {
+	    vpi_mcd_printf(1, "%s: Checkpoint is for a different design.\n",
+			   path.c_str());
+	    return false;
+      }
+      if (base_only && kind != CHECKPOINT_FULL) {
+	    vpi_mcd_printf(1, "%s: Base checkpoint is not a full checkpoint.\n",
+			   path.c_str());
+	    return false;
+      }
+
+      if (kind == CHECKPOINT_INCREMENTAL) {
+	    vvp_time64_t base_time;
+	    if (! checkpoint_load_(base, records, base_time, true))
+		  return false;
+      }
+
+      time = ckpt_time;
+      for (;;) {
+	    unsigned long tag = 0, idx = 0;
+	    in.io(tag);
+	    if (tag == 'E')
+		  break;
+	    if (in.at_end()) {
+		  vpi_mcd_printf(1, "%s: Checkpoint file is truncated.\n",
+				 path.c_str());
+		  return false;
+	    }
+	    in.io(idx);
+	    string data;
+	    in.io(data);
+	    records[record_key_t((char)tag, idx)] = data;
+      }
+
+      return true;
+}
+
+/*
+ * Replace the state of the freshly compiled design with the state
+ * from the checkpoint. The threads and events that the compile made
+ * are thrown away first, and the threads of the checkpoint are made
+ * before the nets and the event queue so that those can refer to
+ * them.
+ */
+static bool checkpoint_restore_(const string&path)
+{
+      record_map_t records;
+      vvp_time64_t time = 0;
+      if (! checkpoint_load_(path, records, time, false))
+	    return false;
+
+      save_restart_location = path;
+      save_restart_id = 0;
+      vvp_checkpoint_t vcp (true);
+      vcp.data() = records[record_key_t('V',0)];
+      checkpoint_vpi_data_(vcp);
+      vpiSaveRestart(cbStartOfRestart);
+
+      clear_tables_();
+      make_scope_table_();
+
+      vector<vthread_t> compiled;
+      collect_threads_(compiled);
+      schedule_checkpoint_discard();
+      vthread_checkpoint_discard(compiled);
+      schedule_checkpoint_set_time(time);
+
+      vvp_checkpoint_t tcp (true);
+      tcp.data() = records[record_key_t('T',0)];
+      vthread_checkpoint(tcp, thread_table);
+
+      set<void*> done;
+      for (unsigned long idx = 0 ; idx < design_nets ; idx += 1) {
+	    record_map_t::iterator cur = records.find(record_key_t('N',idx));
+	    if (cur == records.end())
+		  continue;
+	    vvp_checkpoint_t ncp (true);
+	    ncp.data().swap(cur->second);
+	    checkpoint_net_(ncp, idx, done);
+      }
+
+      for (unsigned long idx = 0 ; idx < array_checkpoint_count() ; idx += 1) {
+	    record_map_t::iterator cur = records.find(record_key_t('A',idx));
+	    if (cur == records.end())
+		  continue;
+	    vvp_checkpoint_t acp (true);
+	    acp.data().swap(cur->second);
+	    array_checkpoint(acp, idx);
+      }
+
+      vvp_checkpoint_t qcp (true);
+      qcp.data() = records[record_key_t('Q',0)];
+      schedule_checkpoint(qcp);
+
+      clear_tables_();
+
+      if (verbose_flag)
+	    vpi_mcd_printf(1, " ...restored checkpoint %s at time %" TIME_FMT_U "\n",
+			   path.c_str(), time);
+
+      vpiSaveRestart(cbEndOfRestart);
+      return true;
+}
+
+void checkpoint_set_design(const char*path)
+{
+      design_hash = 0xcbf29ce484222325ULL;
+
+      FILE*fd = fopen(path, "rb");
+      if (fd == 0)
+	    return;
+
+      char buf[64*1024];
+      size_t rc;
+      while ((rc = fread(buf, 1, sizeof buf, fd)) > 0)
+	    design_hash = fnv_hash(buf, rc, design_hash);
+      fclose(fd);
+}
+
+/*
+ * The design is not compiled yet when the -r flag is processed, so
+ * only check here that the file is there and is a checkpoint. The
+ * rest is checked against the design when the checkpoint is loaded.
+ */
+bool checkpoint_set_restore(const char*path)
+{
+      if (path == 0 || *path == 0)
+	    return false;
+
+      FILE*fd = fopen(path, "rb");
+      if (fd == 0) {
+	    perror(path);
+	    return false;
+      }
+
+      vvp_checkpoint_t in (true);
+      char buf[64];
+      size_t rc = fread(buf, 1, sizeof buf, fd);
+      fclose(fd);
+      in.data().append(buf, rc);
+
+      string magic;
+      in.io(magic);
+      if (magic != checkpoint_magic) {
+	    fprintf(stderr, "%s: Not a vvp checkpoint file.\n", path);
+	    return false;
+      }
+
+      restore_path = path;
+      return true;
+}
+
+/*
+ * The periodic checkpoint spec is <period>:<file>. The period is in
+ * simulation ticks. The first checkpoint is a full checkpoint to the
+ * file, and the rest are incremental checkpoints based on it to
+ * <file>.<time>.
+ */
+bool checkpoint_set_periodic(const char*spec)
+{
+      char*end;
+      unsigned long long period = strtoull(spec, &end, 0);
+      if (end == spec || *end != ':' || end[1] == 0 || period == 0)
+	    return false;
+
+      periodic_period = period;
+      periodic_next = period;
+      periodic_path = end+1;
+      return true;
+}
+
+void checkpoint_request(const char*path, bool incremental)
+{
+      request_path = path;
+      request_incremental = incremental;
+}
+
+void checkpoint_start(void)
+{
+	// Only the nets of the compiled design have an index in the
+	// checkpoint. Nets made during the simulation are not saved.
+      design_nets = count_vvp_nets;
+
+      if (restore_path.empty())
+	    return;
+
+      if (! checkpoint_restore_(restore_path)) {
+	    vpi_mcd_printf(1, "%s: Unable to restore the checkpoint.\n",
+			   restore_path.c_str());
+	    vpip_set_return_value(1);
+	    schedule_finish(0);
+	    return;
+      }
+
+	// Periodic checkpoints continue from the restored time.
+      if (periodic_period) {
+	    vvp_time64_t now = schedule_simtime();
+	    periodic_next = (now / periodic_period + 1) * periodic_period;
+      }
+}
+
+void checkpoint_time_step(vvp_time64_t next_time)
+{
+      if (! request_path.empty()) {
+	    string path = request_path;
+	    request_path.clear();
+	    checkpoint_save_(path, request_incremental);
+      }
+
+      if (periodic_period == 0 || next_time < periodic_next)
+	    return;
+
+      if (base_path != periodic_path) {
+	    checkpoint_save_(periodic_path, false);
+      } else {
+	    char buf[64];
+	    snprintf(buf, sizeof buf, ".%" TIME_FMT_U, schedule_simtime());
+	    checkpoint_save_(periodic_path + buf, true);
+      }
+
+      periodic_next = (next_time / periodic_period + 1) * periodic_period;
+}
+
+PLI_INT32 checkpoint_save_restart_id(void)
+{
+      save_restart_id += 1;
+      return save_restart_id;
+}
+
+const char* checkpoint_save_restart_location(void)
+{
+      return save_restart_location.c_str();
+}
+
+/*
+ * A VPI module saves its data with any number of vpi_put_data calls
+ * for an id, and reads it back in the same order with vpi_get_data.
+ */
+PLI_INT32 vpi_put_data(PLI_INT32 id, PLI_BYTE8*dataLoc, PLI_INT32 numOfBytes)
+{
+      if (id <= 0 || dataLoc == 0 || numOfBytes <= 0)
+	    return 0;
+
+      vpi_data[id].append(dataLoc, numOfBytes);
+      return numOfBytes;
+}
+
+PLI_INT32 vpi_get_data(PLI_INT32 id, PLI_BYTE8*dataLoc, PLI_INT32 numOfBytes)
+{
+      map<PLI_INT32,string>::const_iterator cur = vpi_data.find(id);
+      if (cur == vpi_data.end() || dataLoc == 0 || numOfBytes <= 0)
+	    return 0;
+
+      size_t&pos = vpi_data_pos[id];
+      size_t count = cur->second.size() - pos;
+      if (count > (size_t)numOfBytes)
+	    count = numOfBytes;
+      memcpy(dataLoc, cur->second.data() + pos, count);
+      pos += count;
+      return count;
+}
+
+void vpip_checkpoint_request(const char*path, int incremental)
+{
+      checkpoint_request(path, incremental != 0);
+}
@@ -0,0 +1,168 @@
+#ifndef IVL_checkpoint_H
+#define IVL_checkpoint_H
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "vvp_net.h"
+# include  "vthread.h"
+# include  "array.h"
+# include  "schedule.h"
+# include  <string>
+# include  <vector>
+# include  <set>
+
+/*
+ * A checkpoint is a snapshot of the simulation state that is taken
+ * between time steps, when the only pending events are in the
+ * future. It holds the state of the functors and filters of the
+ * nets, the words of the variable arrays, the threads with their
+ * stacks, the future event queue and the data that VPI modules save
+ * with vpi_put_data(). A checkpoint is restored into a freshly
+ * compiled copy of the same design before the simulation starts.
+ *
+ * The vvp_checkpoint_t object is the record buffer that the state
+ * is written to or read from. The io() methods work in both
+ * directions, so the checkpoint() method of a functor is the same
+ * code for saving and for restoring and cannot get out of step.
+ */
+class vvp_checkpoint_t {
+
+    public:
+      explicit vvp_checkpoint_t(bool restoring);
+      ~vvp_checkpoint_t();
+
+      bool restoring() const { return restoring_; }
+
+	// The raw record data.
+      std::string&data() { return data_; }
+      void rewind(void) { pos_ = 0; }
+      bool at_end(void) const { return pos_ >= data_.size(); }
+
+      void io(bool&val);
+      void io(int&val);
+      void io(unsigned&val);
+      void io(unsigned long&val);
+      void io(unsigned long long&val);
+      void io(double&val);
+      void io(vvp_bit4_t&val);
+      void io(std::string&val);
+      void io(vvp_scalar_t&val);
+      void io(vvp_vector2_t&val);
+      void io(vvp_vector4_t&val);
+      void io(vvp_vector8_t&val);
+
+	// Pointers to the objects of the design are written as
+	// indices. A nil pointer is written as a 0 index.
+      void io_net(vvp_net_t*&net);
+      void io_array(vvp_array_t&array);
+      void io_thread(vthread_t&thr);
+      void io_scope(__vpiScope*&scope);
+
+	// A functor that schedules itself as a generic event for a
+	// future time claims that event here, both when saving and
+	// when restoring. This lets the event queue be saved and
+	// restored in order with the event pointing back to the net.
+      void claim_event(vvp_gen_event_t obj);
+
+	// Report state that cannot be saved. The checkpoint is
+	// still written, but the message tells the user what will be
+	// missing from the restored simulation.
+      void unsupported(const char*what);
+
+	// The net whose functor and filter are being saved or
+	// restored. Links to other nets are made again from here.
+      void set_current_net(vvp_net_t*net) { current_net_ = net; }
+      vvp_net_t*current_net(void) const { return current_net_; }
+
+    private:
+      void put_(uint64_t val);
+      uint64_t get_(void);
+
+      bool restoring_;
+      std::string data_;
+      size_t pos_;
+      vvp_net_t*current_net_;
+};
+
+/*
+ * Support for the thread and queue modules. The checkpoint module
+ * owns the maps from design objects to their indices. A thread that
+ * is not in the table (i.e. it has been reaped) has index 0.
+ */
+extern unsigned long checkpoint_thread_index(vthread_t thr);
+extern bool checkpoint_thread_is_final(vthread_t thr);
+extern vvp_net_t* checkpoint_event_net(vvp_gen_event_t obj);
+extern vvp_gen_event_t checkpoint_net_event(vvp_net_t*net);
+
+/*
+ * The thread module saves the live threads, or makes them again from
+ * the checkpoint after the threads made by the compile are discarded.
+ * The threads vector is the thread table of the checkpoint.
+ */
+extern void vthread_checkpoint(vvp_checkpoint_t&cp, std::vector<vthread_t>&threads);
+extern void vthread_checkpoint_list(vvp_checkpoint_t&cp, vthread_t&list);
+extern void vthread_checkpoint_discard(std::vector<vthread_t>&threads);
+
+/*
+ * The scheduler saves and restores the pending events. The discard
+ * drops the events that the compile scheduled.
+ */
+extern void schedule_checkpoint(vvp_checkpoint_t&cp);
+extern void schedule_checkpoint_discard(void);
+extern void schedule_checkpoint_final_threads(std::set<vthread_t>&threads);
+extern void schedule_checkpoint_set_time(vvp_time64_t val);
+
+/*
+ * The array module saves and restores the words of the variable
+ * arrays. The index is the position of the array in the design.
+ */
+extern unsigned long array_checkpoint_count(void);
+extern void array_checkpoint(vvp_checkpoint_t&cp, unsigned long idx);
+extern unsigned long array_checkpoint_index(vvp_array_t array);
+extern vvp_array_t array_checkpoint_at(unsigned long idx);
+
+/*
+ * The main program and the scheduler use these to drive the
+ * checkpoints. The save functions only request a checkpoint, and
+ * the scheduler writes it at the next point between time steps. The
+ * scheduler calls checkpoint_start() after the initialization
+ * events, and that restores the checkpoint that -r named, if any.
+ */
+extern bool checkpoint_set_restore(const char*path);
+extern bool checkpoint_set_periodic(const char*spec);
+extern void checkpoint_request(const char*path, bool incremental);
+extern void checkpoint_start(void);
+extern void checkpoint_time_step(vvp_time64_t next_time);
+
+/*
+ * The design file is hashed so that a checkpoint is not restored
+ * into a different design.
+ */
+extern void checkpoint_set_design(const char*path);
+
+/*
+ * Support for vpi_get(vpiSaveRestartID) and
+ * vpi_get_str(vpiSaveRestartLocation). The save and restart
+ * callbacks are run by vpiSaveRestart() in vpi_callback.cc.
+ */
+extern PLI_INT32 checkpoint_save_restart_id(void);
+extern const char* checkpoint_save_restart_location(void);
+extern void vpiSaveRestart(PLI_INT32 reason);
+
+#endif /* IVL_checkpoint_H */
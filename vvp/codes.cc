@@ -32,6 +32,10 @@
  * structures, with the last opcode loaded with an of_CHUNK_LINK
  * instruction to branch to the next chunk. This handles the case
  * where the program counter steps off the end of a chunk.
+ *
+ * The chunks are allocated zero filled so that code that looks ahead
+ * of an instruction (the superinstruction pass) sees a nil opcode
+ * past the last allocated instruction instead of garbage.
  */
 const unsigned code_chunk_size = 1024;
 
@@ -46,7 +50,7 @@ static unsigned current_within_chunk = 0;
 void codespace_init(void)
 {
       assert(current_chunk == 0);
-      first_chunk = new struct vvp_code_s [code_chunk_size];
+      first_chunk = new struct vvp_code_s [code_chunk_size]();
       current_chunk = first_chunk;
 
       current_chunk[0].opcode = &of_ZOMBIE;
@@ -64,7 +68,7 @@ vvp_code_t codespace_next(void)
 {
       if (current_within_chunk == (code_chunk_size-1)) {
 	    current_chunk[code_chunk_size-1].cptr
-		  = new struct vvp_code_s [code_chunk_size];
+		  = new struct vvp_code_s [code_chunk_size]();
 	    current_chunk = current_chunk[code_chunk_size-1].cptr;
 
 	      /* Put a link opcode on the end of the chunk. */
@@ -96,6 +100,58 @@ vvp_code_t codespace_null(void)
       return first_chunk + 0;
 }
 
+void codespace_walk(void (*fun)(vvp_code_t))
+{
+      vvp_code_t cur = first_chunk;
+
+      while (cur) {
+	    unsigned count = code_chunk_size-1;
+	    if (cur == current_chunk)
+		  count = current_within_chunk;
+
+	    for (unsigned idx = 0 ; idx < count ; idx += 1)
+		  fun(cur+idx);
+
+	    fun(cur+code_chunk_size-1);
+	    if (cur == current_chunk)
+		  break;
+	    cur = cur[code_chunk_size-1].cptr;
+      }
+}
+
+static vvp_code_t codespace_chunk_(unsigned long num)
+{
+      vvp_code_t cur = first_chunk;
+      while (cur && num > 0) {
+	    if (cur == current_chunk)
+		  return 0;
+	    cur = cur[code_chunk_size-1].cptr;
+	    num -= 1;
+      }
+      return cur;
+}
+
+unsigned long codespace_index(vvp_code_t ptr)
+{
+      unsigned long base = 0;
+      for (vvp_code_t cur = first_chunk ; cur ; cur = cur[code_chunk_size-1].cptr) {
+	    if (ptr >= cur && ptr < cur+code_chunk_size)
+		  return base + (ptr - cur);
+	    if (cur == current_chunk)
+		  break;
+	    base += code_chunk_size;
+      }
+      return 0;
+}
+
+vvp_code_t codespace_at(unsigned long idx)
+{
+      vvp_code_t cur = codespace_chunk_(idx / code_chunk_size);
+      if (cur == 0)
+	    return codespace_null();
+      return cur + idx % code_chunk_size;
+}
+
 #ifdef CHECK_WITH_VALGRIND
 void codespace_delete(void)
 {
@@ -124,6 +124,11 @@ extern bool of_FORCE_VEC4_OFF_D(vthread_t thr, vvp_code_t code);
 extern bool of_FORCE_WR(vthread_t thr, vvp_code_t code);
 extern bool of_FORK(vthread_t thr, vvp_code_t code);
 extern bool of_FREE(vthread_t thr, vvp_code_t code);
+extern bool of_FUSED_DUP_PUSHI_CMPU_JMP1(vthread_t thr, vvp_code_t code);
+extern bool of_FUSED_LOAD_ADDI_STORE(vthread_t thr, vvp_code_t code);
+extern bool of_FUSED_LOAD_CMPIE_JMP0XZ(vthread_t thr, vvp_code_t code);
+extern bool of_FUSED_LOAD_CMPIU_JMP0XZ(vthread_t thr, vvp_code_t code);
+extern bool of_FUSED_LOAD_PUSHI_CMPU_JMP0XZ(vthread_t thr, vvp_code_t code);
 extern bool of_INV(vthread_t thr, vvp_code_t code);
 extern bool of_IX_ADD(vthread_t thr, vvp_code_t code);
 extern bool of_IX_GETV(vthread_t thr, vvp_code_t code);
@@ -284,6 +289,17 @@ struct vvp_code_s {
 	    vvp_code_t   cptr2;
 	    class ufunc_core*ufunc_core_ptr;
       };
+
+	/* The threaded interpreter dispatches through this instead
+	   of calling the opcode function. It is filled in by the
+	   vthread_prepare_code function once the design is loaded.
+	   When profiling superinstructions, this instead counts the
+	   times the instruction was executed. */
+      union {
+	    const void*thread_label;
+	    unsigned    thread_op;
+	    unsigned long exec_count;
+      };
 };
 
 /*
@@ -304,4 +320,20 @@ extern vvp_code_t codespace_allocate(void);
 extern vvp_code_t codespace_next(void);
 extern vvp_code_t codespace_null(void);
 
+/*
+ * Call the function for every instruction that has been allocated in
+ * the code space, including the links between chunks.
+ */
+extern void codespace_walk(void (*fun)(vvp_code_t));
+
+/*
+ * Convert between instruction addresses and indices into the code
+ * space. The index of an instruction is the same every time a design
+ * is loaded, so checkpoints use it to save program counters. The
+ * codespace_index function returns 0 (the ZOMBIE instruction) for an
+ * address that is not in the code space.
+ */
+extern unsigned long codespace_index(vvp_code_t ptr);
+extern vvp_code_t codespace_at(unsigned long idx);
+
 #endif /* IVL_codes_H */
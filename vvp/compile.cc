@@ -34,6 +34,10 @@
 # include  "schedule.h"
 # include  <iostream>
 # include  <list>
+# include  <map>
+# include  <vector>
+# include  <string>
+# include  <algorithm>
 # include  <cstdlib>
 # include  <cstring>
 # include  <cassert>
@@ -338,8 +342,8 @@ static symbol_table_t sym_vpi = 0;
 /*
  * If a functor parameter makes a forward reference to a functor, then
  * I need to save that reference and resolve it after the functors are
- * created. Use this structure to keep the unresolved references in an
- * unsorted singly linked list.
+ * created. Use this structure to keep the unresolved references in the
+ * resolv_list.
  *
  * The postpone_functor_input arranges for a functor input to be
  * resolved and connected at cleanup. This is used if the symbol is
@@ -348,6 +352,8 @@ static symbol_table_t sym_vpi = 0;
  */
 
 
+static void resolv_label_defined(const char*label);
+
 /*
  *  Add a functor to the symbol table
  */
@@ -357,6 +363,7 @@ void define_functor_symbol(const char*label, vvp_net_t*net)
       symbol_value_t val;
       val.net = net;
       sym_set_value(sym_functors, label, val);
+      resolv_label_defined(label);
 }
 
 static vvp_net_t*lookup_functor_symbol(const char*label)
@@ -427,12 +434,12 @@ vvp_net_t* vvp_net_lookup(const char*label)
 
 /*
  * The resolv_list_s is the base class for a symbol resolve action, and
- * the resolv_list is an unordered list of these resolve actions. Some
- * function creates an instance of a resolv_list_s object that
- * contains the data pertinent to that resolution request, and
- * executes it with the resolv_submit function. If the operation can
- * complete, then the resolv_submit deletes the object. Otherwise, it
- * pushes it onto the resolv_list for later processing.
+ * the resolv_list is a table of these resolve actions. Some function
+ * creates an instance of a resolv_list_s object that contains the
+ * data pertinent to that resolution request, and executes it with the
+ * resolv_submit function. If the operation can complete, then the
+ * resolv_submit deletes the object. Otherwise, it adds it to the
+ * resolv_list for later processing.
  *
  * Derived classes implement the resolve function to perform the
  * actual binding or resolution that the instance requires. If the
@@ -443,7 +450,19 @@ vvp_net_t* vvp_net_lookup(const char*label)
  * this call is its last chance. If it cannot complete the operation,
  * it must print an error message and return false.
  */
-static resolv_list_s*resolv_list = 0;
+static std::vector<resolv_list_s*> resolv_list;
+
+/*
+ * While compile_cleanup() sweeps the resolv_list, an item that cannot
+ * be resolved waits for its label to be defined by another item. The
+ * resolv_waiting table maps the label to the first waiting item, as
+ * the index in the resolv_list plus 1, and the resolv_chain links the
+ * items that wait for the same label. When the label is defined, the
+ * waiting items are moved to the resolv_ready list to be tried again.
+ */
+static symbol_table_t resolv_waiting = 0;
+static std::vector<size_t> resolv_chain;
+static std::vector<size_t> resolv_ready;
 
 resolv_list_s::~resolv_list_s()
 {
@@ -457,8 +476,39 @@ void resolv_submit(resolv_list_s*cur)
 	    return;
       }
 
-      cur->next = resolv_list;
-      resolv_list = cur;
+      resolv_list.push_back(cur);
+      resolv_chain.push_back(0);
+}
+
+static void resolv_label_defined(const char*label)
+{
+      if (resolv_waiting == 0)
+	    return;
+
+      symbol_value_t val = sym_get_value(resolv_waiting, label);
+      if (val.num == 0)
+	    return;
+
+      for (size_t cur = val.num ;  cur ;  cur = resolv_chain[cur-1])
+	    resolv_ready.push_back(cur-1);
+
+      val.num = 0;
+      sym_set_value(resolv_waiting, label, val);
+}
+
+void resolv_try(size_t idx)
+{
+      resolv_list_s*cur = resolv_list[idx];
+      if (cur->resolve()) {
+	    delete cur;
+	    resolv_list[idx] = 0;
+	    return;
+      }
+
+      symbol_value_t val = sym_get_value(resolv_waiting, cur->label_);
+      resolv_chain[idx] = val.num;
+      val.num = idx + 1;
+      sym_set_value(resolv_waiting, cur->label_, val);
 }
 
 
@@ -721,6 +771,190 @@ void compile_compiletf(struct __vpiSysTaskCall*obj)
       scheduled_compiletf.push_back(obj);
 }
 
+/*
+ * The superinstruction table lists the instruction sequences that
+ * compile_cleanup fuses into a single instruction. The pass writes
+ * the fused opcode over the first instruction of each sequence and
+ * leaves the rest in place, so labels in the middle of a sequence
+ * need no special care. Sequences are matched in table order, so if
+ * one sequence is the start of another, put the longer one first.
+ *
+ * The entries are the sequences that "-f profile" reports as the
+ * most executed ones. That report prints each sequence in the form
+ * of a table entry, with the times it ran in a comment, so the table
+ * can be extended from the report of a design. Each entry needs an
+ * of_FUSED_* implementation in vthread.cc, and only the last
+ * instruction of a sequence may jump or pause the thread.
+ */
+# define SUPEROP_MAX 4
+
+struct superop_table_s {
+      vvp_code_fun opcode;
+      const char*seq[SUPEROP_MAX];
+};
+
+static const struct superop_table_s superop_table[] = {
+      { of_FUSED_LOAD_ADDI_STORE,
+	{ "%load/vec4", "%addi", "%store/vec4" } },
+      { of_FUSED_LOAD_PUSHI_CMPU_JMP0XZ,
+	{ "%load/vec4", "%pushi/vec4", "%cmp/u", "%jmp/0xz" } },
+      { of_FUSED_DUP_PUSHI_CMPU_JMP1,
+	{ "%dup/vec4", "%pushi/vec4", "%cmp/u", "%jmp/1" } },
+      { of_FUSED_LOAD_CMPIU_JMP0XZ,
+	{ "%load/vec4", "%cmpi/u", "%jmp/0xz" } },
+      { of_FUSED_LOAD_CMPIE_JMP0XZ,
+	{ "%load/vec4", "%cmpi/e", "%jmp/0xz" } },
+      { 0, { 0, 0, 0, 0 } }
+};
+
+static const unsigned superop_count =
+		     sizeof(superop_table)/sizeof(*superop_table) - 1;
+
+enum superop_mode_e { SUPEROP_OFF, SUPEROP_ON, SUPEROP_PROFILE };
+static enum superop_mode_e superop_mode = SUPEROP_OFF;
+bool superop_profile_flag = false;
+
+bool compile_set_superop(const char*name)
+{
+      if (strcmp(name, "on") == 0) {
+	    superop_mode = SUPEROP_ON;
+      } else if (strcmp(name, "off") == 0) {
+	    superop_mode = SUPEROP_OFF;
+      } else if (strcmp(name, "profile") == 0) {
+	    superop_mode = SUPEROP_PROFILE;
+      } else {
+	    return false;
+      }
+
+      superop_profile_flag = superop_mode == SUPEROP_PROFILE;
+      vthread_set_profile(superop_profile_flag);
+      return true;
+}
+
+static vvp_code_fun superop_codes[superop_count][SUPEROP_MAX];
+static unsigned long count_superops = 0;
+
+static void superop_fuse(vvp_code_t cp)
+{
+      for (unsigned idx = 0 ;  idx < superop_count ;  idx += 1) {
+	    const vvp_code_fun*seq = superop_codes[idx];
+
+	      /* The code space is zero filled past the last
+		 instruction, and no sequence contains the
+		 %chunk_link, so this never runs off the end. */
+	    unsigned len = 0;
+	    while (len < SUPEROP_MAX && seq[len] && cp[len].opcode == seq[len])
+		  len += 1;
+
+	    if (len < SUPEROP_MAX && seq[len])
+		  continue;
+
+	    cp->opcode = superop_table[idx].opcode;
+	    count_superops += 1;
+	    return;
+      }
+}
+
+static void compile_superops(void)
+{
+      for (unsigned idx = 0 ;  idx < superop_count ;  idx += 1) {
+	    for (unsigned sdx = 0 ;  sdx < SUPEROP_MAX ;  sdx += 1) {
+		  const char*mnem = superop_table[idx].seq[sdx];
+		  if (mnem == 0) {
+			superop_codes[idx][sdx] = 0;
+			continue;
+		  }
+
+		  const struct opcode_table_s*op = (const struct opcode_table_s*)
+			bsearch(mnem, opcode_table, opcode_count,
+				sizeof(struct opcode_table_s), &opcode_compare);
+		  assert(op);
+		  superop_codes[idx][sdx] = op->opcode;
+	    }
+      }
+
+      codespace_walk(&superop_fuse);
+
+      if (verbose_flag) {
+	    fprintf(stderr, " ... Fused %lu superinstructions\n",
+		    count_superops);
+	    fflush(stderr);
+      }
+}
+
+/*
+ * In profile mode, every instruction counts in its exec_count the
+ * times it was executed. Count every sequence of 2 or more
+ * instructions by the least executed instruction in the sequence,
+ * which is the most times the whole sequence could have run. A
+ * sequence ends at any instruction that can jump.
+ */
+static std::map<vvp_code_fun,const struct opcode_table_s*> superop_ops;
+static std::map<std::string,unsigned long> superop_profile;
+
+static void superop_count_seq(vvp_code_t cp)
+{
+      if (cp->opcode == &of_CHUNK_LINK)
+	    return;
+
+      std::string key;
+      unsigned long weight = cp->exec_count;
+
+      for (unsigned len = 0 ;  len < SUPEROP_MAX ;  len += 1) {
+	    if (weight == 0)
+		  break;
+
+	    std::map<vvp_code_fun,const struct opcode_table_s*>::const_iterator
+		  cur = superop_ops.find(cp[len].opcode);
+	    if (cur == superop_ops.end())
+		  break;
+
+	    if (cp[len].exec_count < weight)
+		  weight = cp[len].exec_count;
+	    if (weight == 0)
+		  break;
+
+	    if (len > 0)
+		  key += ", ";
+	    key += "\"";
+	    key += cur->second->mnemonic;
+	    key += "\"";
+
+	    if (len > 0)
+		  superop_profile[key] += weight;
+
+	    const enum operand_e*argt = cur->second->argt;
+	    if (argt[0] == OA_CODE_PTR || argt[0] == OA_CODE_PTR2)
+		  break;
+      }
+}
+
+static bool superop_weight_more(const std::pair<std::string,unsigned long>&a,
+				const std::pair<std::string,unsigned long>&b)
+{
+      return a.second > b.second;
+}
+
+void compile_superop_report(FILE*fd)
+{
+      assert(superop_profile_flag);
+
+      for (unsigned idx = 0 ;  idx < opcode_count ;  idx += 1)
+	    superop_ops[opcode_table[idx].opcode] = opcode_table + idx;
+
+      codespace_walk(&superop_count_seq);
+
+      std::vector<std::pair<std::string,unsigned long> >
+	    list (superop_profile.begin(), superop_profile.end());
+      std::stable_sort(list.begin(), list.end(), &superop_weight_more);
+
+      fprintf(fd, "Superinstruction profile (most executed first):\n");
+      for (unsigned idx = 0 ;  idx < list.size() && idx < 20 ;  idx += 1) {
+	    fprintf(fd, "      { 0, /* %lu times */\n\t{ %s } },\n",
+		    list[idx].second, list[idx].first.c_str());
+      }
+}
+
 /*
  * When parsing is otherwise complete, this function is called to do
  * the final stuff. Clean up deferred linking here.
@@ -728,37 +962,44 @@ void compile_compiletf(struct __vpiSysTaskCall*obj)
 
 void compile_cleanup(void)
 {
-      int lnerrs = -1;
       int nerrs = 0;
-      int last;
 
       if (verbose_flag) {
 	    fprintf(stderr, " ... Linking\n");
 	    fflush(stderr);
       }
 
-      do {
-	    resolv_list_s *res = resolv_list;
-	    resolv_list = 0x0;
-	    last = nerrs == lnerrs;
-	    lnerrs = nerrs;
-	    nerrs = 0;
-	    while (res) {
-		  resolv_list_s *cur = res;
-		  res = res->next;
-		  if (cur->resolve(last))
-			delete cur;
-		  else {
-			nerrs++;
-			cur->next = resolv_list;
-			resolv_list = cur;
-		  }
+	/* Sweep the unresolved items once. Most of them resolve now
+	   that the whole design has been parsed. The rest wait for
+	   their label, which may be defined by a later item, and are
+	   tried again when it is. */
+      resolv_waiting = new_symbol_table();
+      for (size_t idx = 0 ;  idx < resolv_list.size() ;  idx += 1) {
+	    resolv_try(idx);
+	    while (! resolv_ready.empty()) {
+		  size_t cur = resolv_ready.back();
+		  resolv_ready.pop_back();
+		  resolv_try(cur);
 	    }
-	    if (nerrs && last)
-		  fprintf(stderr,
-			  "compile_cleanup: %d unresolved items\n",
-			  nerrs);
-      } while (nerrs && !last);
+      }
+      delete_symbol_table(resolv_waiting);
+      resolv_waiting = 0;
+
+	/* Anything that is left cannot be resolved. Give the items a
+	   last chance so that they print their error messages. */
+      for (size_t idx = 0 ;  idx < resolv_list.size() ;  idx += 1) {
+	    resolv_list_s*cur = resolv_list[idx];
+	    if (cur == 0)
+		  continue;
+	    if (! cur->resolve(true))
+		  nerrs += 1;
+	    delete cur;
+      }
+      resolv_list.clear();
+      resolv_chain.clear();
+
+      if (nerrs)
+	    fprintf(stderr, "compile_cleanup: %d unresolved items\n", nerrs);
 
       compile_errors += nerrs;
 
@@ -783,9 +1024,16 @@ void compile_cleanup(void)
 
       delete_udp_symbols();
 
+      if (superop_mode == SUPEROP_ON)
+	    compile_superops();
+
       compile_island_cleanup();
       compile_array_cleanup();
 
+	/* The nets are all linked now. */
+      if (schedule_eval_levelized())
+	    vvp_net_levelize();
+
       if (verbose_flag) {
 	    fprintf(stderr, " ... Compiletf functions\n");
 	    fflush(stderr);
@@ -810,6 +1058,7 @@ void compile_vpi_symbol(const char*label, vpiHandle obj)
       symbol_value_t val;
       val.ptr = obj;
       sym_set_value(sym_vpi, label, val);
+      resolv_label_defined(label);
 }
 
 /*
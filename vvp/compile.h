@@ -50,6 +50,21 @@ extern void compile_cleanup(void);
 
 extern bool verbose_flag;
 
+/*
+ * Select what compile_cleanup does with the common instruction
+ * sequences listed in its superinstruction table. "on" fuses them
+ * into superinstructions, "off" (the default) leaves the code alone,
+ * and "profile" leaves the code alone but counts instructions as
+ * they execute. In that last case, compile_superop_report writes
+ * the sequences that were executed most, in the form of entries for
+ * the superinstruction table, and only runs when the
+ * superop_profile_flag is set. The compile_set_superop function
+ * returns false if the name is not known.
+ */
+extern bool compile_set_superop(const char*name);
+extern bool superop_profile_flag;
+extern void compile_superop_report(FILE*fd);
+
 /*
  * If this file opened, then write debug information to this
  * file. This is used for debugging the VVP runtime itself.
@@ -300,7 +315,7 @@ extern void compile_param_real(char*label, char*name, char*value,
  * that contains the data pertinent to that resolution request, and
  * executes it with the resolv_submit function. If the operation can
  * complete, then the resolv_submit deletes the object. Otherwise, it
- * pushes it onto the resolv_list for later processing.
+ * adds it to the resolv_list for later processing.
  *
  * Derived classes implement the resolve function to perform the
  * actual binding or resolution that the instance requires. If the
@@ -314,9 +329,7 @@ extern void compile_param_real(char*label, char*name, char*value,
 class resolv_list_s {
 
     public:
-      explicit resolv_list_s(char*lab) : label_(lab) {
-	    next = NULL;
-      }
+      explicit resolv_list_s(char*lab) : label_(lab) { }
       virtual ~resolv_list_s();
       virtual bool resolve(bool mes = false) = 0;
 
@@ -324,13 +337,13 @@ class resolv_list_s {
       const char*label() const { return label_; }
 
     private:
-      friend void resolv_submit(class resolv_list_s*cur);
-      friend void compile_cleanup(void);
+      friend void resolv_try(size_t idx);
 
       char*label_;
-      class resolv_list_s*next;
 };
 
+extern void resolv_submit(resolv_list_s*cur);
+
 /*
  * This function schedules a lookup of an indexed label. The ref
  * points to the vvp_net_t that receives the result. The result may
@@ -19,6 +19,7 @@
 
 # include  "compile.h"
 # include  "vvp_net.h"
+# include  "checkpoint.h"
 # include  <cstdlib>
 # include  <iostream>
 # include  <cassert>
@@ -35,12 +36,19 @@ vvp_fun_concat::vvp_fun_concat(unsigned w0, unsigned w1,
 
       for (unsigned idx = 0 ;  idx < val_.size() ;  idx += 1)
 	    val_.set_bit(idx, BIT4_Z);
+
+      kind_ = KIND_CONCAT;
 }
 
 vvp_fun_concat::~vvp_fun_concat()
 {
 }
 
+void vvp_fun_concat::checkpoint(vvp_checkpoint_t&cp)
+{
+      cp.io(val_);
+}
+
 void vvp_fun_concat::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
                                vvp_context_t)
 {
@@ -57,9 +65,7 @@ void vvp_fun_concat::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
       for (unsigned idx = 0 ;  idx < pdx ;  idx += 1)
 	    off += wid_[idx];
 
-      for (unsigned idx = 0 ;  idx < wid_[pdx] ;  idx += 1) {
-	    val_.set_bit(off+idx, bit.value(idx));
-      }
+      val_.set_vec(off, bit);
 
       port.ptr()->send_vec4(val_, 0);
 }
@@ -128,6 +134,11 @@ vvp_fun_concat8::~vvp_fun_concat8()
 {
 }
 
+void vvp_fun_concat8::checkpoint(vvp_checkpoint_t&cp)
+{
+      cp.io(val_);
+}
+
 void vvp_fun_concat8::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
 				vvp_context_t)
 {
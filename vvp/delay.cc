@@ -19,6 +19,7 @@
 
 #include "delay.h"
 #include "schedule.h"
+#include "checkpoint.h"
 #include "vpi_priv.h"
 #include "config.h"
 #ifdef CHECK_WITH_VALGRIND
@@ -71,6 +72,15 @@ vvp_delay_t::~vvp_delay_t()
 {
 }
 
+void vvp_delay_t::checkpoint(vvp_checkpoint_t&cp)
+{
+      cp.io(rise_);
+      cp.io(fall_);
+      cp.io(decay_);
+      cp.io(min_delay_);
+      cp.io(ignore_decay_);
+}
+
 vvp_time64_t vvp_delay_t::get_delay(vvp_bit4_t from, vvp_bit4_t to)
 {
       switch (from) {
@@ -181,6 +191,75 @@ vvp_fun_delay::~vvp_fun_delay()
 	    delete cur;
 }
 
+/*
+ * The pending output values are kept in the list_ of this functor,
+ * and each has a generic event in the scheduler that points back to
+ * this functor. Claim those events so that they are saved with this
+ * net, and save the list with the time and kind of each value.
+ */
+void vvp_fun_delay::checkpoint(vvp_checkpoint_t&cp)
+{
+      int type = type_;
+      delay_.checkpoint(cp);
+      cp.io(type);
+      cp.io(initial_);
+      cp.io(cur_vec4_);
+      cp.io(cur_vec8_);
+      cp.io(cur_real_);
+      type_ = (delay_type_t)type;
+
+      unsigned count = 0;
+      if (list_) {
+	    struct event_*cur = list_;
+	    do {
+		  count += 1;
+		  cur = cur->next;
+	    } while (cur != list_);
+      }
+      cp.io(count);
+
+      struct event_*cur = list_? list_->next : 0;
+      for (unsigned idx = 0 ; idx < count ; idx += 1) {
+	    unsigned long long sim_time = 0;
+	    int kind = 0;
+	    if (! cp.restoring()) {
+		  sim_time = cur->sim_time;
+		  if (cur->run_run_ptr == &vvp_fun_delay::run_run_vec8_)
+			kind = 1;
+		  else if (cur->run_run_ptr == &vvp_fun_delay::run_run_real_)
+			kind = 2;
+	    }
+	    cp.io(sim_time);
+	    cp.io(kind);
+
+	    if (cp.restoring()) {
+		  cur = new event_(sim_time);
+		  switch (kind) {
+		      case 1:
+			cur->run_run_ptr = &vvp_fun_delay::run_run_vec8_;
+			break;
+		      case 2:
+			cur->run_run_ptr = &vvp_fun_delay::run_run_real_;
+			break;
+		      default:
+			cur->run_run_ptr = &vvp_fun_delay::run_run_vec4_;
+			break;
+		  }
+	    }
+
+	    cp.io(cur->ptr_vec4);
+	    cp.io(cur->ptr_vec8);
+	    cp.io(cur->ptr_real);
+
+	    if (cp.restoring())
+		  enqueue_(cur);
+	    else
+		  cur = cur->next;
+      }
+
+      cp.claim_event(this);
+}
+
 bool vvp_fun_delay::clean_pulse_events_(vvp_time64_t use_delay,
                                         const vvp_vector4_t&bit)
 {
@@ -528,6 +607,12 @@ vvp_fun_modpath::~vvp_fun_modpath()
       }
 }
 
+void vvp_fun_modpath::checkpoint(vvp_checkpoint_t&cp)
+{
+      cp.io(cur_vec4_);
+      cp.claim_event(this);
+}
+
 void vvp_fun_modpath::add_modpath_src(vvp_fun_modpath_src*that, bool ifnone)
 {
       assert(that->next_ == 0);
@@ -689,6 +774,14 @@ vvp_fun_modpath_src::~vvp_fun_modpath_src()
 {
 }
 
+void vvp_fun_modpath_src::checkpoint(vvp_checkpoint_t&cp)
+{
+      for (unsigned idx = 0 ;  idx < 12 ;  idx += 1)
+	    cp.io(delay_[idx]);
+      cp.io(wake_time_);
+      cp.io(condition_flag_);
+}
+
 void vvp_fun_modpath_src::get_delay12(vvp_time64_t val[12]) const
 {
       for (unsigned idx = 0 ;  idx < 12 ;  idx += 1)
@@ -732,6 +825,12 @@ vvp_fun_modpath_edge::vvp_fun_modpath_edge(vvp_time64_t del[12],
       negedge_ = neg;
 }
 
+void vvp_fun_modpath_edge::checkpoint(vvp_checkpoint_t&cp)
+{
+      vvp_fun_modpath_src::checkpoint(cp);
+      cp.io(old_value_);
+}
+
 bool vvp_fun_modpath_edge::test_vec4(const vvp_vector4_t&bit)
 {
       vvp_bit4_t tmp = old_value_;
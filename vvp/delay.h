@@ -51,6 +51,8 @@ class vvp_delay_t {
       void set_decay(vvp_time64_t val);
       void set_ignore_decay();
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       vvp_time64_t rise_, fall_, decay_;
       vvp_time64_t min_delay_;
@@ -105,6 +107,8 @@ class vvp_fun_delay  : public vvp_net_fun_t, private vvp_gen_event_s {
       void recv_vec8_pv(vvp_net_ptr_t ptr, const vvp_vector8_t&bit,
 			unsigned base, unsigned wid, unsigned vwid);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       virtual void run_run();
 
@@ -176,6 +180,8 @@ class vvp_fun_modpath  : public vvp_net_fun_t, private vvp_gen_event_s {
       void recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
                      vvp_context_t);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       virtual void run_run();
 
@@ -209,6 +215,8 @@ class vvp_fun_modpath_src  : public vvp_net_fun_t {
       void get_delay12(vvp_time64_t out[12]) const;
       void put_delay12(const vvp_time64_t in[12]);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
 	// FIXME: Needs to be a 12-value array
       vvp_time64_t delay_[12];
@@ -230,6 +238,8 @@ class vvp_fun_modpath_edge  : public vvp_fun_modpath_src {
 
       bool test_vec4(const vvp_vector4_t&bit);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       vvp_bit4_t old_value_;
       bool posedge_;
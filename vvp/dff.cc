@@ -20,6 +20,7 @@
 # include  "compile.h"
 # include  "schedule.h"
 # include  "dff.h"
+# include  "checkpoint.h"
 # include  <climits>
 # include  <cstdio>
 # include  <cassert>
@@ -47,6 +48,23 @@ vvp_dff::~vvp_dff()
 {
 }
 
+void vvp_dff::checkpoint(vvp_checkpoint_t&cp)
+{
+      vvp_bit4_t clk_active = clk_active_;
+      vvp_bit4_t clk = clk_;
+      vvp_bit4_t ena = ena_;
+      vvp_bit4_t asc = asc_;
+      cp.io(clk_active);
+      cp.io(clk);
+      cp.io(ena);
+      cp.io(asc);
+      cp.io(d_);
+      clk_active_ = clk_active;
+      clk_ = clk;
+      ena_ = ena;
+      asc_ = asc;
+}
+
 vvp_dff_aclr::vvp_dff_aclr(unsigned width, bool negedge)
 : vvp_dff(width, negedge)
 {
@@ -48,6 +48,8 @@ class vvp_dff : public vvp_net_fun_t {
 			unsigned base, unsigned wid, unsigned vwid,
                         vvp_context_t ctx);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       virtual void recv_async(vvp_net_ptr_t port);
 
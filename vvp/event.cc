@@ -22,6 +22,7 @@
 # include  "vthread.h"
 # include  "schedule.h"
 # include  "vpi_priv.h"
+# include  "checkpoint.h"
 # include  "config.h"
 # include  <cstring>
 # include  <cassert>
@@ -52,6 +53,19 @@ void waitable_hooks_s::run_waiting_threads_(vthread_t&threads)
       vthread_schedule_list(tmp);
 }
 
+/*
+ * The non-blocking event controls hold values that are bound for
+ * nets and arrays at some later trigger of the event. They are not
+ * saved, so a checkpoint with any pending loses them.
+ */
+void waitable_hooks_s::checkpoint_threads_(vvp_checkpoint_t&cp, vthread_t&threads)
+{
+      if (event_ctls && ! cp.restoring())
+	    cp.unsupported("pending non-blocking event control");
+
+      vthread_checkpoint_list(cp, threads);
+}
+
 evctl::evctl(unsigned long ecount)
 {
       ecount_ = ecount;
@@ -247,6 +261,13 @@ vvp_fun_edge_sa::~vvp_fun_edge_sa()
 {
 }
 
+void vvp_fun_edge_sa::checkpoint(vvp_checkpoint_t&cp)
+{
+      for (unsigned idx = 0 ; idx < 4 ; idx += 1)
+	    cp.io(bits_[idx]);
+      checkpoint_threads_(cp, threads_);
+}
+
 vthread_t vvp_fun_edge_sa::add_waiting_thread(vthread_t thread)
 {
       vthread_t tmp = threads_;
@@ -422,6 +443,15 @@ vvp_fun_anyedge_sa::~vvp_fun_anyedge_sa()
 {
 }
 
+void vvp_fun_anyedge_sa::checkpoint(vvp_checkpoint_t&cp)
+{
+      for (unsigned idx = 0 ; idx < 4 ; idx += 1) {
+	    cp.io(bits_[idx]);
+	    cp.io(bitsr_[idx]);
+      }
+      checkpoint_threads_(cp, threads_);
+}
+
 vthread_t vvp_fun_anyedge_sa::add_waiting_thread(vthread_t thread)
 {
       vthread_t tmp = threads_;
@@ -573,6 +603,11 @@ vvp_fun_event_or_sa::~vvp_fun_event_or_sa()
 {
 }
 
+void vvp_fun_event_or_sa::checkpoint(vvp_checkpoint_t&cp)
+{
+      checkpoint_threads_(cp, threads_);
+}
+
 vthread_t vvp_fun_event_or_sa::add_waiting_thread(vthread_t thread)
 {
       vthread_t tmp = threads_;
@@ -669,6 +704,11 @@ vvp_named_event_sa::~vvp_named_event_sa()
 {
 }
 
+void vvp_named_event_sa::checkpoint(vvp_checkpoint_t&cp)
+{
+      checkpoint_threads_(cp, threads_);
+}
+
 vthread_t vvp_named_event_sa::add_waiting_thread(vthread_t thread)
 {
       vthread_t tmp = threads_;
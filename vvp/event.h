@@ -131,6 +131,8 @@ struct waitable_hooks_s {
 
     protected:
       void run_waiting_threads_(vthread_t&threads);
+	// Save or restore the list of threads waiting on this event.
+      void checkpoint_threads_(vvp_checkpoint_t&cp, vthread_t&threads);
 };
 
 /*
@@ -187,6 +189,8 @@ class vvp_fun_edge_sa : public vvp_fun_edge {
 			unsigned base, unsigned wid, unsigned vwid,
 			vvp_context_t context);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       vthread_t threads_;
 };
@@ -263,6 +267,8 @@ class vvp_fun_anyedge_sa : public vvp_fun_anyedge {
       void recv_real(vvp_net_ptr_t port, double bit,
                      vvp_context_t context);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       vthread_t threads_;
 };
@@ -320,6 +326,8 @@ class vvp_fun_event_or_sa : public vvp_fun_event_or {
       void recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
                      vvp_context_t context);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       vthread_t threads_;
 };
@@ -378,6 +386,8 @@ class vvp_named_event_sa : public vvp_named_event {
       void recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
                      vvp_context_t);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       vthread_t threads_;
 };
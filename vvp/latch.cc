@@ -20,6 +20,7 @@
 # include  "compile.h"
 # include  "schedule.h"
 # include  "latch.h"
+# include  "checkpoint.h"
 # include  <climits>
 # include  <cstdio>
 # include  <cassert>
@@ -39,6 +40,12 @@ vvp_latch::~vvp_latch()
 {
 }
 
+void vvp_latch::checkpoint(vvp_checkpoint_t&cp)
+{
+      cp.io(en_);
+      cp.io(d_);
+}
+
 void vvp_latch::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
                           vvp_context_t)
 {
@@ -41,6 +41,8 @@ class vvp_latch : public vvp_net_fun_t {
 			unsigned base, unsigned wid, unsigned vwid,
                         vvp_context_t ctx);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       vvp_bit4_t en_;
       vvp_vector4_t d_;
@@ -24,6 +24,7 @@
 # include  "schedule.h"
 # include  "delay.h"
 # include  "statistics.h"
+# include  "checkpoint.h"
 # include  <iostream>
 # include  <cstring>
 # include  <cassert>
@@ -32,14 +33,42 @@
 vvp_fun_boolean_::vvp_fun_boolean_(unsigned wid)
 {
       net_ = 0;
+      level_ = 0;
       for (unsigned idx = 0 ;  idx < 4 ;  idx += 1)
 	    input_[idx] = vvp_vector4_t(wid, BIT4_Z);
+      kind_ = KIND_BOOLEAN;
+}
+
+void vvp_fun_boolean_::schedule_run_(vvp_net_t*net)
+{
+      if (net_ != 0)
+	    return;
+
+      net_ = net;
+      if (level_)
+	    schedule_levelized(this, level_);
+      else
+	    schedule_functor(this);
+}
+
+bool vvp_fun_boolean_::inputs_match_() const
+{
+      unsigned wid = input_[0].size();
+      return input_[1].size() == wid
+	  && input_[2].size() == wid
+	  && input_[3].size() == wid;
 }
 
 vvp_fun_boolean_::~vvp_fun_boolean_()
 {
 }
 
+void vvp_fun_boolean_::checkpoint(vvp_checkpoint_t&cp)
+{
+      for (unsigned idx = 0 ; idx < 4 ; idx += 1)
+	    cp.io(input_[idx]);
+}
+
 void vvp_fun_boolean_::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                                  vvp_context_t)
 {
@@ -48,10 +77,7 @@ void vvp_fun_boolean_::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
 	    return;
 
       input_[port] = bit;
-      if (net_ == 0) {
-	    net_ = ptr.ptr();
-	    schedule_functor(this);
-      }
+      schedule_run_(ptr.ptr());
 }
 
 void vvp_fun_boolean_::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
@@ -68,10 +94,7 @@ void vvp_fun_boolean_::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
       if (flag == false)
 	    return;
 
-      if (net_ == 0) {
-	    net_ = ptr.ptr();
-	    schedule_functor(this);
-      }
+      schedule_run_(ptr.ptr());
 }
 
 vvp_fun_and::vvp_fun_and(unsigned wid, bool invert)
@@ -91,6 +114,15 @@ void vvp_fun_and::run_run()
 
       vvp_vector4_t result (input_[0]);
 
+      if (inputs_match_()) {
+	    for (unsigned pdx = 1 ;  pdx < 4 ;  pdx += 1)
+		  result &= input_[pdx];
+	    if (invert_)
+		  result.invert();
+	    ptr->send_vec4(result, 0);
+	    return;
+      }
+
       for (unsigned idx = 0 ;  idx < result.size() ;  idx += 1) {
 	    vvp_bit4_t bitbit = result.value(idx);
 	    for (unsigned pdx = 1 ;  pdx < 4 ;  pdx += 1) {
@@ -121,6 +153,11 @@ vvp_fun_buf::~vvp_fun_buf()
 {
 }
 
+void vvp_fun_buf::checkpoint(vvp_checkpoint_t&cp)
+{
+      cp.io(input_);
+}
+
 /*
  * The buf functor is very simple--change the z bits to x bits in the
  * vector it passes, and propagate the result.
@@ -234,6 +271,15 @@ vvp_fun_muxr::~vvp_fun_muxr()
 {
 }
 
+void vvp_fun_muxr::checkpoint(vvp_checkpoint_t&cp)
+{
+      int sel = select_;
+      cp.io(a_);
+      cp.io(b_);
+      cp.io(sel);
+      select_ = (sel_type)sel;
+}
+
 void vvp_fun_muxr::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                              vvp_context_t)
 {
@@ -326,6 +372,16 @@ vvp_fun_muxz::~vvp_fun_muxz()
 {
 }
 
+void vvp_fun_muxz::checkpoint(vvp_checkpoint_t&cp)
+{
+      int sel = select_;
+      cp.io(a_);
+      cp.io(b_);
+      cp.io(sel);
+      cp.io(has_run_);
+      select_ = (sel_type)sel;
+}
+
 void vvp_fun_muxz::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                              vvp_context_t)
 {
@@ -448,6 +504,11 @@ vvp_fun_not::~vvp_fun_not()
 {
 }
 
+void vvp_fun_not::checkpoint(vvp_checkpoint_t&cp)
+{
+      cp.io(input_);
+}
+
 /*
  * The not functor is very simple--change the z bits to x bits in the
  * vector it passes, and propagate the inverted result.
@@ -515,6 +576,15 @@ void vvp_fun_or::run_run()
 
       vvp_vector4_t result (input_[0]);
 
+      if (inputs_match_()) {
+	    for (unsigned pdx = 1 ;  pdx < 4 ;  pdx += 1)
+		  result |= input_[pdx];
+	    if (invert_)
+		  result.invert();
+	    ptr->send_vec4(result, 0);
+	    return;
+      }
+
       for (unsigned idx = 0 ;  idx < result.size() ;  idx += 1) {
 	    vvp_bit4_t bitbit = result.value(idx);
 	    for (unsigned pdx = 1 ;  pdx < 4 ;  pdx += 1) {
@@ -551,6 +621,15 @@ void vvp_fun_xor::run_run()
 
       vvp_vector4_t result (input_[0]);
 
+      if (inputs_match_()) {
+	    for (unsigned pdx = 1 ;  pdx < 4 ;  pdx += 1)
+		  result ^= input_[pdx];
+	    if (invert_)
+		  result.invert();
+	    ptr->send_vec4(result, 0);
+	    return;
+      }
+
       for (unsigned idx = 0 ;  idx < result.size() ;  idx += 1) {
 	    vvp_bit4_t bitbit = result.value(idx);
 	    for (unsigned pdx = 1 ;  pdx < 4 ;  pdx += 1) {
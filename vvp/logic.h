@@ -38,9 +38,25 @@ class vvp_fun_boolean_ : public vvp_net_fun_t, protected vvp_gen_event_s {
 			unsigned base, unsigned wid, unsigned vwid,
                         vvp_context_t);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
+	// In the levelized evaluation mode, the functors that are
+	// not in a feedback loop get a level that is not 0.
+      unsigned level() const { return level_; }
+      void set_level(unsigned lev) { level_ = lev; }
+
     protected:
+	// If all the inputs are as wide as the first, the result
+	// can be calculated a word at a time.
+      bool inputs_match_() const;
+
       vvp_vector4_t input_[4];
       vvp_net_t*net_;
+
+    private:
+      void schedule_run_(vvp_net_t*net);
+
+      unsigned level_;
 };
 
 class vvp_fun_and  : public vvp_fun_boolean_ {
@@ -72,6 +88,8 @@ class vvp_fun_buf: public vvp_net_fun_t, private vvp_gen_event_s {
 			unsigned base, unsigned wid, unsigned vwid,
                         vvp_context_t);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       void run_run();
 
@@ -138,6 +156,8 @@ class vvp_fun_muxz : public vvp_net_fun_t, private vvp_gen_event_s {
 			unsigned base, unsigned wid, unsigned vwid,
                         vvp_context_t);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       void run_run();
 
@@ -160,6 +180,8 @@ class vvp_fun_muxr : public vvp_net_fun_t, private vvp_gen_event_s {
       void recv_real(vvp_net_ptr_t p, double bit,
                      vvp_context_t);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       void run_run();
 
@@ -182,6 +204,8 @@ class vvp_fun_not: public vvp_net_fun_t, private vvp_gen_event_s {
 			unsigned base, unsigned wid, unsigned vwid,
                         vvp_context_t);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       void run_run();
 
@@ -27,6 +27,9 @@
 # include  "statistics.h"
 # include  "vvp_cleanup.h"
 # include  "vvp_object.h"
+# include  "checkpoint.h"
+# include  "profile.h"
+# include  "activity.h"
 # include  <cstdio>
 # include  <cstdlib>
 # include  <cstring>
@@ -315,11 +318,47 @@ int main(int argc, char*argv[])
         /* For non-interactive runs we do not want to run the interactive
          * debugger, so make $stop just execute a $finish. */
       stop_is_finish = false;
-      while ((opt = getopt(argc, argv, "+hil:M:m:nNsvV")) != EOF) switch (opt) {
+      while ((opt = getopt(argc, argv, "+ac:d:e:f:hil:M:m:nNp:q:r:svV")) != EOF) switch (opt) {
+	  case 'a':
+	    activity_flag = true;
+	    break;
+	  case 'c':
+	    if (! checkpoint_set_periodic(optarg)) {
+		  fprintf(stderr, "%s: Invalid checkpoint spec \"%s\".\n",
+			  argv[0], optarg);
+		  flag_errors += 1;
+	    }
+	    break;
+	  case 'd':
+	    if (! vthread_set_dispatch(optarg)) {
+		  fprintf(stderr, "%s: Unknown thread dispatch \"%s\".\n",
+			  argv[0], optarg);
+		  flag_errors += 1;
+	    }
+	    break;
+	  case 'e':
+	    if (! schedule_set_eval(optarg)) {
+		  fprintf(stderr, "%s: Unknown evaluation mode \"%s\".\n",
+			  argv[0], optarg);
+		  flag_errors += 1;
+	    }
+	    break;
+	  case 'f':
+	    if (! compile_set_superop(optarg)) {
+		  fprintf(stderr, "%s: Unknown superinstruction mode \"%s\".\n",
+			  argv[0], optarg);
+		  flag_errors += 1;
+	    }
+	    break;
          case 'h':
            fprintf(stderr,
                    "Usage: vvp [options] input-file [+plusargs...]\n"
                    "Options:\n"
+                   " -a             Count the net and event activity.\n"
+                   " -c period:file Save a checkpoint every period ticks.\n"
+                   " -d dispatch    Thread interpreter to use (call or threaded).\n"
+                   " -e eval        Net evaluation (event or levelized).\n"
+                   " -f fuse        Superinstructions (on, off or profile).\n"
                    " -h             Print this help message.\n"
                    " -i             Interactive mode (unbuffered stdio).\n"
                    " -l file        Logfile, '-' for <stderr>\n"
@@ -328,6 +367,9 @@ int main(int argc, char*argv[])
                    " -m module      Load vpi module.\n"
 		   " -n             Non-interactive ($stop = $finish).\n"
                    " -N             Same as -n, but exit code is 1 instead of 0\n"
+                   " -p file        Write a sampling profile to the file.\n"
+                   " -q queue       Time queue to use (list or wheel).\n"
+                   " -r file        Restart from a checkpoint file.\n"
 		   " -s             $stop right away.\n"
                    " -v             Verbose progress messages.\n"
                    " -V             Print the version information.\n" );
@@ -356,6 +398,24 @@ int main(int argc, char*argv[])
             stop_is_finish = true;
             stop_is_finish_exit_code = 1;
             break;
+	  case 'p':
+	    if (! profile_set_output(optarg))
+		  flag_errors += 1;
+	    break;
+	  case 'q':
+	    if (! schedule_set_time_queue(optarg)) {
+		  fprintf(stderr, "%s: Unknown time queue \"%s\".\n",
+			  argv[0], optarg);
+		  flag_errors += 1;
+	    }
+	    break;
+	  case 'r':
+	    if (! checkpoint_set_restore(optarg)) {
+		  fprintf(stderr, "%s: Unable to restart from \"%s\".\n",
+			  argv[0], optarg);
+		  flag_errors += 1;
+	    }
+	    break;
 	  case 's':
 	    schedule_stop(0);
 	    break;
@@ -407,6 +467,7 @@ int main(int argc, char*argv[])
       }
 
       design_path = argv[optind];
+      checkpoint_set_design(design_path);
 
 	/* This is needed to get the MCD I/O routines ready for
 	   anything. It is done early because it is plausible that the
@@ -458,6 +519,7 @@ int main(int argc, char*argv[])
       }
 
       compile_cleanup();
+      vthread_prepare_code();
 
       if (compile_errors > 0) {
 	    vpi_mcd_printf(1, "%s: Program not runnable, %u errors.\n",
@@ -470,6 +532,9 @@ int main(int argc, char*argv[])
 	    vpi_mcd_printf(1, " ... %8lu functors (net_fun pool=%zu bytes)\n",
 			   count_functors, vvp_net_fun_t::heap_total());
 	    vpi_mcd_printf(1, "           %8lu logic\n",  count_functors_logic);
+	    if (schedule_eval_levelized())
+		  vpi_mcd_printf(1, "           %8lu levelized (%lu levels)\n",
+				 count_functors_levelized, count_net_levels);
 	    vpi_mcd_printf(1, "           %8lu bufif\n",  count_functors_bufif);
 	    vpi_mcd_printf(1, "           %8lu resolv\n",count_functors_resolv);
 	    vpi_mcd_printf(1, "           %8lu signals\n", count_functors_sig);
@@ -498,15 +563,22 @@ int main(int argc, char*argv[])
       }
 
 
+      profile_start();
       schedule_simulate();
+      profile_finish();
+      if (activity_flag)
+	    activity_report();
+      if (superop_profile_flag)
+	    compile_superop_report(stderr);
 
       if (verbose_flag) {
 	    my_getrusage(cycles+2);
 	    print_rusage(cycles+2, cycles+1);
 
 	    vpi_mcd_printf(1, "Event counts:\n");
-	    vpi_mcd_printf(1, "    %8lu time steps (pool=%lu)\n",
-			   count_time_events, count_time_pool());
+	    vpi_mcd_printf(1, "    %8lu time steps (pool=%lu, %s queue)\n",
+			   count_time_events, count_time_pool(),
+			   schedule_time_queue());
 	    vpi_mcd_printf(1, "    %8lu thread schedule events\n",
 		    count_thread_events);
 	    vpi_mcd_printf(1, "    %8lu assign events\n",
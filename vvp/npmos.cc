@@ -18,12 +18,19 @@
  */
 
 # include  "npmos.h"
+# include  "checkpoint.h"
 
 vvp_fun_pmos_::vvp_fun_pmos_(bool enable_invert)
 {
       inv_en_ = enable_invert;
 }
 
+void vvp_fun_pmos_::checkpoint(vvp_checkpoint_t&cp)
+{
+      cp.io(bit_);
+      cp.io(en_);
+}
+
 
 void vvp_fun_pmos_::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                               vvp_context_t)
@@ -139,6 +146,13 @@ vvp_fun_cmos_::vvp_fun_cmos_()
 {
 }
 
+void vvp_fun_cmos_::checkpoint(vvp_checkpoint_t&cp)
+{
+      cp.io(bit_);
+      cp.io(n_en_);
+      cp.io(p_en_);
+}
+
 void vvp_fun_cmos_::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t &bit,
                               vvp_context_t)
 {
@@ -57,6 +57,8 @@ class vvp_fun_pmos_ : public vvp_net_fun_t {
       void recv_vec8_pv(vvp_net_ptr_t ptr, const vvp_vector8_t&bit,
 			unsigned base, unsigned wid, unsigned vwid);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     protected:
       void generate_output_(vvp_net_ptr_t port);
 
@@ -120,6 +122,8 @@ class vvp_fun_cmos_ : public vvp_net_fun_t {
       void recv_vec8_pv(vvp_net_ptr_t ptr, const vvp_vector8_t&bit,
 			unsigned base, unsigned wid, unsigned vwid);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     protected:
       void generate_output_(vvp_net_ptr_t port);
 
@@ -20,6 +20,7 @@
 # define __STDC_LIMIT_MACROS
 # include  "compile.h"
 # include  "part.h"
+# include  "checkpoint.h"
 # include  <cstdlib>
 # include  <climits>
 # include  <stdint.h>
@@ -46,12 +47,18 @@ vvp_fun_part_sa::vvp_fun_part_sa(unsigned base, unsigned wid)
 : vvp_fun_part(base, wid)
 {
       net_ = 0;
+      kind_ = KIND_PART_SA;
 }
 
 vvp_fun_part_sa::~vvp_fun_part_sa()
 {
 }
 
+void vvp_fun_part_sa::checkpoint(vvp_checkpoint_t&cp)
+{
+      cp.io(val_);
+}
+
 void vvp_fun_part_sa::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
                                 vvp_context_t)
 {
@@ -296,6 +303,13 @@ vvp_fun_part_var_sa::~vvp_fun_part_var_sa()
 {
 }
 
+void vvp_fun_part_var_sa::checkpoint(vvp_checkpoint_t&cp)
+{
+      cp.io(base_);
+      cp.io(source_);
+      cp.io(ref_);
+}
+
 void vvp_fun_part_var_sa::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
                                     vvp_context_t)
 {
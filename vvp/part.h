@@ -56,6 +56,8 @@ class vvp_fun_part_sa  : public vvp_fun_part, public vvp_gen_event_s {
 			unsigned, unsigned, unsigned,
                         vvp_context_t);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       void run_run();
 
@@ -158,6 +160,8 @@ class vvp_fun_part_var_sa  : public vvp_fun_part_var {
 			unsigned, unsigned, unsigned,
                         vvp_context_t);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       int base_;
       vvp_vector4_t source_;
@@ -0,0 +1,409 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "config.h"
+# include  "profile.h"
+# include  "vthread.h"
+# include  "codes.h"
+# include  "vpi_priv.h"
+# include  <string>
+# include  <map>
+# include  <vector>
+# include  <algorithm>
+# include  <csignal>
+# include  <cstdio>
+# include  <cstdlib>
+# include  <cstring>
+#if defined(__GNUC__)
+# include  <cxxabi.h>
+#endif
+#if defined(HAVE_SYS_RESOURCE_H)
+# include  <sys/time.h>
+#endif
+#if defined(HAVE_TIMER_CREATE)
+# include  <ctime>
+# include  <unistd.h>
+# include  <sys/syscall.h>
+#endif
+
+#if defined(HAVE_SYS_RESOURCE_H) && defined(ITIMER_PROF) && defined(SIGPROF)
+# define PROFILE_TIMER 1
+#endif
+
+#if defined(PROFILE_TIMER) && defined(HAVE_TIMER_CREATE) \
+    && defined(SIGEV_THREAD_ID) && defined(SYS_gettid)
+# define PROFILE_THREAD_TIMER 1
+  // Older C libraries do not name the thread id of the sigevent.
+# if !defined(sigev_notify_thread_id)
+#  define sigev_notify_thread_id _sigev_un._tid
+# endif
+#endif
+
+using namespace std;
+
+const std::type_info* volatile profile_event_type = 0;
+
+static string profile_path;
+
+/*
+ * The signal handler only copies the sample into this ring, and the
+ * main thread counts the samples in the ring between time steps. If
+ * one time step runs long enough to fill the ring, the samples that
+ * do not fit are counted as dropped. The timer sends the signal to
+ * the simulation thread (see profile_timer_start) so the handler
+ * only runs there, and the ring has only the one writer.
+ */
+struct profile_sample_s {
+      vvp_code_t pc;
+      __vpiScope*scope;
+      const std::type_info*type;
+};
+
+static const unsigned PROFILE_RING = 65536;
+static const unsigned PROFILE_USEC = 1000;
+
+static profile_sample_s profile_ring[PROFILE_RING];
+static volatile unsigned ring_head = 0;
+static volatile unsigned ring_tail = 0;
+static volatile unsigned long ring_dropped = 0;
+
+typedef pair<vvp_code_t,__vpiScope*> thread_key_t;
+static map<thread_key_t,unsigned long> thread_samples;
+static map<const std::type_info*,unsigned long> event_samples;
+static unsigned long total_samples = 0;
+
+bool profile_set_output(const char*path)
+{
+#if defined(PROFILE_TIMER)
+      profile_path = path;
+      return true;
+#else
+      (void)path;
+      fprintf(stderr, "vvp: The sampling profiler is not supported "
+	      "on this system.\n");
+      return false;
+#endif
+}
+
+bool profile_enabled(void)
+{
+      return ! profile_path.empty();
+}
+
+#if defined(PROFILE_TIMER)
+static void profile_tick(int)
+{
+      unsigned head = ring_head;
+      unsigned next = (head + 1) % PROFILE_RING;
+      if (next == ring_tail) {
+	    ring_dropped += 1;
+	    return;
+      }
+
+      profile_sample_s&cur = profile_ring[head];
+      if (! vthread_running_pc(cur.pc, cur.scope)) {
+	    cur.pc = 0;
+	    cur.scope = 0;
+      }
+      cur.type = profile_event_type;
+      ring_head = next;
+}
+
+/*
+ * Where the system supports it, the timer counts the CPU time of the
+ * simulation thread alone and signals that thread. The dumper work
+ * threads then neither add to the interval nor take the signal, so
+ * their time is not charged to the thread that happens to be
+ * running. Otherwise fall back to ITIMER_PROF, which counts the CPU
+ * time of the whole process and may signal any thread.
+ */
+#if defined(PROFILE_THREAD_TIMER)
+static timer_t profile_timer_id;
+static bool profile_thread_timer = false;
+#endif
+
+static void profile_timer_start(unsigned usec)
+{
+#if defined(PROFILE_THREAD_TIMER)
+      struct sigevent sev;
+      memset(&sev, 0, sizeof sev);
+      sev.sigev_notify = SIGEV_THREAD_ID;
+      sev.sigev_signo = SIGPROF;
+      sev.sigev_notify_thread_id = syscall(SYS_gettid);
+      if (timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &profile_timer_id) == 0) {
+	    struct itimerspec val;
+	    val.it_interval.tv_sec = 0;
+	    val.it_interval.tv_nsec = usec * 1000;
+	    val.it_value = val.it_interval;
+	    timer_settime(profile_timer_id, 0, &val, 0);
+	    profile_thread_timer = true;
+	    return;
+      }
+#endif
+
+      struct itimerval val;
+      val.it_interval.tv_sec = 0;
+      val.it_interval.tv_usec = usec;
+      val.it_value = val.it_interval;
+      setitimer(ITIMER_PROF, &val, 0);
+}
+
+static void profile_timer_stop(void)
+{
+#if defined(PROFILE_THREAD_TIMER)
+      if (profile_thread_timer) {
+	    timer_delete(profile_timer_id);
+	    profile_thread_timer = false;
+	    return;
+      }
+#endif
+
+      struct itimerval val;
+      memset(&val, 0, sizeof val);
+      setitimer(ITIMER_PROF, &val, 0);
+}
+#endif
+
+void profile_start(void)
+{
+      if (! profile_enabled())
+	    return;
+
+#if defined(PROFILE_TIMER)
+      struct sigaction act;
+      memset(&act, 0, sizeof act);
+      act.sa_handler = &profile_tick;
+      act.sa_flags = SA_RESTART;
+      sigemptyset(&act.sa_mask);
+      sigaction(SIGPROF, &act, 0);
+
+      profile_timer_start(PROFILE_USEC);
+#endif
+}
+
+void profile_time_step(void)
+{
+      while (ring_tail != ring_head) {
+	    profile_sample_s&cur = profile_ring[ring_tail];
+	    if (cur.pc)
+		  thread_samples[thread_key_t(cur.pc, cur.scope)] += 1;
+	    else
+		  event_samples[cur.type] += 1;
+	    total_samples += 1;
+	    ring_tail = (ring_tail + 1) % PROFILE_RING;
+      }
+}
+
+/*
+ * The pc of a thread is mapped to the last %file_line opcode before
+ * it in the code space. The code of a thread ends with an %end, so
+ * the line is forgotten there, rather than be given to the code of
+ * the next thread.
+ */
+static map<vvp_code_t,vpiHandle> walk_lines;
+static vpiHandle walk_last = 0;
+
+static void walk_code(vvp_code_t cp)
+{
+      map<vvp_code_t,vpiHandle>::iterator cur = walk_lines.find(cp);
+      if (cur != walk_lines.end())
+	    cur->second = walk_last;
+
+      if (cp->opcode == &of_FILE_LINE)
+	    walk_last = cp->handle;
+      else if (cp->opcode == &of_END)
+	    walk_last = 0;
+}
+
+static string line_name(vpiHandle line)
+{
+      if (line == 0)
+	    return "?";
+
+      char buf[64];
+      snprintf(buf, sizeof buf, ":%d", (int)vpi_get(vpiLineNo, line));
+      return string(vpi_get_str(vpiFile, line)) + buf;
+}
+
+string profile_type_name(const std::type_info*type)
+{
+      if (type == 0)
+	    return "<scheduler>";
+
+      const char*name = type->name();
+#if defined(__GNUC__)
+      int status = 0;
+      char*text = abi::__cxa_demangle(name, 0, 0, &status);
+      if (status == 0 && text) {
+	    string res = text;
+	    free(text);
+	    return res;
+      }
+#endif
+      return name;
+}
+
+static void scope_path(__vpiScope*scope, vector<__vpiScope*>&path)
+{
+      path.clear();
+      for ( ; scope ; scope = scope->scope)
+	    path.push_back(scope);
+      reverse(path.begin(), path.end());
+}
+
+struct scope_node_s {
+      scope_node_s() : self(0), total(0) { }
+      unsigned long self;
+      unsigned long total;
+      map<__vpiScope*,scope_node_s> children;
+};
+
+static double percent(unsigned long cnt)
+{
+      return total_samples? 100.0 * cnt / total_samples : 0.0;
+}
+
+static bool by_count(const pair<string,unsigned long>&a,
+		     const pair<string,unsigned long>&b)
+{
+      if (a.second != b.second)
+	    return a.second > b.second;
+      return a.first < b.first;
+}
+
+static void print_scope_tree(FILE*fd, const map<__vpiScope*,scope_node_s>&nodes,
+			     unsigned indent)
+{
+      vector< pair<unsigned long,__vpiScope*> > order;
+      for (map<__vpiScope*,scope_node_s>::const_iterator cur = nodes.begin()
+		 ; cur != nodes.end() ; ++ cur)
+	    order.push_back(make_pair(cur->second.total, cur->first));
+      sort(order.rbegin(), order.rend());
+
+      for (size_t idx = 0 ; idx < order.size() ; idx += 1) {
+	    const scope_node_s&node = nodes.find(order[idx].second)->second;
+	    fprintf(fd, "%6.2f%% %6.2f%% %*s%s\n", percent(node.total),
+		    percent(node.self), 2*indent, "",
+		    order[idx].second->scope_name());
+	    print_scope_tree(fd, node.children, indent+1);
+      }
+}
+
+void profile_finish(void)
+{
+      if (! profile_enabled())
+	    return;
+
+#if defined(PROFILE_TIMER)
+      profile_timer_stop();
+	// A last signal may still be pending, so ignore it rather
+	// than let it end the process.
+      signal(SIGPROF, SIG_IGN);
+#endif
+      profile_time_step();
+
+      for (map<thread_key_t,unsigned long>::iterator cur = thread_samples.begin()
+		 ; cur != thread_samples.end() ; ++ cur)
+	    walk_lines[cur->first.first] = 0;
+      codespace_walk(&walk_code);
+
+	/* Gather the samples by line, by event type, by scope and by
+	   folded stack. */
+      map<string,unsigned long> line_counts;
+      map<string,unsigned long> folded_counts;
+      map<__vpiScope*,scope_node_s> scope_tree;
+      vector<__vpiScope*> path;
+
+      for (map<thread_key_t,unsigned long>::iterator cur = thread_samples.begin()
+		 ; cur != thread_samples.end() ; ++ cur) {
+	    vpiHandle line = walk_lines[cur->first.first];
+	    __vpiScope*scope = cur->first.second;
+	    unsigned long cnt = cur->second;
+
+	    string where = line_name(line);
+	    string desc;
+	    if (line)
+		  desc = string(" ") + vpi_get_str(_vpiDescription, line);
+	    string scope_name = scope? vpi_get_str(vpiFullName, scope) : "?";
+	    line_counts[where + " (" + scope_name + ")" + desc] += cnt;
+
+	    scope_path(scope, path);
+	    string stack;
+	    map<__vpiScope*,scope_node_s>*level = &scope_tree;
+	    for (size_t idx = 0 ; idx < path.size() ; idx += 1) {
+		  scope_node_s&node = (*level)[path[idx]];
+		  node.total += cnt;
+		  if (idx+1 == path.size())
+			node.self += cnt;
+		  level = &node.children;
+		  stack += path[idx]->scope_name();
+		  stack += ";";
+	    }
+	    folded_counts[stack + where] += cnt;
+      }
+
+      map<string,unsigned long> event_counts;
+      for (map<const std::type_info*,unsigned long>::iterator cur = event_samples.begin()
+		 ; cur != event_samples.end() ; ++ cur) {
+	    string name = profile_type_name(cur->first);
+	    event_counts[name] += cur->second;
+	    folded_counts["<events>;" + name] += cur->second;
+      }
+
+      FILE*fd = fopen(profile_path.c_str(), "w");
+      if (fd == 0) {
+	    perror(profile_path.c_str());
+	    return;
+      }
+
+      fprintf(fd, "# vvp profile: %lu samples, one every %u us of CPU time,"
+	      " %lu dropped\n", total_samples, PROFILE_USEC, ring_dropped);
+
+      vector< pair<string,unsigned long> > order (line_counts.begin(),
+						  line_counts.end());
+      sort(order.begin(), order.end(), by_count);
+      fprintf(fd, "\n# Threads, by source line (scope)\n");
+      for (size_t idx = 0 ; idx < order.size() ; idx += 1)
+	    fprintf(fd, "%6.2f%% %8lu  %s\n", percent(order[idx].second),
+		    order[idx].second, order[idx].first.c_str());
+
+      order.assign(event_counts.begin(), event_counts.end());
+      sort(order.begin(), order.end(), by_count);
+      fprintf(fd, "\n# Events and functors, by type\n");
+      for (size_t idx = 0 ; idx < order.size() ; idx += 1)
+	    fprintf(fd, "%6.2f%% %8lu  %s\n", percent(order[idx].second),
+		    order[idx].second, order[idx].first.c_str());
+
+      fprintf(fd, "\n# Threads, by scope (total, self)\n");
+      print_scope_tree(fd, scope_tree, 0);
+      fclose(fd);
+
+	/* The folded stacks are in the format of the flame graph
+	   tools, one stack and its count on a line. */
+      string folded_path = profile_path + ".folded";
+      fd = fopen(folded_path.c_str(), "w");
+      if (fd == 0) {
+	    perror(folded_path.c_str());
+	    return;
+      }
+      for (map<string,unsigned long>::iterator cur = folded_counts.begin()
+		 ; cur != folded_counts.end() ; ++ cur)
+	    fprintf(fd, "%s %lu\n", cur->first.c_str(), cur->second);
+      fclose(fd);
+}
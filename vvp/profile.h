@@ -0,0 +1,58 @@
+#ifndef IVL_profile_H
+#define IVL_profile_H
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  <typeinfo>
+# include  <string>
+
+/*
+ * The sampling profiler (vvp -p file) interrupts the simulation at a
+ * regular interval of CPU time and records what is running: the pc
+ * and the scope of the running thread, or else the type of the event
+ * or functor that the scheduler is running. The samples are counted
+ * by source line (from the %file_line opcodes), by scope, and by the
+ * type of event, and written out when the simulation ends.
+ */
+extern bool profile_set_output(const char*path);
+extern bool profile_enabled(void);
+
+/*
+ * The main program starts the profiler just before the simulation
+ * and finishes it after, which writes the reports. The scheduler
+ * calls profile_time_step() between time steps to collect the
+ * samples that were taken since the last call.
+ */
+extern void profile_start(void);
+extern void profile_time_step(void);
+extern void profile_finish(void);
+
+/*
+ * The scheduler puts here the type of the event that it is running,
+ * while the profiler is enabled.
+ */
+extern const std::type_info* volatile profile_event_type;
+
+/*
+ * Make a readable (demangled) name for the type of an event or
+ * functor.
+ */
+extern std::string profile_type_name(const std::type_info*type);
+
+#endif /* IVL_profile_H */
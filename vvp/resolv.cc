@@ -21,6 +21,7 @@
 # include  "schedule.h"
 # include  "compile.h"
 # include  "statistics.h"
+# include  "checkpoint.h"
 # include  <iostream>
 # include  <algorithm>
 # include  <cassert>
@@ -96,9 +97,11 @@ resolv_extend::~resolv_extend()
 {
 }
 
-
-resolv_tri::resolv_tri(unsigned nports, vvp_net_t*net, vvp_scalar_t hiz_value)
-: resolv_core(nports, net), hiz_value_(hiz_value)
+/*
+ * The resolvers keep the values of the input (leaf) nodes, the
+ * intermediate branch nodes of the resolution tree, and the output.
+ */
+unsigned resolv_core::count_nodes_(unsigned nports)
 {
         // count the input (leaf) nodes
       unsigned nnodes = nports;
@@ -113,7 +116,14 @@ resolv_tri::resolv_tri(unsigned nports, vvp_net_t*net, vvp_scalar_t hiz_value)
       if (nnodes > 1)
             nnodes += 1;
 
-      val_ = new vvp_vector8_t [nnodes];
+      return nnodes;
+}
+
+
+resolv_tri::resolv_tri(unsigned nports, vvp_net_t*net, vvp_scalar_t hiz_value)
+: resolv_core(nports, net), hiz_value_(hiz_value)
+{
+      val_ = new vvp_vector8_t [count_nodes_(nports)];
 }
 
 resolv_tri::~resolv_tri()
@@ -121,6 +131,13 @@ resolv_tri::~resolv_tri()
       delete[] val_;
 }
 
+void resolv_tri::checkpoint(vvp_checkpoint_t&cp)
+{
+      unsigned nnodes = count_nodes_(nports_);
+      for (unsigned idx = 0 ; idx < nnodes ; idx += 1)
+	    cp.io(val_[idx]);
+}
+
 void resolv_tri::recv_vec4_(unsigned port, const vvp_vector4_t&bit)
 {
       recv_vec8_(port, vvp_vector8_t(bit, 6,6 /* STRONG */));
@@ -192,20 +209,7 @@ void resolv_tri::count_drivers(unsigned bit_idx, unsigned counts[3])
 resolv_wired_logic::resolv_wired_logic(unsigned nports, vvp_net_t*net)
 : resolv_core(nports, net)
 {
-        // count the input (leaf) nodes
-      unsigned nnodes = nports;
-
-        // add in the intermediate branch nodes
-      while (nports > 4) {
-            nports = (nports + 3) / 4;
-            nnodes += nports;
-      }
-        // add one more node for storing the output value
-        // (not needed if there is only one input)
-      if (nnodes > 1)
-            nnodes += 1;
-
-      val_ = new vvp_vector4_t [nnodes];
+      val_ = new vvp_vector4_t [count_nodes_(nports)];
 }
 
 resolv_wired_logic::~resolv_wired_logic()
@@ -213,6 +217,13 @@ resolv_wired_logic::~resolv_wired_logic()
       delete[] val_;
 }
 
+void resolv_wired_logic::checkpoint(vvp_checkpoint_t&cp)
+{
+      unsigned nnodes = count_nodes_(nports_);
+      for (unsigned idx = 0 ; idx < nnodes ; idx += 1)
+	    cp.io(val_[idx]);
+}
+
 void resolv_wired_logic::recv_vec4_(unsigned port, const vvp_vector4_t&bit)
 {
       assert(port < nports_);
@@ -64,6 +64,9 @@ class resolv_core : public vvp_net_fun_t {
       void recv_vec8_pv_(unsigned port, const vvp_vector8_t&bit,
 			 unsigned base, unsigned wid, unsigned vwid);
 
+    protected:
+      static unsigned count_nodes_(unsigned nports);
+
     protected:
       unsigned nports_;
       vvp_net_t*net_;
@@ -119,6 +122,8 @@ class resolv_tri : public resolv_core {
 
       void count_drivers(unsigned bit_idx, unsigned counts[3]);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       void recv_vec4_(unsigned port, const vvp_vector4_t&bit);
       void recv_vec8_(unsigned port, const vvp_vector8_t&bit);
@@ -147,6 +152,8 @@ class resolv_wired_logic : public resolv_core {
 
       void count_drivers(unsigned bit_idx, unsigned counts[3]);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     protected:
       virtual vvp_vector4_t wired_logic_math_(vvp_vector4_t&a, vvp_vector4_t&b) =0;
 
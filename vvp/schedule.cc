@@ -24,12 +24,20 @@
 # include  "vvp_net_sig.h"
 # include  "slab.h"
 # include  "compile.h"
+# include  "checkpoint.h"
+# include  "profile.h"
+# include  "activity.h"
 # include  <new>
 # include  <typeinfo>
 # include  <csignal>
 # include  <cstdlib>
 # include  <cassert>
+# include  <cstring>
+# include  <stdint.h>
 # include  <iostream>
+# include  <algorithm>
+# include  <vector>
+# include  <map>
 #ifdef CHECK_WITH_VALGRIND
 # include  "vvp_cleanup.h"
 # include  "ivl_alloc.h"
@@ -61,6 +69,26 @@ struct event_s {
 	// Write something about the event to stderr
       virtual void single_step_display(void);
 
+	// The type that the sampling profiler counts this event as.
+      virtual const std::type_info& profile_type(void) const
+      { return typeid(*this); }
+
+	// The scope that the activity counters charge this event
+	// to. This is the scope of the thread that is running, if
+	// any, or nil for events from the net functors.
+      virtual __vpiScope* activity_scope(void) const;
+
+	// Support for checkpoints. The kind selects the type of
+	// event when the checkpoint is restored, and the checkpoint
+	// method saves or restores the members.
+      virtual int checkpoint_kind(void) const { return CP_EVENT_NONE; }
+      virtual void checkpoint(vvp_checkpoint_t&) { }
+
+      enum { CP_EVENT_NONE = 0, CP_EVENT_DROP, CP_EVENT_VTHREAD,
+	     CP_EVENT_ASSIGN4, CP_EVENT_ASSIGN8, CP_EVENT_ASSIGNR,
+	     CP_EVENT_ARRAY_WORD, CP_EVENT_FORCE4, CP_EVENT_PROPAGATE4,
+	     CP_EVENT_PROPAGATER, CP_EVENT_ARRAY_R_WORD, CP_EVENT_GENERIC };
+
 	// Fallback new/delete
       static void*operator new (size_t size) { return ::new char[size]; }
       static void operator delete(void*ptr)  { ::delete[]( (char*)ptr ); }
@@ -71,6 +99,22 @@ void event_s::single_step_display(void)
       std::cerr << "event_s: Step into event " << typeid(*this).name() << std::endl;
 }
 
+__vpiScope* event_s::activity_scope(void) const
+{
+      vvp_code_t pc;
+      __vpiScope*scope;
+      return vthread_running_pc(pc, scope)? scope : 0;
+}
+
+static void checkpoint_ptr(vvp_checkpoint_t&cp, vvp_net_ptr_t&ptr)
+{
+      vvp_net_t*net = ptr.ptr();
+      unsigned port = ptr.port();
+      cp.io_net(net);
+      cp.io(port);
+      ptr = vvp_net_ptr_t(net, port);
+}
+
 struct event_time_s {
       event_time_s() {
 	    count_time_events += 1;
@@ -80,9 +124,14 @@ struct event_time_s {
 	    rwsync = 0;
 	    rosync = 0;
 	    del_thr = 0;
+	    time = 0;
 	    next = NULL;
       }
+	// The list queue keeps the delay relative to the previous
+	// cell. The timing wheel keeps the absolute time and only
+	// fills in the delay when the cell reaches the front.
       vvp_time64_t delay;
+      vvp_time64_t time;
 
       struct event_s*start;
       struct event_s*active;
@@ -114,6 +163,13 @@ struct vthread_event_s : public event_s {
       void run_run(void);
       void single_step_display(void);
 
+      __vpiScope* activity_scope(void) const { return vthread_scope(thr); }
+
+	// The event of a reaped thread only deletes the thread.
+      int checkpoint_kind(void) const
+      { return checkpoint_thread_index(thr)? CP_EVENT_VTHREAD : CP_EVENT_DROP; }
+      void checkpoint(vvp_checkpoint_t&cp) { cp.io_thread(thr); }
+
       static void* operator new(size_t);
       static void operator delete(void*);
 };
@@ -182,6 +238,15 @@ struct assign_vector4_event_s  : public event_s {
       void run_run(void);
       void single_step_display(void);
 
+      int checkpoint_kind(void) const { return CP_EVENT_ASSIGN4; }
+      void checkpoint(vvp_checkpoint_t&cp)
+      {
+	    checkpoint_ptr(cp, ptr);
+	    cp.io(val);
+	    cp.io(base);
+	    cp.io(vwid);
+      }
+
       static void* operator new(size_t);
       static void operator delete(void*);
 };
@@ -223,6 +288,13 @@ struct assign_vector8_event_s  : public event_s {
       void run_run(void);
       void single_step_display(void);
 
+      int checkpoint_kind(void) const { return CP_EVENT_ASSIGN8; }
+      void checkpoint(vvp_checkpoint_t&cp)
+      {
+	    checkpoint_ptr(cp, ptr);
+	    cp.io(val);
+      }
+
       static void* operator new(size_t);
       static void operator delete(void*);
 };
@@ -260,6 +332,13 @@ struct assign_real_event_s  : public event_s {
       void run_run(void);
       void single_step_display(void);
 
+      int checkpoint_kind(void) const { return CP_EVENT_ASSIGNR; }
+      void checkpoint(vvp_checkpoint_t&cp)
+      {
+	    checkpoint_ptr(cp, ptr);
+	    cp.io(val);
+      }
+
       static void* operator new(size_t);
       static void operator delete(void*);
 };
@@ -298,6 +377,15 @@ struct assign_array_word_s  : public event_s {
       unsigned off;
       void run_run(void);
 
+      int checkpoint_kind(void) const { return CP_EVENT_ARRAY_WORD; }
+      void checkpoint(vvp_checkpoint_t&cp)
+      {
+	    cp.io_array(mem);
+	    cp.io(adr);
+	    cp.io(val);
+	    cp.io(off);
+      }
+
       static void* operator new(size_t);
       static void operator delete(void*);
 };
@@ -343,6 +431,15 @@ struct force_vector4_event_s  : public event_s {
       void run_run(void);
       void single_step_display(void);
 
+      int checkpoint_kind(void) const { return CP_EVENT_FORCE4; }
+      void checkpoint(vvp_checkpoint_t&cp)
+      {
+	    cp.io_net(net);
+	    cp.io(val);
+	    cp.io(base);
+	    cp.io(vwid);
+      }
+
       static void* operator new(size_t);
       static void operator delete(void*);
 };
@@ -418,6 +515,13 @@ struct propagate_vector4_event_s : public event_s {
 	/* Action */
       void run_run(void);
       void single_step_display(void);
+
+      int checkpoint_kind(void) const { return CP_EVENT_PROPAGATE4; }
+      void checkpoint(vvp_checkpoint_t&cp)
+      {
+	    cp.io_net(net);
+	    cp.io(val);
+      }
 };
 
 void propagate_vector4_event_s::run_run(void)
@@ -442,6 +546,13 @@ struct propagate_real_event_s : public event_s {
 	/* Action */
       void run_run(void);
       void single_step_display(void);
+
+      int checkpoint_kind(void) const { return CP_EVENT_PROPAGATER; }
+      void checkpoint(vvp_checkpoint_t&cp)
+      {
+	    cp.io_net(net);
+	    cp.io(val);
+      }
 };
 
 void propagate_real_event_s::run_run(void)
@@ -460,6 +571,14 @@ struct assign_array_r_word_s  : public event_s {
       double val;
       void run_run(void);
 
+      int checkpoint_kind(void) const { return CP_EVENT_ARRAY_R_WORD; }
+      void checkpoint(vvp_checkpoint_t&cp)
+      {
+	    cp.io_array(mem);
+	    cp.io(adr);
+	    cp.io(val);
+      }
+
       static void* operator new(size_t);
       static void operator delete(void*);
 };
@@ -490,6 +609,22 @@ struct generic_event_s : public event_s {
       bool delete_obj_when_done;
       void run_run(void);
       void single_step_display(void);
+      const std::type_info& profile_type(void) const
+      { return typeid(*obj); }
+
+	// Only the generic events that a functor claimed can be
+	// saved. They are saved as the net of the functor.
+      int checkpoint_kind(void) const
+      { return checkpoint_event_net(obj)? CP_EVENT_GENERIC : CP_EVENT_NONE; }
+      void checkpoint(vvp_checkpoint_t&cp)
+      {
+	    vvp_net_t*net = cp.restoring()? 0 : checkpoint_event_net(obj);
+	    cp.io_net(net);
+	    if (cp.restoring()) {
+		  obj = checkpoint_net_event(net);
+		  delete_obj_when_done = false;
+	    }
+      }
 
       static void* operator new(size_t);
       static void operator delete(void*);
@@ -552,7 +687,7 @@ unsigned long count_time_pool(void) { return event_time_heap.pool; }
 /*
  * This is the head of the list of pending events. This includes all
  * the events that have not been executed yet, and reaches into the
- * future.
+ * future. This list is only used by the list time queue.
  */
 static struct event_time_s* sched_list = 0;
 
@@ -655,20 +790,52 @@ static void schedule_final_event(struct event_s*cur)
       schedule_final_list = cur;
 }
 
+static vvp_time64_t schedule_time;
+vvp_time64_t schedule_simtime(void)
+{ return schedule_time; }
+
 /*
- * This function does all the hard work of putting an event into the
- * event queue. The event delay is taken from the event structure
- * itself, and the structure is placed in the right place in the
- * queue.
+ * The pending event_time_s cells are kept in one of two time
+ * queues. The list queue is a sorted, delta encoded list of cells and
+ * is the default. Inserting an event into the list walks the list
+ * from the front, so the cost grows with the number of distinct
+ * pending times.
+ *
+ * The wheel queue is a hierarchical timing wheel. Each level has
+ * WHEEL_SLOTS slots, and a level covers WHEEL_BITS more bits of the
+ * absolute time than the level below it. A cell is kept at the level
+ * of the most significant WHEEL_BITS digit in which its time differs
+ * from wheel_now, so the level 0 slots each hold at most one cell,
+ * and the higher level slots hold short unsorted lists of cells that
+ * are redistributed to the lower levels as the wheel reaches
+ * them. The cells of the higher levels are also indexed by time in
+ * wheel_upper, so that finding the cell of a time never walks a slot
+ * list. Cells too far in the future for the wheel are kept in the
+ * wheel_overflow map, sorted by time, until the wheel reaches their
+ * range.
  */
-typedef enum event_queue_e { SEQ_START, SEQ_ACTIVE, SEQ_NBASSIGN,
-			     SEQ_RWSYNC, SEQ_ROSYNC, DEL_THREAD } event_queue_t;
+static bool sched_wheel_flag = false;
 
-static void schedule_event_(struct event_s*cur, vvp_time64_t delay,
-			    event_queue_t select_queue)
+bool schedule_set_time_queue(const char*name)
 {
-      cur->next = cur;
+      if (strcmp(name, "list") == 0) {
+	    sched_wheel_flag = false;
+	    return true;
+      }
+      if (strcmp(name, "wheel") == 0) {
+	    sched_wheel_flag = true;
+	    return true;
+      }
+      return false;
+}
+
+const char* schedule_time_queue(void)
+{
+      return sched_wheel_flag? "wheel" : "list";
+}
 
+static struct event_time_s* list_find_time_(vvp_time64_t delay)
+{
       struct event_time_s*ctim = sched_list;
 
       if (sched_list == 0) {
@@ -721,6 +888,307 @@ static void schedule_event_(struct event_s*cur, vvp_time64_t delay,
 	    }
       }
 
+      return ctim;
+}
+
+static const unsigned WHEEL_BITS   = 8;
+static const unsigned WHEEL_SLOTS  = 1 << WHEEL_BITS;
+static const unsigned WHEEL_MASK   = WHEEL_SLOTS - 1;
+static const unsigned WHEEL_LEVELS = 6;
+static const unsigned WHEEL_MAP_WORDS = WHEEL_SLOTS / 64;
+
+static struct event_time_s* wheel_slot[WHEEL_LEVELS][WHEEL_SLOTS];
+static uint64_t wheel_map[WHEEL_LEVELS][WHEEL_MAP_WORDS];
+static vvp_time64_t wheel_now = 0;
+static struct event_time_s* wheel_head = 0;
+typedef std::map<vvp_time64_t,struct event_time_s*> wheel_index_t;
+static wheel_index_t wheel_upper;
+static wheel_index_t wheel_overflow;
+
+/*
+ * The time is shifted one digit at a time, so that a narrow
+ * vvp_time64_t never gets shifted by more than its width.
+ */
+static inline unsigned wheel_digit_(vvp_time64_t val, unsigned lev)
+{
+      for (unsigned idx = 0 ; idx < lev ; idx += 1)
+	    val >>= WHEEL_BITS;
+      return val & WHEEL_MASK;
+}
+
+static inline vvp_time64_t wheel_high_(vvp_time64_t val, unsigned lev)
+{
+      for (unsigned idx = 0 ; idx <= lev ; idx += 1)
+	    val >>= WHEEL_BITS;
+      for (unsigned idx = 0 ; idx <= lev ; idx += 1)
+	    val <<= WHEEL_BITS;
+      return val;
+}
+
+static inline unsigned wheel_level_(vvp_time64_t val)
+{
+      vvp_time64_t diff = (val ^ wheel_now) >> WHEEL_BITS;
+      unsigned lev = 0;
+      while (diff) {
+	    lev += 1;
+	    diff >>= WHEEL_BITS;
+      }
+      return lev;
+}
+
+/*
+ * Return the first occupied slot at or above the given slot of the
+ * level, or WHEEL_SLOTS if there is none.
+ */
+static unsigned wheel_scan_(unsigned lev, unsigned slot)
+{
+      for (unsigned wd = slot / 64 ; wd < WHEEL_MAP_WORDS ; wd += 1) {
+	    uint64_t bits = wheel_map[lev][wd];
+	    if (wd == slot / 64)
+		  bits &= ~(uint64_t)0 << (slot % 64);
+	    if (bits == 0)
+		  continue;
+
+	    unsigned idx = wd * 64;
+#if defined(__GNUC__)
+	    idx += __builtin_ctzll(bits);
+#else
+	    while ((bits & 0xff) == 0) {
+		  bits >>= 8;
+		  idx += 8;
+	    }
+	    while ((bits & 1) == 0) {
+		  bits >>= 1;
+		  idx += 1;
+	    }
+#endif
+	    return idx;
+      }
+
+      return WHEEL_SLOTS;
+}
+
+/*
+ * Put the cell in the slot or overflow map that matches its time.
+ */
+static void wheel_place_(struct event_time_s*ctim)
+{
+      unsigned lev = wheel_level_(ctim->time);
+      if (lev >= WHEEL_LEVELS) {
+	    wheel_overflow[ctim->time] = ctim;
+	    return;
+      }
+
+      if (lev > 0)
+	    wheel_upper[ctim->time] = ctim;
+
+      unsigned slot = wheel_digit_(ctim->time, lev);
+      ctim->next = wheel_slot[lev][slot];
+      wheel_slot[lev][slot] = ctim;
+      wheel_map[lev][slot/64] |= (uint64_t)1 << (slot%64);
+}
+
+/*
+ * The wheel may have been moved ahead of the current time while
+ * looking for the next time cell. If an event is then scheduled
+ * before the wheel position (e.g. by the interactive stop handler)
+ * move the wheel back and redistribute all the cells.
+ */
+static void wheel_rewind_(vvp_time64_t val)
+{
+      std::vector<struct event_time_s*> cells;
+      for (wheel_index_t::iterator cur = wheel_overflow.begin()
+		 ; cur != wheel_overflow.end() ; ++ cur)
+	    cells.push_back(cur->second);
+      wheel_overflow.clear();
+      wheel_upper.clear();
+
+      for (unsigned lev = 0 ; lev < WHEEL_LEVELS ; lev += 1) {
+	    for (unsigned slot = 0 ; slot < WHEEL_SLOTS ; slot += 1) {
+		  struct event_time_s*cur = wheel_slot[lev][slot];
+		  while (cur) {
+			cells.push_back(cur);
+			cur = cur->next;
+		  }
+		  wheel_slot[lev][slot] = 0;
+	    }
+	    for (unsigned wd = 0 ; wd < WHEEL_MAP_WORDS ; wd += 1)
+		  wheel_map[lev][wd] = 0;
+      }
+
+      wheel_now = val;
+      wheel_head = 0;
+      for (size_t idx = 0 ; idx < cells.size() ; idx += 1)
+	    wheel_place_(cells[idx]);
+}
+
+static struct event_time_s* wheel_find_time_(vvp_time64_t delay)
+{
+      vvp_time64_t val = schedule_time + delay;
+      if (val < wheel_now)
+	    wheel_rewind_(val);
+
+      unsigned lev = wheel_level_(val);
+
+      if (lev == 0) {
+	      // A level 0 slot only ever holds the cell of one time.
+	    struct event_time_s*cur = wheel_slot[0][wheel_digit_(val, 0)];
+	    if (cur) {
+		  assert(cur->time == val);
+		  return cur;
+	    }
+
+      } else {
+	    wheel_index_t&index = lev < WHEEL_LEVELS? wheel_upper : wheel_overflow;
+	    wheel_index_t::iterator cur = index.find(val);
+	    if (cur != index.end())
+		  return cur->second;
+      }
+
+      struct event_time_s*ctim = new struct event_time_s;
+      ctim->time = val;
+      wheel_place_(ctim);
+
+      if (wheel_head && val < wheel_head->time)
+	    wheel_head = 0;
+
+      return ctim;
+}
+
+/*
+ * Find the earliest cell in the wheel. The higher levels are only
+ * consulted when level 0 is empty, and the first occupied slot of
+ * the lowest occupied level is then spread out over the lower
+ * levels. The overflow map is consulted only when the wheel is
+ * completely empty.
+ */
+static struct event_time_s* wheel_peek_time_(void)
+{
+      if (wheel_head)
+	    return wheel_head;
+
+      for (;;) {
+	    unsigned slot = wheel_scan_(0, wheel_digit_(wheel_now, 0));
+	    if (slot < WHEEL_SLOTS) {
+		  wheel_head = wheel_slot[0][slot];
+		  assert(wheel_head->next == 0);
+		  wheel_head->delay = wheel_head->time - schedule_time;
+		  return wheel_head;
+	    }
+
+	    bool cascade_flag = false;
+	    for (unsigned lev = 1 ; lev < WHEEL_LEVELS ; lev += 1) {
+		  slot = wheel_digit_(wheel_now, lev) + 1;
+		  if (slot >= WHEEL_SLOTS)
+			continue;
+		  slot = wheel_scan_(lev, slot);
+		  if (slot >= WHEEL_SLOTS)
+			continue;
+
+		  vvp_time64_t base = slot;
+		  for (unsigned idx = 0 ; idx < lev ; idx += 1)
+			base <<= WHEEL_BITS;
+		  wheel_now = wheel_high_(wheel_now, lev) | base;
+
+		  struct event_time_s*cur = wheel_slot[lev][slot];
+		  wheel_slot[lev][slot] = 0;
+		  wheel_map[lev][slot/64] &= ~((uint64_t)1 << (slot%64));
+		  while (cur) {
+			struct event_time_s*next = cur->next;
+			wheel_upper.erase(cur->time);
+			wheel_place_(cur);
+			cur = next;
+		  }
+		  cascade_flag = true;
+		  break;
+	    }
+	    if (cascade_flag)
+		  continue;
+
+	    if (wheel_overflow.empty())
+		  return 0;
+
+	      /* The wheel is empty, so move it to the range of the
+		 earliest overflow cell and pull in every cell that
+		 now fits. */
+	    wheel_now = wheel_high_(wheel_overflow.begin()->first, WHEEL_LEVELS-1);
+	    while (!wheel_overflow.empty()
+		   && wheel_level_(wheel_overflow.begin()->first) < WHEEL_LEVELS) {
+		  struct event_time_s*cur = wheel_overflow.begin()->second;
+		  wheel_overflow.erase(wheel_overflow.begin());
+		  wheel_place_(cur);
+	    }
+      }
+}
+
+static void wheel_pop_time_(struct event_time_s*ctim)
+{
+      assert(ctim == wheel_head);
+      unsigned slot = wheel_digit_(ctim->time, 0);
+      assert(wheel_slot[0][slot] == ctim);
+      wheel_slot[0][slot] = 0;
+      wheel_map[0][slot/64] &= ~((uint64_t)1 << (slot%64));
+      wheel_now = ctim->time;
+      wheel_head = 0;
+}
+
+/*
+ * Get the time cell for the given delay from the current time,
+ * creating it if necessary.
+ */
+static inline struct event_time_s* sched_find_time_(vvp_time64_t delay)
+{
+      if (sched_wheel_flag)
+	    return wheel_find_time_(delay);
+      else
+	    return list_find_time_(delay);
+}
+
+/*
+ * Get the earliest pending time cell, or nil if there are no more
+ * events. The delay of the returned cell is relative to the current
+ * simulation time.
+ */
+static inline struct event_time_s* sched_peek_time_(void)
+{
+      if (sched_wheel_flag)
+	    return wheel_peek_time_();
+      else
+	    return sched_list;
+}
+
+/*
+ * Remove the earliest time cell, which was returned by
+ * sched_peek_time_, from the time queue.
+ */
+static inline void sched_pop_time_(struct event_time_s*ctim)
+{
+      if (sched_wheel_flag) {
+	    wheel_pop_time_(ctim);
+      } else {
+	    assert(ctim == sched_list);
+	    sched_list = ctim->next;
+      }
+}
+
+/*
+ * This function does all the hard work of putting an event into the
+ * event queue. The event delay is taken from the event structure
+ * itself, and the structure is placed in the right place in the
+ * queue.
+ */
+typedef enum event_queue_e { SEQ_START, SEQ_ACTIVE, SEQ_NBASSIGN,
+			     SEQ_RWSYNC, SEQ_ROSYNC, DEL_THREAD } event_queue_t;
+
+static void schedule_event_(struct event_s*cur, vvp_time64_t delay,
+			    event_queue_t select_queue)
+{
+      cur->next = cur;
+      if (activity_flag)
+	    activity_event(cur->activity_scope());
+
+      struct event_time_s*ctim = sched_find_time_(delay);
+
 	/* By this point, ctim is the event_time structure that is to
 	   receive the event at hand. Put the event in to the
 	   appropriate list for the kind of assign we have at hand. */
@@ -765,12 +1233,9 @@ static void schedule_event_(struct event_s*cur, vvp_time64_t delay,
 
 static void schedule_event_push_(struct event_s*cur)
 {
-      if ((sched_list == 0) || (sched_list->delay > 0)) {
-	    schedule_event_(cur, 0, SEQ_ACTIVE);
-	    return;
-      }
-
-      struct event_time_s*ctim = sched_list;
+      struct event_time_s*ctim = sched_find_time_(0);
+      if (activity_flag)
+	    activity_event(cur->activity_scope());
 
       if (ctim->active == 0) {
 	    cur->next = cur;
@@ -984,6 +1449,102 @@ void schedule_functor(vvp_gen_event_t obj)
       }
 }
 
+/*
+ * In the levelized evaluation mode, the boolean functors that are
+ * not in a feedback loop are given a level when the design is
+ * linked, so that a functor has a higher level than any of the
+ * levelized functors that feed it. Instead of each being an event,
+ * these functors are put in the bucket for their level, and a single
+ * sweep event runs the buckets in level order. A functor that is fed
+ * by several changing functors then runs only once, after all of its
+ * inputs have settled.
+ *
+ * The levels only put the functors in a good order. If a functor is
+ * put in a bucket at or below the level being run (the link between
+ * the two functors went through a net that the levelizer did not
+ * follow), the sweep simply goes back for it.
+ */
+static bool sched_levelized_flag = false;
+
+bool schedule_set_eval(const char*name)
+{
+      if (strcmp(name, "event") == 0) {
+	    sched_levelized_flag = false;
+	    return true;
+      }
+      if (strcmp(name, "levelized") == 0) {
+	    sched_levelized_flag = true;
+	    return true;
+      }
+      return false;
+}
+
+bool schedule_eval_levelized(void)
+{
+      return sched_levelized_flag;
+}
+
+static std::vector< std::vector<vvp_gen_event_t> > level_buckets;
+static std::vector<vvp_gen_event_t> level_work;
+static unsigned level_min = 0;
+static size_t level_pending = 0;
+
+struct level_sweep_s : public vvp_gen_event_s {
+      level_sweep_s() : scheduled(false) { }
+      ~level_sweep_s() { }
+      void run_run();
+
+      bool scheduled;
+};
+
+static level_sweep_s level_sweep;
+
+void level_sweep_s::run_run()
+{
+      while (level_pending > 0) {
+	    unsigned lev = level_min;
+	    while (level_buckets[lev].empty())
+		  lev += 1;
+	    level_min = lev;
+
+	    level_work.swap(level_buckets[lev]);
+	    level_pending -= level_work.size();
+	    for (size_t idx = 0 ; idx < level_work.size() ; idx += 1)
+		  level_work[idx]->run_run();
+	    level_work.clear();
+      }
+
+      scheduled = false;
+}
+
+void schedule_set_levels(unsigned count)
+{
+      level_buckets.resize(count);
+      level_min = count;
+}
+
+void schedule_levelized(vvp_gen_event_t obj, unsigned level)
+{
+      if (!sim_started) {
+	    schedule_functor(obj);
+	    return;
+      }
+
+      if (activity_flag)
+	    activity_event(0);
+
+      assert(level < level_buckets.size());
+      level_buckets[level].push_back(obj);
+      level_pending += 1;
+      if (level < level_min)
+	    level_min = level;
+
+      if (! level_sweep.scheduled) {
+	    level_sweep.scheduled = true;
+	    schedule_functor(&level_sweep);
+      }
+}
+
 void schedule_at_start_of_simtime(vvp_gen_event_t obj, vvp_time64_t delay)
 {
       struct generic_event_s*cur = new generic_event_s;
@@ -993,9 +1554,191 @@ void schedule_at_start_of_simtime(vvp_gen_event_t obj, vvp_time64_t delay)
       schedule_event_(cur, delay, SEQ_START);
 }
 
-static vvp_time64_t schedule_time;
-vvp_time64_t schedule_simtime(void)
-{ return schedule_time; }
+/*
+ * Checkpoint support. The time cells are saved in time order with
+ * the absolute time of each, and the events of each cell are saved
+ * by queue, so that they are restored in the same order.
+ */
+static bool checkpoint_cell_before_(const event_time_s*a, const event_time_s*b)
+{
+      return a->time < b->time;
+}
+
+static void checkpoint_cells_(std::vector<struct event_time_s*>&cells)
+{
+      if (sched_wheel_flag) {
+	    for (unsigned lev = 0 ; lev < WHEEL_LEVELS ; lev += 1) {
+		  for (unsigned slot = 0 ; slot < WHEEL_SLOTS ; slot += 1) {
+			for (struct event_time_s*cur = wheel_slot[lev][slot]
+				   ; cur ; cur = cur->next)
+			      cells.push_back(cur);
+		  }
+	    }
+	    for (wheel_index_t::iterator cur = wheel_overflow.begin()
+		       ; cur != wheel_overflow.end() ; ++ cur)
+		  cells.push_back(cur->second);
+	    std::sort(cells.begin(), cells.end(), checkpoint_cell_before_);
+
+      } else {
+	    vvp_time64_t time = schedule_time;
+	    for (struct event_time_s*cur = sched_list ; cur ; cur = cur->next) {
+		  time += cur->delay;
+		  cur->time = time;
+		  cells.push_back(cur);
+	    }
+      }
+}
+
+static const unsigned CHECKPOINT_QUEUES = 6;
+
+static struct event_s*& checkpoint_queue_(struct event_time_s*ctim, unsigned idx)
+{
+      switch (idx) {
+	  case SEQ_START:    return ctim->start;
+	  case SEQ_ACTIVE:   return ctim->active;
+	  case SEQ_NBASSIGN: return ctim->nbassign;
+	  case SEQ_RWSYNC:   return ctim->rwsync;
+	  case SEQ_ROSYNC:   return ctim->rosync;
+	  default:           return ctim->del_thr;
+      }
+}
+
+static struct event_s* checkpoint_make_event_(int kind)
+{
+      switch (kind) {
+	  case event_s::CP_EVENT_VTHREAD:
+	    return new vthread_event_s;
+	  case event_s::CP_EVENT_ASSIGN4:
+	    return new assign_vector4_event_s(vvp_vector4_t());
+	  case event_s::CP_EVENT_ASSIGN8:
+	    return new assign_vector8_event_s;
+	  case event_s::CP_EVENT_ASSIGNR:
+	    return new assign_real_event_s;
+	  case event_s::CP_EVENT_ARRAY_WORD:
+	    return new assign_array_word_s;
+	  case event_s::CP_EVENT_FORCE4:
+	    return new force_vector4_event_s(vvp_vector4_t());
+	  case event_s::CP_EVENT_PROPAGATE4:
+	    return new propagate_vector4_event_s(vvp_vector4_t());
+	  case event_s::CP_EVENT_PROPAGATER:
+	    return new propagate_real_event_s;
+	  case event_s::CP_EVENT_ARRAY_R_WORD:
+	    return new assign_array_r_word_s;
+	  case event_s::CP_EVENT_GENERIC:
+	    return new generic_event_s;
+	  default:
+	    return 0;
+      }
+}
+
+void schedule_checkpoint(vvp_checkpoint_t&cp)
+{
+      std::vector<struct event_time_s*> cells;
+      if (! cp.restoring())
+	    checkpoint_cells_(cells);
+
+      unsigned long ncells = cells.size();
+      cp.io(ncells);
+
+      for (unsigned long cdx = 0 ; cdx < ncells ; cdx += 1) {
+	    unsigned long long time = cp.restoring()? 0 : cells[cdx]->time;
+	    cp.io(time);
+
+	    for (unsigned qdx = 0 ; qdx < CHECKPOINT_QUEUES ; qdx += 1) {
+		  std::vector<struct event_s*> events;
+		  if (! cp.restoring() && checkpoint_queue_(cells[cdx], qdx)) {
+			struct event_s*last = checkpoint_queue_(cells[cdx], qdx);
+			struct event_s*cur = last;
+			do {
+			      cur = cur->next;
+			      int kind = cur->checkpoint_kind();
+			      if (kind == event_s::CP_EVENT_NONE)
+				    cp.unsupported("scheduled VPI callback or event");
+			      else if (kind != event_s::CP_EVENT_DROP)
+				    events.push_back(cur);
+			} while (cur != last);
+		  }
+
+		  unsigned long nevents = events.size();
+		  cp.io(nevents);
+		  for (unsigned long edx = 0 ; edx < nevents ; edx += 1) {
+			int kind = cp.restoring()? 0 : events[edx]->checkpoint_kind();
+			cp.io(kind);
+			struct event_s*cur = cp.restoring()
+			      ? checkpoint_make_event_(kind)
+			      : events[edx];
+			assert(cur);
+			cur->checkpoint(cp);
+			if (cp.restoring())
+			      schedule_event_(cur, time - schedule_time,
+					      (event_queue_t)qdx);
+		  }
+	    }
+      }
+}
+
+static void checkpoint_delete_list_(struct event_s*&list)
+{
+      while (list) {
+	    struct event_s*cur = list->next;
+	    if (cur->next == cur) {
+		  list = 0;
+	    } else {
+		  list->next = cur->next;
+	    }
+	    delete cur;
+      }
+}
+
+/*
+ * Drop all the events that the compile scheduled, so that the queue
+ * can be restored from a checkpoint. The events only point into the
+ * design, so they are deleted without running them.
+ */
+void schedule_checkpoint_discard(void)
+{
+      std::vector<struct event_time_s*> cells;
+      checkpoint_cells_(cells);
+
+      for (size_t cdx = 0 ; cdx < cells.size() ; cdx += 1) {
+	    for (unsigned qdx = 0 ; qdx < CHECKPOINT_QUEUES ; qdx += 1)
+		  checkpoint_delete_list_(checkpoint_queue_(cells[cdx], qdx));
+	    delete cells[cdx];
+      }
+
+      sched_list = 0;
+      for (unsigned lev = 0 ; lev < WHEEL_LEVELS ; lev += 1) {
+	    for (unsigned slot = 0 ; slot < WHEEL_SLOTS ; slot += 1)
+		  wheel_slot[lev][slot] = 0;
+	    for (unsigned wd = 0 ; wd < WHEEL_MAP_WORDS ; wd += 1)
+		  wheel_map[lev][wd] = 0;
+      }
+      wheel_upper.clear();
+      wheel_overflow.clear();
+      wheel_head = 0;
+      wheel_now = schedule_time;
+
+      checkpoint_delete_list_(schedule_final_list);
+}
+
+void schedule_checkpoint_final_threads(std::set<vthread_t>&threads)
+{
+      if (schedule_final_list == 0)
+	    return;
+
+      struct event_s*cur = schedule_final_list;
+      do {
+	    cur = cur->next;
+	    if (vthread_event_s*ev = dynamic_cast<vthread_event_s*>(cur))
+		  threads.insert(ev->thr);
+      } while (cur != schedule_final_list);
+}
+
+void schedule_checkpoint_set_time(vvp_time64_t val)
+{
+      schedule_time = val;
+      wheel_now = val;
+}
 
 extern void vpiEndOfCompile();
 extern void vpiStartOfSim();
@@ -1080,6 +1823,10 @@ void schedule_simulate(void)
 	    delete cur;
       }
 
+	// If the simulation is being restarted from a checkpoint,
+	// replace the initial state with the saved state.
+      checkpoint_start();
+
       if (verbose_flag) {
 	    vpi_mcd_printf(1, " ...execute StartOfSim callbacks\n");
       }
@@ -1099,7 +1846,9 @@ void schedule_simulate(void)
       // process events and when done run the final blocks.
       run_finals = schedule_runnable;
 
-      if (schedule_runnable) while (sched_list) {
+      bool profile_flag = profile_enabled();
+
+      if (schedule_runnable) while (sched_peek_time_()) {
 
 	    if (schedule_stopped_flag) {
 		  schedule_stopped_flag = false;
@@ -1110,14 +1859,21 @@ void schedule_simulate(void)
 	    }
 
 	      /* ctim is the current time step. */
-	    struct event_time_s* ctim = sched_list;
+	    struct event_time_s* ctim = sched_peek_time_();
 
 	      /* If the time is advancing, then first run the
 		 postponed sync events. Run them all. */
 	    if (ctim->delay > 0) {
 
 		  if (!schedule_runnable) break;
+		    /* This is the point between time steps where a
+		       checkpoint can be taken. */
+		  checkpoint_time_step(schedule_time + ctim->delay);
+		  if (profile_flag)
+			profile_time_step();
 		  schedule_time += ctim->delay;
+		  if (activity_flag)
+			activity_step(schedule_time);
 		    /* When the design is being traced (we are emitting
 		     * file/line information) also print any time changes. */
 		  if (show_file_line) {
@@ -1147,17 +1903,21 @@ void schedule_simulate(void)
 	    if (ctim->active == 0) {
 		  ctim->active = ctim->nbassign;
 		  ctim->nbassign = 0;
+		  if (activity_flag && ctim->active)
+			activity_delta();
 
 		  if (ctim->active == 0) {
 			ctim->active = ctim->rwsync;
 			ctim->rwsync = 0;
+			if (activity_flag && ctim->active)
+			      activity_delta();
 
 			  /* If out of rw events, then run the rosync
 			     events and delete this time step. This also
 			     deletes threads as needed. */
 			if (ctim->active == 0) {
 			      run_rosync(ctim);
-			      sched_list = ctim->next;
+			      sched_pop_time_(ctim);
 			      delete ctim;
 			      continue;
 			}
@@ -1180,7 +1940,16 @@ void schedule_simulate(void)
 		  schedule_single_step_flag = false;
 	    }
 
-	    cur->run_run();
+	    if (activity_flag)
+		  activity_run();
+
+	    if (profile_flag) {
+		  profile_event_type = &cur->profile_type();
+		  cur->run_run();
+		  profile_event_type = 0;
+	    } else {
+		  cur->run_run();
+	    }
 
 	    delete (cur);
       }
@@ -139,6 +139,26 @@ extern void schedule_generic(vvp_gen_event_t obj, vvp_time64_t delay,
 */
 extern void schedule_functor(vvp_gen_event_t obj);
 
+/*
+ * Select how the combinational functors are evaluated. The name is
+ * "event" (the default, each functor that changes is an event) or
+ * "levelized" (the boolean functors outside of feedback loops are
+ * sorted by level when the design is linked, and the functors that
+ * change are run in level order by one sweep). This must be called
+ * before the design is compiled. The function returns false if the
+ * name is not known.
+ */
+extern bool schedule_set_eval(const char*name);
+extern bool schedule_eval_levelized(void);
+
+/*
+ * Make room for levels 0 to count-1, and schedule a levelized functor
+ * to run in the sweep with the functors of its level. Before the
+ * simulation starts this is the same as schedule_functor().
+ */
+extern void schedule_set_levels(unsigned count);
+extern void schedule_levelized(vvp_gen_event_t obj, unsigned level);
+
 extern void schedule_at_start_of_simtime(vvp_gen_event_t obj, vvp_time64_t delay);
 
 /* Use this is schedule thread deletion (after rosync). */
@@ -151,6 +171,15 @@ struct vvp_gen_event_s
       virtual void single_step_display(void);
 };
 
+/*
+ * Select the data structure that holds the pending time steps. The
+ * name is "list" (the default sorted list) or "wheel" (a hierarchical
+ * timing wheel). This must be called before any events are
+ * scheduled. The function returns false if the name is not known.
+ */
+extern bool schedule_set_time_queue(const char*name);
+extern const char* schedule_time_queue(void);
+
 /*
  * This runs the simulator. It runs until all the functors run out or
  * the simulation is otherwise finished.
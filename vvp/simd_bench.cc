@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * This is a micro-benchmark for the vvp_simd kernels. It first checks
+ * that every kernel table that the CPU supports gets the same results
+ * as the scalar table, then times each kernel on 512, 1024 and 4096
+ * bit vectors. Build it with "make simd_bench" in the vvp directory.
+ *
+ *    simd_bench [<iterations>]
+ */
+
+# include  "vvp_simd.h"
+# include  <cstdio>
+# include  <cstdlib>
+# include  <cstring>
+# include  <ctime>
+
+static const char*table_names[] = { "scalar", "sse4.2", "avx2" };
+static const unsigned ntables = sizeof table_names / sizeof table_names[0];
+
+enum { MAX_WORDS = 4096 / (8*sizeof(unsigned long)) + 3 };
+
+static unsigned long random_word()
+{
+      unsigned long res = 0;
+      for (unsigned idx = 0 ; idx < sizeof(unsigned long) ; idx += 1)
+	    res = (res << 8) | (rand() & 0xff);
+      return res;
+}
+
+/*
+ * Fill the arrays with values where the bbits are mostly clear, so
+ * that the 4-value paths see a mix of 0/1 and X/Z bits.
+ */
+static void fill(unsigned long*a, unsigned long*b, unsigned n, bool two_state)
+{
+      for (unsigned idx = 0 ; idx < n ; idx += 1) {
+	    a[idx] = random_word();
+	    b[idx] = two_state? 0 : (random_word() & random_word() & random_word());
+      }
+}
+
+static bool check_table(const vvp_simd_ops_s*ref, const vvp_simd_ops_s*ops)
+{
+      unsigned long a1[MAX_WORDS], b1[MAX_WORDS], a2[MAX_WORDS], b2[MAX_WORDS];
+      unsigned long xa[MAX_WORDS], xb[MAX_WORDS];
+      bool ok = true;
+
+      for (unsigned pass = 0 ; pass < 2000 ; pass += 1) {
+	    unsigned n = pass % MAX_WORDS;
+	    fill(a1, b1, n, pass%3 == 0);
+	    fill(xa, xb, n, pass%5 == 0);
+	    if (pass%7 == 0) {
+		  memcpy(xa, a1, sizeof a1);
+		  memcpy(xb, b1, sizeof b1);
+	    }
+
+	    memcpy(a2, a1, sizeof a1);
+	    memcpy(b2, b1, sizeof b1);
+	    ref->and4(a1, b1, xa, xb, n);
+	    ops->and4(a2, b2, xa, xb, n);
+	    ok &= memcmp(a1, a2, n*sizeof a1[0]) == 0 && memcmp(b1, b2, n*sizeof b1[0]) == 0;
+
+	    ref->or4(a1, b1, xa, xb, n);
+	    ops->or4(a2, b2, xa, xb, n);
+	    ok &= memcmp(a1, a2, n*sizeof a1[0]) == 0 && memcmp(b1, b2, n*sizeof b1[0]) == 0;
+
+	    ref->xor4(a1, b1, xa, xb, n);
+	    ops->xor4(a2, b2, xa, xb, n);
+	    ok &= memcmp(a1, a2, n*sizeof a1[0]) == 0 && memcmp(b1, b2, n*sizeof b1[0]) == 0;
+
+	    ref->invert4(a1, b1, n);
+	    ops->invert4(a2, b2, n);
+	    ok &= memcmp(a1, a2, n*sizeof a1[0]) == 0;
+
+	    ok &= ref->eq(a1, xa, n) == ops->eq(a1, xa, n);
+	    ok &= ref->eq(xa, xa, n) == ops->eq(xa, xa, n);
+	    ok &= ref->eq_xz(a1, b1, xa, xb, n) == ops->eq_xz(a1, b1, xa, xb, n);
+	    ok &= ref->eq_xz(xa, xb, xa, xb, n) == ops->eq_xz(xa, xb, xa, xb, n);
+	    ok &= ref->any(b1, n) == ops->any(b1, n);
+	    ok &= ref->any(xb, n) == ops->any(xb, n);
+
+	    vvp_simd_reduce_s r1 = { 0, 0, 0, 0 };
+	    vvp_simd_reduce_s r2 = { 0, 0, 0, 0 };
+	    ref->reduce(xa, xb, n, r1);
+	    ops->reduce(xa, xb, n, r2);
+	    ok &= r1.zeros == r2.zeros && r1.ones == r2.ones
+		  && r1.xz == r2.xz && r1.parity == r2.parity;
+
+	    if (! ok) {
+		  fprintf(stderr, "%s: mismatch with %u words\n", ops->name, n);
+		  return false;
+	    }
+      }
+
+      return true;
+}
+
+static double elapsed(clock_t start)
+{
+      return 1e9 * (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void time_table(const vvp_simd_ops_s*ops, unsigned bits, unsigned long iter)
+{
+      unsigned long a[MAX_WORDS], b[MAX_WORDS], xa[MAX_WORDS], xb[MAX_WORDS];
+      unsigned n = bits / (8*sizeof(unsigned long));
+      volatile unsigned long sink = 0;
+
+      fill(a, b, n, false);
+      fill(xa, xb, n, false);
+      memset(b, 0, sizeof b);
+
+      clock_t start = clock();
+      for (unsigned long idx = 0 ; idx < iter ; idx += 1)
+	    ops->and4(a, b, xa, xb, n);
+      double t_and = elapsed(start) / iter;
+
+      start = clock();
+      for (unsigned long idx = 0 ; idx < iter ; idx += 1)
+	    ops->or4(a, b, xa, xb, n);
+      double t_or = elapsed(start) / iter;
+
+      start = clock();
+      for (unsigned long idx = 0 ; idx < iter ; idx += 1)
+	    ops->invert4(a, xb, n);
+      double t_inv = elapsed(start) / iter;
+
+      start = clock();
+      for (unsigned long idx = 0 ; idx < iter ; idx += 1)
+	    sink += ops->eq(a, a, n);
+      double t_eq = elapsed(start) / iter;
+
+	// The any scan must see all the words to be a fair test.
+      memset(b, 0, sizeof b);
+      start = clock();
+      for (unsigned long idx = 0 ; idx < iter ; idx += 1)
+	    sink += ops->any(b, n);
+      double t_any = elapsed(start) / iter;
+
+      start = clock();
+      for (unsigned long idx = 0 ; idx < iter ; idx += 1) {
+	    vvp_simd_reduce_s res = { 0, 0, 0, 0 };
+	    ops->reduce(a, xb, n, res);
+	    sink += res.parity;
+      }
+      double t_red = elapsed(start) / iter;
+
+      printf("%-8s %5u %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f\n", ops->name, bits,
+	     t_and, t_or, t_inv, t_eq, t_any, t_red);
+}
+
+int main(int argc, char*argv[])
+{
+      unsigned long iter = argc > 1? strtoul(argv[1], 0, 0) : 1000000;
+      const vvp_simd_ops_s*ref = vvp_simd_find("scalar");
+      int rc = 0;
+
+      printf("selected kernels: %s\n", vvp_simd->name);
+      printf("%-8s %5s %8s %8s %8s %8s %8s %8s  (ns/call)\n", "kernels", "bits",
+	     "and", "or", "invert", "eq", "any", "reduce");
+
+      for (unsigned idx = 0 ; idx < ntables ; idx += 1) {
+	    const vvp_simd_ops_s*ops = vvp_simd_find(table_names[idx]);
+	    if (ops == 0) {
+		  printf("%-8s not supported\n", table_names[idx]);
+		  continue;
+	    }
+	    if (! check_table(ref, ops)) {
+		  rc = 1;
+		  continue;
+	    }
+	    time_table(ops, 512, iter);
+	    time_table(ops, 1024, iter);
+	    time_table(ops, 4096, iter/4);
+      }
+
+      return rc;
+}
@@ -26,6 +26,8 @@ unsigned long count_opcodes = 0;
 
 unsigned long count_functors = 0;
 unsigned long count_functors_logic = 0;
+unsigned long count_functors_levelized = 0;
+unsigned long count_net_levels = 0;
 unsigned long count_functors_bufif = 0;
 unsigned long count_functors_resolv= 0;
 unsigned long count_functors_sig   = 0;
@@ -29,6 +29,8 @@
 extern unsigned long count_opcodes;
 extern unsigned long count_functors;
 extern unsigned long count_functors_logic;
+extern unsigned long count_functors_levelized;
+extern unsigned long count_net_levels;
 extern unsigned long count_functors_bufif;
 extern unsigned long count_functors_resolv;
 extern unsigned long count_functors_sig;
@@ -19,6 +19,7 @@
 
 # include  "compile.h"
 # include  "vvp_net.h"
+# include  "checkpoint.h"
 # include  <cstdlib>
 # include  <iostream>
 # include  <cassert>
@@ -36,6 +37,8 @@ class vvp_fun_substitute : public vvp_net_fun_t {
 			unsigned base, unsigned wid, unsigned vwid,
                         vvp_context_t ctx);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       unsigned wid_;
       unsigned soff_;
@@ -55,6 +58,11 @@ vvp_fun_substitute::~vvp_fun_substitute()
 {
 }
 
+void vvp_fun_substitute::checkpoint(vvp_checkpoint_t&cp)
+{
+      cp.io(val_);
+}
+
 void vvp_fun_substitute::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
 				   vvp_context_t)
 {
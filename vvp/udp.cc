@@ -22,6 +22,7 @@
 
 #include "udp.h"
 #include "schedule.h"
+#include "checkpoint.h"
 #include "symbols.h"
 #include "compile.h"
 #include "config.h"
@@ -915,6 +916,15 @@ vvp_udp_fun_core::~vvp_udp_fun_core()
 {
 }
 
+void vvp_udp_fun_core::checkpoint(vvp_checkpoint_t&cp)
+{
+      vvp_wide_fun_core::checkpoint(cp);
+      cp.io(cur_out_);
+      cp.io(current_.mask0);
+      cp.io(current_.mask1);
+      cp.io(current_.maskx);
+}
+
 /*
  * This method is used to propagate the initial value on startup.
  */
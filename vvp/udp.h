@@ -230,6 +230,8 @@ class vvp_udp_fun_core  : public vvp_wide_fun_core, private vvp_gen_event_s {
 
       void recv_vec4_from_inputs(unsigned);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       void run_run();
 
@@ -409,6 +409,10 @@ static simulator_callback*NextSimTime = 0;
 static simulator_callback*EndOfCompile = 0;
 static simulator_callback*StartOfSimulation = 0;
 static simulator_callback*EndOfSimulation = 0;
+static simulator_callback*StartOfSave = 0;
+static simulator_callback*EndOfSave = 0;
+static simulator_callback*StartOfRestart = 0;
+static simulator_callback*EndOfRestart = 0;
 
 #ifdef CHECK_WITH_VALGRIND
 /* This is really only needed if the simulator aborts before starting the
@@ -523,6 +527,45 @@ void vpiNextSimTime(void)
       vpi_mode_flag = VPI_MODE_NONE;
 }
 
+/*
+ * The save and restart callbacks are called each time a checkpoint
+ * is saved or restored, so they are not freed when they run. A
+ * removed callback has its function cleared and is skipped.
+ */
+void vpiSaveRestart(PLI_INT32 reason)
+{
+      simulator_callback*cur = 0;
+
+      switch (reason) {
+	  case cbStartOfSave:
+	    cur = StartOfSave;
+	    break;
+	  case cbEndOfSave:
+	    cur = EndOfSave;
+	    break;
+	  case cbStartOfRestart:
+	    cur = StartOfRestart;
+	    break;
+	  case cbEndOfRestart:
+	    cur = EndOfRestart;
+	    break;
+	  default:
+	    assert(0);
+	    break;
+      }
+
+      const vpi_mode_t save_mode = vpi_mode_flag;
+      vpi_mode_flag = VPI_MODE_RWSYNC;
+
+      for ( ; cur ; cur = dynamic_cast<simulator_callback*>(cur->next)) {
+	    if (cur->cb_data.cb_rtn == 0)
+		  continue;
+	    (cur->cb_data.cb_rtn)(&cur->cb_data);
+      }
+
+      vpi_mode_flag = save_mode;
+}
+
 static simulator_callback* make_prepost(p_cb_data data)
 {
       simulator_callback*obj = new simulator_callback(data);
@@ -544,6 +587,23 @@ static simulator_callback* make_prepost(p_cb_data data)
 	  case cbNextSimTime:
 	    obj->next = NextSimTime;
 	    NextSimTime = obj;
+	    break;
+	  case cbStartOfSave:
+	    obj->next = StartOfSave;
+	    StartOfSave = obj;
+	    break;
+	  case cbEndOfSave:
+	    obj->next = EndOfSave;
+	    EndOfSave = obj;
+	    break;
+	  case cbStartOfRestart:
+	    obj->next = StartOfRestart;
+	    StartOfRestart = obj;
+	    break;
+	  case cbEndOfRestart:
+	    obj->next = EndOfRestart;
+	    EndOfRestart = obj;
+	    break;
       }
 
       return obj;
@@ -580,6 +640,10 @@ vpiHandle vpi_register_cb(p_cb_data data)
 	  case cbStartOfSimulation:
 	  case cbEndOfSimulation:
 	  case cbNextSimTime:
+	  case cbStartOfSave:
+	  case cbEndOfSave:
+	  case cbStartOfRestart:
+	  case cbEndOfRestart:
 	    obj = make_prepost(data);
 	    break;
 
@@ -679,8 +743,7 @@ void vvp_vpi_callback::add_vpi_callback(value_callback*cb)
 void vvp_vpi_callback::clear_all_callbacks()
 {
       while (vpi_callbacks_) {
-	    value_callback *tmp = dynamic_cast<value_callback*>
-	                            (vpi_callbacks_->next);
+	    value_callback *tmp = vpi_callbacks_->next_value();
 	    delete vpi_callbacks_;
 	    vpi_callbacks_ = tmp;
       }
@@ -711,7 +774,7 @@ void vvp_vpi_callback::run_vpi_callbacks()
 
       while (next) {
 	    value_callback*cur = next;
-	    next = dynamic_cast<value_callback*>(cur->next);
+	    next = cur->next_value();
 
 	    if (cur->cb_data.cb_rtn != 0) {
 		  if (cur->test_value_callback_ready()) {
@@ -756,14 +819,32 @@ void vvp_signal_value::get_signal_value(struct t_vpi_value*vp)
 	  case vpiStringVal:
 	  case vpiRealVal: {
 	    unsigned wid = value_size();
-	    vvp_vector4_t vec4(wid);
-	    for (unsigned idx = 0; idx < wid; idx += 1) {
-		  vec4.set_bit(idx, value(idx));
+	    const vvp_vector4_t*ref = vec4_value_ref();
+	    if (ref) {
+		  vpip_vec4_get_value(*ref, wid, false, vp);
+		  break;
 	    }
+	    vvp_vector4_t vec4;
+	    vec4_value(vec4);
 	    vpip_vec4_get_value(vec4, wid, false, vp);
 	    break;
 	  }
 
+	  case _vpiRawVal: {
+	      // Hand out the words of the signal itself if it has
+	      // them. They do not change until the next call into
+	      // the VPI (or the simulation moves on).
+	    const vvp_vector4_t*ref = vec4_value_ref();
+	    if (ref && ref->size() == value_size()) {
+		  vpip_vec4_get_rawval(*ref, vp);
+		  break;
+	    }
+	    vvp_vector4_t vec4;
+	    vec4_value(vec4);
+	    vpip_vec4_get_value(vec4, value_size(), false, vp);
+	    break;
+	  }
+
 	  case vpiSuppressVal:
 	    break;
 
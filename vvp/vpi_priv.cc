@@ -20,6 +20,7 @@
 # include  "version_base.h"
 # include  "vpi_priv.h"
 # include  "schedule.h"
+# include  "checkpoint.h"
 #ifdef CHECK_WITH_VALGRIND
 # include  "vvp_cleanup.h"
 #endif
@@ -276,6 +277,9 @@ static int vpip_get_global(int property)
 	  case vpiTimePrecision:
 	    return vpip_get_time_precision();
 
+	  case vpiSaveRestartID:
+	    return checkpoint_save_restart_id();
+
 	  default:
 	    fprintf(stderr, "vpi error: bad global property: %d\n", property);
 	    assert(0);
@@ -429,6 +433,10 @@ char* vpi_get_str(PLI_INT32 property, vpiHandle ref)
 	    }
       }
 
+	/* The checkpoint file is a global property. */
+      if (property == vpiSaveRestartLocation && ref == 0)
+	    return simple_set_rbuf_str(checkpoint_save_restart_location());
+
       if (ref == 0) {
 	    fprintf(stderr, "vpi error: vpi_get_str(%s, 0) called "
 		    "with null vpiHandle.\n", vpi_property_str(property));
@@ -767,9 +775,40 @@ void vpip_vec4_get_value(const vvp_vector4_t&word_val, unsigned width,
 	  case vpiRealVal:
 		vector4_to_value(word_val, vp->value.real, signed_flag);
 		break;
+
+	  case _vpiRawVal: {
+		  // The word_val may be a temporary, so hand out the
+		  // words of a copy that lives until the next call.
+		static vvp_vector4_t raw_copy;
+		raw_copy = word_val;
+		if (raw_copy.size() != width)
+		      raw_copy.resize(width);
+		vpip_vec4_get_rawval(raw_copy, vp);
+		break;
+	  }
       }
 }
 
+/*
+ * Fill the s_vpi_rawval that value.misc points at with the words of
+ * the vector itself. Nothing is copied, so the caller must keep the
+ * vector unchanged for as long as the value may be used.
+ */
+void vpip_vec4_get_rawval(const vvp_vector4_t&val, s_vpi_value*vp)
+{
+      s_vpi_rawval*rp = (s_vpi_rawval*)vp->value.misc;
+      if (rp == 0) {
+	    fprintf(stderr, "vpi error: The _vpiRawVal format needs "
+		    "value.misc to point at a s_vpi_rawval.\n");
+	    return;
+      }
+
+      rp->size = val.size();
+      rp->word_bits = 8*sizeof(unsigned long);
+      rp->aval = val.abits_words();
+      rp->bval = val.bbits_words();
+}
+
 void vpip_vec2_get_value(const vvp_vector2_t&word_val, unsigned width,
 			 bool signed_flag, s_vpi_value*vp)
 {
@@ -191,6 +191,12 @@ class value_callback : public __vpiCallback {
 	// Return true if the callback really is ready to be called
       virtual bool test_value_callback_ready(void);
 
+	// The list of callbacks on a signal only ever holds value
+	// callbacks, so the next link can be followed without a
+	// dynamic_cast.
+      inline value_callback* next_value(void) const
+      { return static_cast<value_callback*>(next); }
+
     public:
 	// user supplied callback data
       struct t_vpi_time cb_time;
@@ -972,6 +978,7 @@ extern double real_from_vpi_value(s_vpi_value*vp);
 
 extern void vpip_vec4_get_value(const vvp_vector4_t&word_val, unsigned width,
 				bool signed_flag, s_vpi_value*vp);
+extern void vpip_vec4_get_rawval(const vvp_vector4_t&val, s_vpi_value*vp);
 extern void vpip_vec2_get_value(const vvp_vector2_t&word_val, unsigned width,
 				bool signed_flag, s_vpi_value*vp);
 extern void vpip_real_get_value(double real, s_vpi_value*vp);
@@ -28,6 +28,7 @@
 # include  "vvp_cobject.h"
 # include  "vvp_darray.h"
 # include  "class_type.h"
+# include  "checkpoint.h"
 #ifdef CHECK_WITH_VALGRIND
 # include  "vvp_cleanup.h"
 #endif
@@ -118,13 +119,17 @@ struct vthread_s {
       vector<unsigned> args_str;
       vector<unsigned> args_vec4;
 
+	/* The stacks keep their capacity as values are pushed and
+	   popped, and values are moved in and out of them where the
+	   compiler allows, so that in the steady state the stacks
+	   themselves do not use the heap. */
     private:
       vector<vvp_vector4_t>stack_vec4_;
     public:
       inline vvp_vector4_t pop_vec4(void)
       {
 	    assert(! stack_vec4_.empty());
-	    vvp_vector4_t val = stack_vec4_.back();
+	    vvp_vector4_t val (VVP_MOVE(stack_vec4_.back()));
 	    stack_vec4_.pop_back();
 	    return val;
       }
@@ -132,6 +137,12 @@ struct vthread_s {
       {
 	    stack_vec4_.push_back(val);
       }
+#if __cplusplus >= 201103L
+      inline void push_vec4(vvp_vector4_t&&val)
+      {
+	    stack_vec4_.push_back(std::move(val));
+      }
+#endif
       inline const vvp_vector4_t& peek_vec4(unsigned depth)
       {
 	    unsigned size = stack_vec4_.size();
@@ -205,7 +216,8 @@ struct vthread_s {
       inline string pop_str(void)
       {
 	    assert(! stack_str_.empty());
-	    string val = stack_str_.back();
+	    string val;
+	    val.swap(stack_str_.back());
 	    stack_str_.pop_back();
 	    return val;
       }
@@ -213,6 +225,12 @@ struct vthread_s {
       {
 	    stack_str_.push_back(val);
       }
+#if __cplusplus >= 201103L
+      inline void push_str(string&&val)
+      {
+	    stack_str_.push_back(std::move(val));
+      }
+#endif
       inline string&peek_str(unsigned depth)
       {
 	    assert(depth<stack_str_.size());
@@ -310,6 +328,9 @@ struct vthread_s {
 	    assert(stack_str_.empty());
 	    assert(stack_obj_size_ == 0);
       }
+
+	/* Save or restore the state of the thread. */
+      void checkpoint(vvp_checkpoint_t&cp);
 };
 
 inline vthread_s::vthread_s()
@@ -347,6 +368,19 @@ __vpiScope* vthread_scope(struct vthread_s*thr)
 
 struct vthread_s*running_thread = 0;
 
+bool vthread_running_pc(vvp_code_t&pc, __vpiScope*&scope)
+{
+      struct vthread_s*thr = running_thread;
+      if (thr == 0)
+	    return false;
+
+	// The pc is stepped before the opcode runs, so the opcode
+	// that is executing is the one before it.
+      pc = thr->pc - 1;
+      scope = thr->parent_scope;
+      return true;
+}
+
 
 void vthread_push_vec4(struct vthread_s*thr, const vvp_vector4_t&val)
 {
@@ -680,11 +714,239 @@ void vthread_delay_delete()
 	    running_thread->delay_delete = 1;
 }
 
+static void checkpoint_thread_set(vvp_checkpoint_t&cp, set<vthread_t>&threads)
+{
+      unsigned long count = threads.size();
+      cp.io(count);
+      if (cp.restoring()) {
+	    for (unsigned long idx = 0 ; idx < count ; idx += 1) {
+		  vthread_t thr = 0;
+		  cp.io_thread(thr);
+		  if (thr) threads.insert(thr);
+	    }
+      } else {
+	    for (set<vthread_t>::iterator cur = threads.begin()
+		       ; cur != threads.end() ; ++cur) {
+		  vthread_t thr = *cur;
+		  cp.io_thread(thr);
+	    }
+      }
+}
+
+/*
+ * The wait_next links of the thread are not saved here. They are
+ * made again from the lists of the events that the threads wait on,
+ * and a thread that is only scheduled has no wait_next.
+ */
+void vthread_s::checkpoint(vvp_checkpoint_t&cp)
+{
+      unsigned long pc_idx = cp.restoring()? 0 : codespace_index(pc);
+      cp.io(pc_idx);
+      if (cp.restoring())
+	    pc = codespace_at(pc_idx);
+
+      for (unsigned idx = 0 ; idx < FLAGS_COUNT ; idx += 1)
+	    cp.io(flags[idx]);
+      for (unsigned idx = 0 ; idx < WORDS_COUNT ; idx += 1)
+	    cp.io(words[idx].w_uint);
+
+      vector<unsigned>*args[3] = { &args_real, &args_str, &args_vec4 };
+      for (unsigned idx = 0 ; idx < 3 ; idx += 1) {
+	    unsigned long count = args[idx]->size();
+	    cp.io(count);
+	    args[idx]->resize(count);
+	    for (unsigned long adx = 0 ; adx < count ; adx += 1)
+		  cp.io((*args[idx])[adx]);
+      }
+
+      unsigned long count = stack_vec4_.size();
+      cp.io(count);
+      stack_vec4_.resize(count);
+      for (unsigned long idx = 0 ; idx < count ; idx += 1)
+	    cp.io(stack_vec4_[idx]);
+
+      count = stack_real_.size();
+      cp.io(count);
+      stack_real_.resize(count);
+      for (unsigned long idx = 0 ; idx < count ; idx += 1)
+	    cp.io(stack_real_[idx]);
+
+      count = stack_str_.size();
+      cp.io(count);
+      stack_str_.resize(count);
+      for (unsigned long idx = 0 ; idx < count ; idx += 1)
+	    cp.io(stack_str_[idx]);
+
+      if (stack_obj_size_ > 0 && ! cp.restoring())
+	    cp.unsupported("class objects on a thread stack");
+      if ((wt_context || rd_context) && ! cp.restoring())
+	    cp.unsupported("thread in an automatic task or function");
+
+      bool bits[9] = { i_am_joining != 0, i_am_detached != 0,
+		       i_am_waiting != 0, i_am_in_function != 0,
+		       i_have_ended != 0, i_was_disabled != 0,
+		       waiting_for_event != 0, is_scheduled != 0,
+		       delay_delete != 0 };
+      for (unsigned idx = 0 ; idx < 9 ; idx += 1)
+	    cp.io(bits[idx]);
+      i_am_joining      = bits[0];
+      i_am_detached     = bits[1];
+      i_am_waiting      = bits[2];
+      i_am_in_function  = bits[3];
+      i_have_ended      = bits[4];
+      i_was_disabled    = bits[5];
+      waiting_for_event = bits[6];
+      is_scheduled      = bits[7];
+      delay_delete      = bits[8];
+
+      checkpoint_thread_set(cp, children);
+      checkpoint_thread_set(cp, detached_children);
+      checkpoint_thread_set(cp, task_func_children);
+      cp.io_thread(parent);
+
+      cp.io_net(event);
+      cp.io(ecount);
+
+	// A final thread is scheduled in the final list, which is
+	// not part of the event queue.
+      bool final_flag = cp.restoring()? false : checkpoint_thread_is_final(this);
+      cp.io(final_flag);
+      if (cp.restoring() && final_flag) {
+	    is_scheduled = 0;
+	    schedule_final_vthread(this);
+      }
+}
+
+/*
+ * The threads are saved in two passes. The first pass saves the
+ * scope of each thread, so that the restore can make all the thread
+ * objects before any of the links between them are restored.
+ */
+void vthread_checkpoint(vvp_checkpoint_t&cp, std::vector<vthread_t>&threads)
+{
+      unsigned long count = threads.size();
+      cp.io(count);
+
+      for (unsigned long idx = 0 ; idx < count ; idx += 1) {
+	    __vpiScope*scope = cp.restoring()? 0 : threads[idx]->parent_scope;
+	    cp.io_scope(scope);
+	    if (cp.restoring()) {
+		  assert(scope);
+		  threads.push_back(vthread_new(codespace_null(), scope));
+	    }
+      }
+
+      for (unsigned long idx = 0 ; idx < count ; idx += 1)
+	    threads[idx]->checkpoint(cp);
+}
+
+/*
+ * Save or restore a list of threads that are linked by wait_next.
+ * Threads that have already been reaped are not saved, so they are
+ * dropped from the list.
+ */
+void vthread_checkpoint_list(vvp_checkpoint_t&cp, vthread_t&list)
+{
+      vector<vthread_t> items;
+      for (vthread_t cur = list ; cur && ! cp.restoring() ; cur = cur->wait_next) {
+	    if (checkpoint_thread_index(cur) != 0)
+		  items.push_back(cur);
+      }
+
+      unsigned long count = items.size();
+      cp.io(count);
+      items.resize(count);
+      for (unsigned long idx = 0 ; idx < count ; idx += 1)
+	    cp.io_thread(items[idx]);
+
+      if (! cp.restoring())
+	    return;
+
+      list = 0;
+      for (unsigned long idx = count ; idx > 0 ; idx -= 1) {
+	    vthread_t thr = items[idx-1];
+	    if (thr == 0) continue;
+	    thr->wait_next = list;
+	    list = thr;
+      }
+}
+
+/*
+ * Delete the threads that the compile made. They have not run yet,
+ * so they are not waiting on anything, and the caller has already
+ * dropped their events from the scheduler.
+ */
+void vthread_checkpoint_discard(std::vector<vthread_t>&threads)
+{
+      for (size_t idx = 0 ; idx < threads.size() ; idx += 1) {
+	    vthread_t thr = threads[idx];
+	    thr->parent_scope->threads.erase(thr);
+	    vthread_delete(thr);
+      }
+      threads.clear();
+}
+
 /*
  * This function runs each thread by fetching an instruction,
  * incrementing the PC, and executing the instruction. The thread may
  * be the head of a list, so each thread is run so far as possible.
  */
+static bool vthread_threaded_flag = false;
+static const void*const* vthread_run_threaded_(vthread_t thr);
+
+bool vthread_set_dispatch(const char*name)
+{
+      if (strcmp(name, "call") == 0) {
+	    vthread_threaded_flag = false;
+	    return true;
+      }
+      if (strcmp(name, "threaded") == 0) {
+	    vthread_threaded_flag = true;
+	    return true;
+      }
+      return false;
+}
+
+const char* vthread_dispatch(void)
+{
+      return vthread_threaded_flag? "threaded" : "call";
+}
+
+static bool vthread_profile_flag = false;
+
+void vthread_set_profile(bool flag)
+{
+      vthread_profile_flag = flag;
+}
+
+static inline void vthread_run_call_(vthread_t thr)
+{
+      for (;;) {
+	    vvp_code_t cp = thr->pc;
+	    thr->pc += 1;
+
+	      /* Run the opcode implementation. If the execution of
+		 the opcode returns false, then the thread is meant to
+		 be paused, so break out of the loop. */
+	    bool rc = (cp->opcode)(thr, cp);
+	    if (rc == false)
+		  break;
+      }
+}
+
+static inline void vthread_run_profile_(vthread_t thr)
+{
+      for (;;) {
+	    vvp_code_t cp = thr->pc;
+	    thr->pc += 1;
+	    cp->exec_count += 1;
+
+	    bool rc = (cp->opcode)(thr, cp);
+	    if (rc == false)
+		  break;
+      }
+}
+
 void vthread_run(vthread_t thr)
 {
       while (thr != 0) {
@@ -696,17 +958,12 @@ void vthread_run(vthread_t thr)
 
             running_thread = thr;
 
-	    for (;;) {
-		  vvp_code_t cp = thr->pc;
-		  thr->pc += 1;
-
-		    /* Run the opcode implementation. If the execution of
-		       the opcode returns false, then the thread is meant to
-		       be paused, so break out of the loop. */
-		  bool rc = (cp->opcode)(thr, cp);
-		  if (rc == false)
-			break;
-	    }
+	    if (vthread_profile_flag)
+		  vthread_run_profile_(thr);
+	    else if (vthread_threaded_flag)
+		  vthread_run_threaded_(thr);
+	    else
+		  vthread_run_call_(thr);
 
 	    thr = tmp;
       }
@@ -1854,6 +2111,27 @@ static void do_CMPU(vthread_t thr, const vvp_vector4_t&lval, const vvp_vector4_t
       assert(rval.size() == lval.size());
       unsigned wid = lval.size();
 
+	// If both operands are known to be two-state, compare the
+	// words in place, from the most significant down.
+      if (lval.is_two_state() && rval.is_two_state()) {
+	    unsigned words = (wid+CPU_WORD_BITS-1) / CPU_WORD_BITS;
+	    for (unsigned wdx = words ; wdx > 0 ; wdx -= 1) {
+		  unsigned long lword = lval.two_state_word(wdx-1);
+		  unsigned long rword = rval.two_state_word(wdx-1);
+		  if (lword == rword)
+			continue;
+
+		  eq = BIT4_0;
+		  lt = (lword < rword)? BIT4_1 : BIT4_0;
+		  break;
+	    }
+
+	    thr->flags[4] = eq;
+	    thr->flags[5] = lt;
+	    thr->flags[6] = eq;
+	    return;
+      }
+
       unsigned long*larray = lval.subarray(0,wid);
       if (larray == 0) return of_CMPU_the_hard_way(thr, wid, lval, rval);
 
@@ -3353,7 +3631,7 @@ bool of_IX_VEC4_S(vthread_t thr, vvp_code_t cp)
  * counter from the instruction and resuming. If the jump is
  * conditional, then test the bit for the expected value first.
  */
-bool of_JMP(vthread_t thr, vvp_code_t cp)
+static inline bool do_JMP(vthread_t thr, vvp_code_t cp)
 {
       thr->pc = cp->cptr;
 
@@ -3369,10 +3647,15 @@ bool of_JMP(vthread_t thr, vvp_code_t cp)
       return true;
 }
 
+bool of_JMP(vthread_t thr, vvp_code_t cp)
+{
+      return do_JMP(thr, cp);
+}
+
 /*
  * %jmp/0 <pc>, <flag>
  */
-bool of_JMP0(vthread_t thr, vvp_code_t cp)
+static inline bool do_JMP0(vthread_t thr, vvp_code_t cp)
 {
       if (thr->flags[cp->bit_idx[0]] == BIT4_0)
 	    thr->pc = cp->cptr;
@@ -3389,10 +3672,15 @@ bool of_JMP0(vthread_t thr, vvp_code_t cp)
       return true;
 }
 
+bool of_JMP0(vthread_t thr, vvp_code_t cp)
+{
+      return do_JMP0(thr, cp);
+}
+
 /*
  * %jmp/0xz <pc>, <flag>
  */
-bool of_JMP0XZ(vthread_t thr, vvp_code_t cp)
+static inline bool do_JMP0XZ(vthread_t thr, vvp_code_t cp)
 {
       if (thr->flags[cp->bit_idx[0]] != BIT4_1)
 	    thr->pc = cp->cptr;
@@ -3409,10 +3697,15 @@ bool of_JMP0XZ(vthread_t thr, vvp_code_t cp)
       return true;
 }
 
+bool of_JMP0XZ(vthread_t thr, vvp_code_t cp)
+{
+      return do_JMP0XZ(thr, cp);
+}
+
 /*
  * %jmp/1 <pc>, <flag>
  */
-bool of_JMP1(vthread_t thr, vvp_code_t cp)
+static inline bool do_JMP1(vthread_t thr, vvp_code_t cp)
 {
       if (thr->flags[cp->bit_idx[0]] == BIT4_1)
 	    thr->pc = cp->cptr;
@@ -3429,10 +3722,15 @@ bool of_JMP1(vthread_t thr, vvp_code_t cp)
       return true;
 }
 
+bool of_JMP1(vthread_t thr, vvp_code_t cp)
+{
+      return do_JMP1(thr, cp);
+}
+
 /*
  * %jmp/1xz <pc>, <flag>
  */
-bool of_JMP1XZ(vthread_t thr, vvp_code_t cp)
+static inline bool do_JMP1XZ(vthread_t thr, vvp_code_t cp)
 {
       if (thr->flags[cp->bit_idx[0]] != BIT4_0)
 	    thr->pc = cp->cptr;
@@ -3449,6 +3747,11 @@ bool of_JMP1XZ(vthread_t thr, vvp_code_t cp)
       return true;
 }
 
+bool of_JMP1XZ(vthread_t thr, vvp_code_t cp)
+{
+      return do_JMP1XZ(thr, cp);
+}
+
 /*
  * The %join instruction causes the thread to wait for one child
  * to die.  If a child is already dead (and a zombie) then I reap
@@ -3727,7 +4030,7 @@ bool of_LOAD_STRA(vthread_t thr, vvp_code_t cp)
 /*
  * %load/vec4 <net>
  */
-bool of_LOAD_VEC4(vthread_t thr, vvp_code_t cp)
+static inline bool do_LOAD_VEC4(vthread_t thr, vvp_code_t cp)
 {
 	// Push a placeholder onto the stack in order to reserve the
 	// stack space. Use a reference for the stack top as a target
@@ -3753,6 +4056,11 @@ bool of_LOAD_VEC4(vthread_t thr, vvp_code_t cp)
       return true;
 }
 
+bool of_LOAD_VEC4(vthread_t thr, vvp_code_t cp)
+{
+      return do_LOAD_VEC4(thr, cp);
+}
+
 /*
  * %load/vec4a <arr>, <adrx>
  */
@@ -4346,19 +4654,7 @@ bool of_NORR(vthread_t thr, vvp_code_t)
 {
       vvp_vector4_t val = thr->pop_vec4();
 
-      vvp_bit4_t lb = BIT4_1;
-
-      for (unsigned idx = 0 ;  idx < val.size() ;  idx += 1) {
-
-	    vvp_bit4_t rb = val.value(idx);
-	    if (rb == BIT4_1) {
-		  lb = BIT4_0;
-		  break;
-	    }
-
-	    if (rb != BIT4_0)
-		  lb = BIT4_X;
-      }
+      vvp_bit4_t lb = ~val.or_reduce();
 
       vvp_vector4_t res (1, lb);
       thr->push_vec4(res);
@@ -4383,18 +4679,7 @@ bool of_ANDR(vthread_t thr, vvp_code_t)
 {
       vvp_vector4_t val = thr->pop_vec4();
 
-      vvp_bit4_t lb = BIT4_1;
-
-      for (unsigned idx = 0 ; idx < val.size() ; idx += 1) {
-	    vvp_bit4_t rb = val.value(idx);
-	    if (rb == BIT4_0) {
-		  lb = BIT4_0;
-		  break;
-	    }
-
-	    if (rb != 1)
-		  lb = BIT4_X;
-      }
+      vvp_bit4_t lb = val.and_reduce();
 
       vvp_vector4_t res (1, lb);
       thr->push_vec4(res);
@@ -4409,18 +4694,7 @@ bool of_NANDR(vthread_t thr, vvp_code_t)
 {
       vvp_vector4_t val = thr->pop_vec4();
 
-      vvp_bit4_t lb = BIT4_0;
-      for (unsigned idx = 0 ; idx < val.size() ; idx += 1) {
-
-	    vvp_bit4_t rb = val.value(idx);
-	    if (rb == BIT4_0) {
-		  lb = BIT4_1;
-		  break;
-	    }
-
-	    if (rb != BIT4_1)
-		  lb = BIT4_X;
-      }
+      vvp_bit4_t lb = ~val.and_reduce();
 
       vvp_vector4_t res (1, lb);
       thr->push_vec4(res);
@@ -4435,17 +4709,7 @@ bool of_ORR(vthread_t thr, vvp_code_t)
 {
       vvp_vector4_t val = thr->pop_vec4();
 
-      vvp_bit4_t lb = BIT4_0;
-      for (unsigned idx = 0 ; idx < val.size() ; idx += 1) {
-	    vvp_bit4_t rb = val.value(idx);
-	    if (rb == BIT4_1) {
-		  lb = BIT4_1;
-		  break;
-	    }
-
-	    if (rb != BIT4_0)
-		  lb = BIT4_X;
-      }
+      vvp_bit4_t lb = val.or_reduce();
 
       vvp_vector4_t res (1, lb);
       thr->push_vec4(res);
@@ -4459,17 +4723,7 @@ bool of_XORR(vthread_t thr, vvp_code_t)
 {
       vvp_vector4_t val = thr->pop_vec4();
 
-      vvp_bit4_t lb = BIT4_0;
-      for (unsigned idx = 0 ; idx < val.size() ; idx += 1) {
-
-	    vvp_bit4_t rb = val.value(idx);
-	    if (rb == BIT4_1)
-		  lb = ~lb;
-	    else if (rb != BIT4_0) {
-		  lb = BIT4_X;
-		  break;
-	    }
-      }
+      vvp_bit4_t lb = val.xor_reduce();
 
       vvp_vector4_t res (1, lb);
       thr->push_vec4(res);
@@ -4483,17 +4737,7 @@ bool of_XNORR(vthread_t thr, vvp_code_t)
 {
       vvp_vector4_t val = thr->pop_vec4();
 
-      vvp_bit4_t lb = BIT4_1;
-      for (unsigned idx = 0 ; idx < val.size() ; idx += 1) {
-
-	    vvp_bit4_t rb = val.value(idx);
-	    if (rb == BIT4_1)
-		  lb = ~lb;
-	    else if (rb != BIT4_0) {
-		  lb = BIT4_X;
-		  break;
-	    }
-      }
+      vvp_bit4_t lb = ~val.xor_reduce();
 
       vvp_vector4_t res (1, lb);
       thr->push_vec4(res);
@@ -4781,7 +5025,7 @@ bool of_PUSHI_STR(vthread_t thr, vvp_code_t cp)
 /*
  * %pushi/vec4 <vala>, <valb>, <wid>
  */
-bool of_PUSHI_VEC4(vthread_t thr, vvp_code_t cp)
+static inline bool do_PUSHI_VEC4(vthread_t thr, vvp_code_t cp)
 {
       uint32_t vala = cp->bit_idx[0];
       uint32_t valb = cp->bit_idx[1];
@@ -4845,6 +5089,11 @@ bool of_PUSHI_VEC4(vthread_t thr, vvp_code_t cp)
       return true;
 }
 
+bool of_PUSHI_VEC4(vthread_t thr, vvp_code_t cp)
+{
+      return do_PUSHI_VEC4(thr, cp);
+}
+
 /*
  * %pushv/str
  *   Pops a vec4 value, and pushes a string.
@@ -5797,7 +6046,7 @@ bool of_STORE_STRA(vthread_t thr, vvp_code_t cp)
  * not consistent with the %store/vec4/<etc> instructions which have
  * no <wid>.
  */
-bool of_STORE_VEC4(vthread_t thr, vvp_code_t cp)
+static inline bool do_STORE_VEC4(vthread_t thr, vvp_code_t cp)
 {
       vvp_net_ptr_t ptr(cp->net, 0);
       vvp_signal_value*sig = dynamic_cast<vvp_signal_value*> (cp->net->fil);
@@ -5865,6 +6114,11 @@ bool of_STORE_VEC4(vthread_t thr, vvp_code_t cp)
       return true;
 }
 
+bool of_STORE_VEC4(vthread_t thr, vvp_code_t cp)
+{
+      return do_STORE_VEC4(thr, cp);
+}
+
 /*
  * %store/vec4a <var-label>, <addr>, <offset>
  */
@@ -6167,15 +6421,7 @@ bool of_XOR(vthread_t thr, vvp_code_t)
       vvp_vector4_t valr = thr->pop_vec4();
       vvp_vector4_t&vall = thr->peek_vec4();
       assert(vall.size() == valr.size());
-      unsigned wid = vall.size();
-
-      for (unsigned idx = 0 ;  idx < wid ;  idx += 1) {
-
-	    vvp_bit4_t lb = vall.value(idx);
-	    vvp_bit4_t rb = valr.value(idx);
-	    vall.set_bit(idx, lb ^ rb);
-      }
-
+      vall ^= valr;
       return true;
 }
 
@@ -6302,3 +6548,260 @@ bool of_REAP_UFUNC(vthread_t thr, vvp_code_t cp)
 
       return true;
 }
+
+/*
+ * These are the superinstructions that the compile_cleanup pass
+ * writes over the first instruction of the common sequences listed
+ * in its superop_table. The pass does not remove the rest of the
+ * sequence, so each superinstruction takes its operands from the
+ * original instructions that follow it, then continues after the
+ * last of them. Jumps into the middle of a sequence still land on
+ * the original instructions.
+ */
+
+/*
+ * %dup/vec4; %pushi/vec4 <imm>; %cmp/u; %jmp/1 <pc>, <flag>
+ *
+ * This is a case compare chain. Compare the top of the stack with
+ * the immediate value without copying it first.
+ */
+bool of_FUSED_DUP_PUSHI_CMPU_JMP1(vthread_t thr, vvp_code_t cp)
+{
+      vvp_vector4_t rval (cp[1].number, BIT4_0);
+      get_immediate_rval(cp+1, rval);
+
+      do_CMPU(thr, thr->peek_vec4(), rval);
+
+      thr->pc = cp + 4;
+      return do_JMP1(thr, cp+3);
+}
+
+/*
+ * %load/vec4 <net>; %addi <imm>; %store/vec4 <net>, <off>, <wid>
+ */
+bool of_FUSED_LOAD_ADDI_STORE(vthread_t thr, vvp_code_t cp)
+{
+      do_LOAD_VEC4(thr, cp);
+      of_ADDI(thr, cp+1);
+      do_STORE_VEC4(thr, cp+2);
+
+      thr->pc = cp + 3;
+      return true;
+}
+
+/*
+ * %load/vec4 <net>; %cmpi/e <imm>; %jmp/0xz <pc>, <flag>
+ */
+bool of_FUSED_LOAD_CMPIE_JMP0XZ(vthread_t thr, vvp_code_t cp)
+{
+      do_LOAD_VEC4(thr, cp);
+      of_CMPIE(thr, cp+1);
+
+      thr->pc = cp + 3;
+      return do_JMP0XZ(thr, cp+2);
+}
+
+/*
+ * %load/vec4 <net>; %cmpi/u <imm>; %jmp/0xz <pc>, <flag>
+ */
+bool of_FUSED_LOAD_CMPIU_JMP0XZ(vthread_t thr, vvp_code_t cp)
+{
+      do_LOAD_VEC4(thr, cp);
+      of_CMPIU(thr, cp+1);
+
+      thr->pc = cp + 3;
+      return do_JMP0XZ(thr, cp+2);
+}
+
+/*
+ * %load/vec4 <net>; %pushi/vec4 <imm>; %cmp/u; %jmp/0xz <pc>, <flag>
+ *
+ * The %pushi/vec4 and %cmp/u together are the same as a %cmpi/u
+ * with the same operands, so there is no need to push the immediate
+ * value only to pop it again.
+ */
+bool of_FUSED_LOAD_PUSHI_CMPU_JMP0XZ(vthread_t thr, vvp_code_t cp)
+{
+      do_LOAD_VEC4(thr, cp);
+      of_CMPIU(thr, cp+1);
+
+      thr->pc = cp + 4;
+      return do_JMP0XZ(thr, cp+3);
+}
+
+/*
+ * This is the threaded interpreter. Every instruction carries in its
+ * thread_label the address of the code that runs it, so each
+ * instruction ends with its own indirect jump to the next one
+ * instead of returning to a common dispatch loop. The most common
+ * instructions are run right here without a function call, and all
+ * the others through the CALL entry, which calls the opcode function
+ * exactly like vthread_run_call_ does. Compilers without support
+ * for labels as values get a switch on the thread_op index instead.
+ *
+ * When called with a nil thread, this returns the table of labels
+ * (or nil for the switch) for vthread_prepare_code to use.
+ */
+enum thread_op_e {
+      TOP_CALL = 0,
+      TOP_CHUNK_LINK,
+      TOP_NOOP,
+      TOP_JMP,
+      TOP_JMP0,
+      TOP_JMP0XZ,
+      TOP_JMP1,
+      TOP_JMP1XZ,
+      TOP_LOAD_VEC4,
+      TOP_PUSHI_VEC4,
+      TOP_STORE_VEC4,
+      TOP_COUNT
+};
+
+static const struct thread_op_map_s {
+      vvp_code_fun opcode;
+      enum thread_op_e op;
+} thread_op_map[] = {
+      { &of_CHUNK_LINK, TOP_CHUNK_LINK },
+      { &of_NOOP,       TOP_NOOP },
+      { &of_JMP,        TOP_JMP },
+      { &of_JMP0,       TOP_JMP0 },
+      { &of_JMP0XZ,     TOP_JMP0XZ },
+      { &of_JMP1,       TOP_JMP1 },
+      { &of_JMP1XZ,     TOP_JMP1XZ },
+      { &of_LOAD_VEC4,  TOP_LOAD_VEC4 },
+      { &of_PUSHI_VEC4, TOP_PUSHI_VEC4 },
+      { &of_STORE_VEC4, TOP_STORE_VEC4 },
+      { 0,              TOP_CALL }
+};
+
+#if defined(__GNUC__)
+# define THREAD_OP(name) op_##name:
+# define THREAD_NEXT() do {			\
+	    cp = thr->pc;				\
+	    thr->pc += 1;				\
+	    goto *cp->thread_label;			\
+      } while (0)
+#else
+# define THREAD_OP(name) case TOP_##name:
+# define THREAD_NEXT() continue
+#endif
+
+static const void*const* vthread_run_threaded_(vthread_t thr)
+{
+      vvp_code_t cp;
+
+#if defined(__GNUC__)
+      static const void*const labels[TOP_COUNT] = {
+	    &&op_CALL,
+	    &&op_CHUNK_LINK,
+	    &&op_NOOP,
+	    &&op_JMP,
+	    &&op_JMP0,
+	    &&op_JMP0XZ,
+	    &&op_JMP1,
+	    &&op_JMP1XZ,
+	    &&op_LOAD_VEC4,
+	    &&op_PUSHI_VEC4,
+	    &&op_STORE_VEC4
+      };
+
+      if (thr == 0)
+	    return labels;
+
+      THREAD_NEXT();
+#else
+      if (thr == 0)
+	    return 0;
+
+      for (;;) {
+	    cp = thr->pc;
+	    thr->pc += 1;
+	    switch (cp->thread_op) {
+#endif
+	    THREAD_OP(CALL)
+		  if (! (cp->opcode)(thr, cp))
+			return 0;
+		  THREAD_NEXT();
+
+	    THREAD_OP(CHUNK_LINK)
+		  thr->pc = cp->cptr;
+		  THREAD_NEXT();
+
+	    THREAD_OP(NOOP)
+		  THREAD_NEXT();
+
+	    THREAD_OP(JMP)
+		  if (! do_JMP(thr, cp))
+			return 0;
+		  THREAD_NEXT();
+
+	    THREAD_OP(JMP0)
+		  if (! do_JMP0(thr, cp))
+			return 0;
+		  THREAD_NEXT();
+
+	    THREAD_OP(JMP0XZ)
+		  if (! do_JMP0XZ(thr, cp))
+			return 0;
+		  THREAD_NEXT();
+
+	    THREAD_OP(JMP1)
+		  if (! do_JMP1(thr, cp))
+			return 0;
+		  THREAD_NEXT();
+
+	    THREAD_OP(JMP1XZ)
+		  if (! do_JMP1XZ(thr, cp))
+			return 0;
+		  THREAD_NEXT();
+
+	    THREAD_OP(LOAD_VEC4)
+		  do_LOAD_VEC4(thr, cp);
+		  THREAD_NEXT();
+
+	    THREAD_OP(PUSHI_VEC4)
+		  do_PUSHI_VEC4(thr, cp);
+		  THREAD_NEXT();
+
+	    THREAD_OP(STORE_VEC4)
+		  do_STORE_VEC4(thr, cp);
+		  THREAD_NEXT();
+#if !defined(__GNUC__)
+		default:
+		  assert(0);
+		  return 0;
+	    }
+      }
+#endif
+}
+
+#undef THREAD_OP
+#undef THREAD_NEXT
+
+static const void*const* thread_labels = 0;
+
+static void prepare_thread_op(vvp_code_t cp)
+{
+      unsigned op = TOP_CALL;
+      for (const struct thread_op_map_s*cur = thread_op_map
+		 ; cur->opcode ; cur += 1) {
+	    if (cur->opcode == cp->opcode) {
+		  op = cur->op;
+		  break;
+	    }
+      }
+
+      if (thread_labels)
+	    cp->thread_label = thread_labels[op];
+      else
+	    cp->thread_op = op;
+}
+
+void vthread_prepare_code(void)
+{
+      if (vthread_profile_flag || ! vthread_threaded_flag)
+	    return;
+
+      thread_labels = vthread_run_threaded_(0);
+      codespace_walk(&prepare_thread_op);
+}
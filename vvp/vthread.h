@@ -65,6 +65,30 @@ extern void vthread_delay_delete();
  */
 extern void vthread_run(vthread_t thr);
 
+/*
+ * Select the interpreter that vthread_run uses. The "call" dispatch
+ * calls the opcode function of every instruction. The "threaded"
+ * dispatch jumps directly from instruction to instruction, and runs
+ * the most common instructions without a function call at all. The
+ * function returns false if the name is not known.
+ *
+ * The vthread_prepare_code function must be called once after the
+ * design is completely compiled, to prepare the code space for the
+ * selected interpreter.
+ */
+extern bool vthread_set_dispatch(const char*name);
+extern const char* vthread_dispatch(void);
+extern void vthread_prepare_code(void);
+
+/*
+ * With profiling turned on, vthread_run counts in the exec_count of
+ * every instruction the number of times it was executed. This is
+ * used to find the instruction sequences worth fusing into
+ * superinstructions. The call dispatch is always used while
+ * profiling.
+ */
+extern void vthread_set_profile(bool flag);
+
 /*
  * This function schedules all the threads in the list to be scheduled
  * for execution with delay 0. The thr pointer is taken to be the head
@@ -75,6 +99,13 @@ extern void vthread_schedule_list(vthread_t thr);
 
 extern __vpiScope*vthread_scope(vthread_t thr);
 
+/*
+ * Get the opcode that is executing and the scope of the thread that
+ * is running, if there is one. The sampling profiler calls this from
+ * a signal handler, so it only reads the thread.
+ */
+extern bool vthread_running_pc(vvp_code_t&pc, __vpiScope*&scope);
+
 /*
  * This function returns a handle to the writable context of the currently
  * running thread. Normally the writable context is the context allocated
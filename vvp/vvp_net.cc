@@ -25,7 +25,15 @@
 # include  "resolv.h"
 # include  "schedule.h"
 # include  "statistics.h"
+# include  "vvp_simd.h"
+# include  "checkpoint.h"
+# include  "logic.h"
+# include  "part.h"
+# include  "arith.h"
+# include  "slab.h"
 # include  <cstdio>
+# include  <vector>
+# include  <map>
 # include  <cstring>
 # include  <cstdlib>
 # include  <iostream>
@@ -57,6 +65,8 @@ static vvp_net_t **vvp_net_pool = NULL;
 static unsigned vvp_net_pool_count = 0;
 #endif
 static size_t vvp_net_alloc_remaining = 0;
+// The chunks in allocation order, so that nets can be found by index.
+static std::vector<vvp_net_t*> vvp_net_chunks;
 // For statistics, count the vvp_nets allocated and the bytes of alloc
 // chunks allocated.
 unsigned long count_vvp_nets = 0;
@@ -69,6 +79,7 @@ void* vvp_net_t::operator new (size_t size)
 	    vvp_net_alloc_table = ::new vvp_net_t[VVP_NET_CHUNK];
 	    vvp_net_alloc_remaining = VVP_NET_CHUNK;
 	    size_vvp_nets += size*VVP_NET_CHUNK;
+	    vvp_net_chunks.push_back(vvp_net_alloc_table);
 #ifdef CHECK_WITH_VALGRIND
 	    VALGRIND_MAKE_MEM_NOACCESS(vvp_net_alloc_table, size*VVP_NET_CHUNK);
 	    VALGRIND_CREATE_MEMPOOL(vvp_net_alloc_table, 0, 0);
@@ -91,6 +102,23 @@ void* vvp_net_t::operator new (size_t size)
       return return_this;
 }
 
+vvp_net_t* vvp_net_at(unsigned long idx)
+{
+      if (idx >= count_vvp_nets)
+	    return 0;
+      return vvp_net_chunks[idx / VVP_NET_CHUNK] + idx % VVP_NET_CHUNK;
+}
+
+unsigned long vvp_net_index(const vvp_net_t*net)
+{
+      for (size_t idx = 0 ; idx < vvp_net_chunks.size() ; idx += 1) {
+	    const vvp_net_t*base = vvp_net_chunks[idx];
+	    if (net >= base && net < base+VVP_NET_CHUNK)
+		  return idx*VVP_NET_CHUNK + (net-base);
+      }
+      return ULONG_MAX;
+}
+
 #ifdef CHECK_WITH_VALGRIND
 static map<vvp_net_t*, bool> vvp_net_map;
 static map<sfunc_core*, bool> sfunc_map;
@@ -235,6 +263,118 @@ void vvp_net_t::unlink(vvp_net_ptr_t dst_ptr)
       net->port[net_port] = vvp_net_ptr_t(0,0);
 }
 
+/*
+ * The levelizer follows the fan-out of a boolean functor through the
+ * functors that propagate what they receive right away, to find the
+ * boolean functors that it feeds. Other functors (delays, UDPs,
+ * resolvers, islands and so on) end the search, so the functors on
+ * the far side of them are not ordered after this one.
+ */
+static bool levelize_pass_through(const vvp_net_fun_t*fun)
+{
+      switch (fun->kind()) {
+	  case vvp_net_fun_t::KIND_PART_SA:
+	  case vvp_net_fun_t::KIND_CONCAT:
+	  case vvp_net_fun_t::KIND_ARITH_SUM:
+	  case vvp_net_fun_t::KIND_SIGNAL4_SA:
+	    return true;
+	  default:
+	    return false;
+      }
+}
+
+void vvp_net_levelize(void)
+{
+      std::map<vvp_net_t*,unsigned> index;
+      std::vector<vvp_net_t*> nodes;
+      for (unsigned long idx = 0 ;  idx < count_vvp_nets ;  idx += 1) {
+	    vvp_net_t*net = vvp_net_at(idx);
+	    if (net->fun == 0)
+		  continue;
+	    if (net->fun->kind() != vvp_net_fun_t::KIND_BOOLEAN)
+		  continue;
+	    index[net] = nodes.size();
+	    nodes.push_back(net);
+      }
+
+      if (nodes.empty())
+	    return;
+
+	/* Collect the edges from each boolean functor to the boolean
+	   functors that it feeds. */
+      std::vector<size_t> edge_start (nodes.size()+1);
+      std::vector<unsigned> edges;
+      std::vector<unsigned> indegree (nodes.size(), 0);
+      std::map<vvp_net_t*,unsigned> visited;
+      std::vector<vvp_net_t*> stack;
+      for (unsigned idx = 0 ;  idx < nodes.size() ;  idx += 1) {
+	    edge_start[idx] = edges.size();
+	    stack.push_back(nodes[idx]);
+	    while (! stack.empty()) {
+		  vvp_net_t*net = stack.back();
+		  stack.pop_back();
+		  for (vvp_net_ptr_t ptr = net->out_ ; ! ptr.nil()
+			     ; ptr = ptr.ptr()->port[ptr.port()]) {
+			vvp_net_t*dst = ptr.ptr();
+			if (dst->fun == 0)
+			      continue;
+			if (dst->fun->kind() == vvp_net_fun_t::KIND_BOOLEAN) {
+			      unsigned tgt = index[dst];
+			      edges.push_back(tgt);
+			      indegree[tgt] += 1;
+			} else if (levelize_pass_through(dst->fun)) {
+			      unsigned&mark = visited[dst];
+			      if (mark == idx+1)
+				    continue;
+			      mark = idx+1;
+			      stack.push_back(dst);
+			}
+		  }
+	    }
+      }
+      edge_start[nodes.size()] = edges.size();
+
+	/* Give the functors their levels in topological order. The
+	   functors that are in (or are fed by) a feedback loop never
+	   run out of inputs, and keep level 0. */
+      std::vector<unsigned> level (nodes.size(), 0);
+      std::vector<unsigned> ready;
+      for (unsigned idx = 0 ;  idx < nodes.size() ;  idx += 1) {
+	    if (indegree[idx] == 0) {
+		  level[idx] = 1;
+		  ready.push_back(idx);
+	    }
+      }
+
+      unsigned max_level = 0;
+      while (! ready.empty()) {
+	    unsigned cur = ready.back();
+	    ready.pop_back();
+	    if (level[cur] > max_level)
+		  max_level = level[cur];
+
+	    for (size_t edx = edge_start[cur] ; edx < edge_start[cur+1] ; edx += 1) {
+		  unsigned tgt = edges[edx];
+		  if (level[tgt] < level[cur]+1)
+			level[tgt] = level[cur]+1;
+		  indegree[tgt] -= 1;
+		  if (indegree[tgt] == 0)
+			ready.push_back(tgt);
+	    }
+      }
+
+      for (unsigned idx = 0 ;  idx < nodes.size() ;  idx += 1) {
+	    if (indegree[idx] != 0)
+		  continue;
+	    vvp_fun_boolean_*fun = static_cast<vvp_fun_boolean_*>(nodes[idx]->fun);
+	    fun->set_level(level[idx]);
+	    count_functors_levelized += 1;
+      }
+
+      count_net_levels = max_level;
+      schedule_set_levels(max_level+1);
+}
+
 void vvp_net_t::count_drivers(unsigned idx, unsigned counts[4])
 {
       counts[0] = 0;
@@ -399,6 +539,21 @@ void vvp_net_fil_t::force_unlink(void)
       force_link_->port[2] = vvp_net_ptr_t(0,0);
 }
 
+/*
+ * The force link net is made at run time, so save the source of the
+ * force and make the link again when the checkpoint is restored.
+ */
+void vvp_net_fil_t::checkpoint(vvp_checkpoint_t&cp)
+{
+      cp.io(force_mask_);
+      cp.io(force_propagate_);
+
+      vvp_net_t*src = force_link_? force_link_->port[2].ptr() : 0;
+      cp.io_net(src);
+      if (cp.restoring() && src)
+	    force_link(cp.current_net(), src);
+}
+
 /* *** BIT operations *** */
 vvp_bit4_t add_with_carry(vvp_bit4_t a, vvp_bit4_t b, vvp_bit4_t&c)
 {
@@ -563,6 +718,7 @@ void vvp_send_vec8(vvp_net_ptr_t ptr, const vvp_vector8_t&val)
       while (vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
+	    if (activity_flag) activity_recv(cur);
 	    if (cur->fun)
 		  cur->fun->recv_vec8(ptr, val);
 
@@ -575,6 +731,7 @@ void vvp_send_real(vvp_net_ptr_t ptr, double val, vvp_context_t context)
       while (vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
+	    if (activity_flag) activity_recv(cur);
 	    if (cur->fun)
 		  cur->fun->recv_real(ptr, val, context);
 
@@ -582,11 +739,63 @@ void vvp_send_real(vvp_net_ptr_t ptr, double val, vvp_context_t context)
       }
 }
 
+/*
+ * Gate level designs spend most of their time sending vec4 values to
+ * a few kinds of functor, so call those directly. The qualified call
+ * does not go through the vtable, and the compiler can see the exact
+ * method that is called.
+ */
+void vvp_send_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&val,
+		   vvp_context_t context)
+{
+      while (vvp_net_t*cur = ptr.ptr()) {
+	    vvp_net_ptr_t next = cur->port[ptr.port()];
+	    vvp_net_fun_t*fun = cur->fun;
+
+	    if (activity_flag)
+		  activity_recv(cur);
+
+	    if (fun == 0) {
+		  ptr = next;
+		  continue;
+	    }
+
+	    switch (fun->kind()) {
+		case vvp_net_fun_t::KIND_BOOLEAN:
+		  static_cast<vvp_fun_boolean_*>(fun)
+			->vvp_fun_boolean_::recv_vec4(ptr, val, context);
+		  break;
+		case vvp_net_fun_t::KIND_PART_SA:
+		  static_cast<vvp_fun_part_sa*>(fun)
+			->vvp_fun_part_sa::recv_vec4(ptr, val, context);
+		  break;
+		case vvp_net_fun_t::KIND_CONCAT:
+		  static_cast<vvp_fun_concat*>(fun)
+			->vvp_fun_concat::recv_vec4(ptr, val, context);
+		  break;
+		case vvp_net_fun_t::KIND_ARITH_SUM:
+		  static_cast<vvp_arith_sum*>(fun)
+			->vvp_arith_sum::recv_vec4(ptr, val, context);
+		  break;
+		case vvp_net_fun_t::KIND_SIGNAL4_SA:
+		  static_cast<vvp_fun_signal4_sa*>(fun)
+			->vvp_fun_signal4_sa::recv_vec4(ptr, val, context);
+		  break;
+		default:
+		  fun->recv_vec4(ptr, val, context);
+		  break;
+	    }
+
+	    ptr = next;
+      }
+}
+
 void vvp_send_long(vvp_net_ptr_t ptr, long val)
 {
       while (vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
+	    if (activity_flag) activity_recv(cur);
 	    if (cur->fun)
 		  cur->fun->recv_long(ptr, val);
 
@@ -600,6 +809,7 @@ void vvp_send_long_pv(vvp_net_ptr_t ptr, long val,
       while (vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
+	    if (activity_flag) activity_recv(cur);
 	    if (cur->fun)
 		  cur->fun->recv_long_pv(ptr, val, base, wid);
 
@@ -611,6 +821,10 @@ const vvp_vector4_t vvp_vector4_t::nil;
 
 void vvp_vector4_t::copy_bits(const vvp_vector4_t&that)
 {
+      if (that.size_ >= size_)
+	    two_state_ = that.two_state_;
+      else if (! that.two_state_)
+	    two_state_ = false;
 
       if (size_ == that.size_) {
 	    if (size_ > BITS_PER_WORD) {
@@ -691,6 +905,30 @@ void vvp_vector4_t::copy_bits(const vvp_vector4_t&that)
       }
 }
 
+/*
+ * Buses of up to 128 bits are common enough that their words are
+ * worth keeping on a free list. A slab holds the abits and the bbits
+ * of one vector, of up to vvp_vector4_t::SLAB_WORDS words each.
+ */
+static const size_t VECTOR4_WORDS_CHUNK_COUNT = 1024;
+static slab_t<2*2*sizeof(unsigned long),VECTOR4_WORDS_CHUNK_COUNT> vector4_words_heap;
+
+unsigned long* vvp_vector4_t::get_words_(unsigned cnt)
+{
+      if (cnt <= SLAB_WORDS)
+	    return static_cast<unsigned long*>(vector4_words_heap.alloc_slab());
+      return new unsigned long[2*cnt];
+}
+
+void vvp_vector4_t::put_words_()
+{
+      assert(size_ > BITS_PER_WORD);
+      if (size_ <= SLAB_WORDS*BITS_PER_WORD)
+	    vector4_words_heap.free_slab(abits_ptr_);
+      else
+	    delete[] abits_ptr_;
+}
+
 /*
  * This function should ONLY BE CALLED FROM vvp_vector4_t::copy_from_,
  * as it performs part of that functions tasks.
@@ -698,7 +936,7 @@ void vvp_vector4_t::copy_bits(const vvp_vector4_t&that)
 void vvp_vector4_t::copy_from_big_(const vvp_vector4_t&that)
 {
       unsigned words = (size_+BITS_PER_WORD-1) / BITS_PER_WORD;
-      abits_ptr_ = new unsigned long[2*words];
+      abits_ptr_ = get_words_(words);
       bbits_ptr_ = abits_ptr_ + words;
 
       for (unsigned idx = 0 ;  idx < words ;  idx += 1)
@@ -715,9 +953,10 @@ void vvp_vector4_t::copy_from_big_(const vvp_vector4_t&that)
 void vvp_vector4_t::copy_inverted_from_(const vvp_vector4_t&that)
 {
       size_ = that.size_;
+      two_state_ = that.two_state_;
       if (size_ > BITS_PER_WORD) {
 	    unsigned words = (size_+BITS_PER_WORD-1) / BITS_PER_WORD;
-	    abits_ptr_ = new unsigned long[2*words];
+	    abits_ptr_ = get_words_(words);
 	    bbits_ptr_ = abits_ptr_ + words;
 
 	    unsigned remaining = size_;
@@ -745,9 +984,11 @@ void vvp_vector4_t::copy_inverted_from_(const vvp_vector4_t&that)
 /* Make sure to set size_ before calling this routine. */
 void vvp_vector4_t::allocate_words_(unsigned long inita, unsigned long initb)
 {
+      two_state_ = initb == 0;
+
       if (size_ > BITS_PER_WORD) {
 	    unsigned cnt = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
-	    abits_ptr_ = new unsigned long[2*cnt];
+	    abits_ptr_ = get_words_(cnt);
 	    bbits_ptr_ = abits_ptr_ + cnt;
 	    for (unsigned idx = 0 ;  idx < cnt ;  idx += 1)
 		  abits_ptr_[idx] = inita;
@@ -947,6 +1188,7 @@ vvp_vector4_t::vvp_vector4_t(const vvp_vector4_t&that,
 	    bbits_val_ = (that.bbits_val_ & mask) >> adr;
       }
 
+      two_state_ = that.two_state_;
 }
 
 /*
@@ -958,6 +1200,9 @@ void vvp_vector4_t::resize(unsigned newsize, vvp_bit4_t pad_bit)
       if (size_ == newsize)
 	    return;
 
+      if (newsize > size_ && bit4_is_xz(pad_bit))
+	    two_state_ = false;
+
       unsigned cnt = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
       unsigned long word_pad_abits = 0;
       unsigned long word_pad_bbits = 0;
@@ -997,7 +1242,7 @@ void vvp_vector4_t::resize(unsigned newsize, vvp_bit4_t pad_bit)
 		  return;
 	    }
 
-	    unsigned long*newbits = new unsigned long[2*newcnt];
+	    unsigned long*newbits = get_words_(newcnt);
 
 	    if (cnt > 1) {
 		  unsigned trans = cnt;
@@ -1009,7 +1254,7 @@ void vvp_vector4_t::resize(unsigned newsize, vvp_bit4_t pad_bit)
 		  for (unsigned idx = 0 ;  idx < trans ;  idx += 1)
 			newbits[newcnt+idx] = bbits_ptr_[idx];
 
-		  delete[]abits_ptr_;
+		  put_words_();
 
 	    } else {
 		  newbits[0] = abits_val_;
@@ -1037,7 +1282,7 @@ void vvp_vector4_t::resize(unsigned newsize, vvp_bit4_t pad_bit)
 	    if (cnt > 1) {
 		  unsigned long newvala = abits_ptr_[0];
 		  unsigned long newvalb = bbits_ptr_[0];
-		  delete[]abits_ptr_;
+		  put_words_();
 		  abits_val_ = newvala;
 		  bbits_val_ = newvalb;
 	    }
@@ -1136,6 +1381,11 @@ void vvp_vector4_t::setarray(unsigned adr, unsigned wid, const unsigned long*val
 {
       assert(adr+wid <= size_);
 
+	// The bits written are all 0 or 1, so if they cover the
+	// entire vector, it is now two-state.
+      if (adr == 0 && wid == size_)
+	    two_state_ = true;
+
       const unsigned BIT2_PER_WORD = 8*sizeof(unsigned long);
 
       if (size_ <= BITS_PER_WORD) {
@@ -1208,6 +1458,11 @@ bool vvp_vector4_t::set_vec(unsigned adr, const vvp_vector4_t&that)
       assert(adr+that.size_  <= size_);
       bool diff_flag = false;
 
+      if (adr == 0 && that.size_ == size_)
+	    two_state_ = that.two_state_;
+      else if (! that.two_state_)
+	    two_state_ = false;
+
       if (size_ <= BITS_PER_WORD) {
 
 	      /* The destination vector (me!) is within a bits_val_
@@ -1430,11 +1685,13 @@ void vvp_vector4_t::add(const vvp_vector4_t&that)
 	    if ((bbits_val_|that.bbits_val_) & mask) {
 		  abits_val_ |= mask;
 		  bbits_val_ |= mask;
+		  two_state_ = false;
 		  return;
 	    }
 
 	    abits_val_ += that.abits_val_;
 	    abits_val_ &= mask;
+	    two_state_ = true;
 	    return;
       }
 
@@ -1442,33 +1699,37 @@ void vvp_vector4_t::add(const vvp_vector4_t&that)
 	    if (bbits_val_ | that.bbits_val_) {
 		  abits_val_ = WORD_X_ABITS;
 		  bbits_val_ = WORD_X_BBITS;
+		  two_state_ = false;
 	    } else {
 		  abits_val_ += that.abits_val_;
+		  two_state_ = true;
 	    }
 	    return;
       }
 
       int cnt = size_ / BITS_PER_WORD;
-      unsigned long carry = 0;
-      for (int idx = 0 ; idx < cnt ; idx += 1) {
-	    if (bbits_ptr_[idx] | that.bbits_ptr_[idx])
-		  goto x_out;
 
-	    abits_ptr_[idx] = add_with_carry(abits_ptr_[idx], that.abits_ptr_[idx], carry);
-      }
+	// Check for X/Z bits ahead of time. This is free if the
+	// operands are already known to be two-state.
+      if (has_xz() || that.has_xz())
+	    goto x_out;
 
-      if (unsigned tail = size_ % BITS_PER_WORD) {
-	    unsigned long mask = ~( -1UL << tail );
-	    if ((bbits_ptr_[cnt] | that.bbits_ptr_[cnt])&mask)
-		  goto x_out;
+      {
+	    unsigned long carry = 0;
+	    for (int idx = 0 ; idx < cnt ; idx += 1)
+		  abits_ptr_[idx] = add_with_carry(abits_ptr_[idx], that.abits_ptr_[idx], carry);
 
-	    abits_ptr_[cnt] = add_with_carry(abits_ptr_[cnt], that.abits_ptr_[cnt], carry);
-	    abits_ptr_[cnt] &= mask;
+	    if (unsigned tail = size_ % BITS_PER_WORD) {
+		  unsigned long mask = ~( -1UL << tail );
+		  abits_ptr_[cnt] = add_with_carry(abits_ptr_[cnt], that.abits_ptr_[cnt], carry);
+		  abits_ptr_[cnt] &= mask;
+	    }
       }
 
       return;
 
  x_out:
+      two_state_ = false;
       for (int idx = 0 ; idx < cnt ; idx += 1) {
 	    abits_ptr_[idx] = WORD_X_ABITS;
 	    bbits_ptr_[idx] = WORD_X_BBITS;
@@ -1489,11 +1750,13 @@ void vvp_vector4_t::sub(const vvp_vector4_t&that)
 	    if ((bbits_val_|that.bbits_val_) & mask) {
 		  abits_val_ |= mask;
 		  bbits_val_ |= mask;
+		  two_state_ = false;
 		  return;
 	    }
 
 	    abits_val_ -= that.abits_val_;
 	    abits_val_ &= mask;
+	    two_state_ = true;
 	    return;
       }
 
@@ -1501,33 +1764,37 @@ void vvp_vector4_t::sub(const vvp_vector4_t&that)
 	    if (bbits_val_ | that.bbits_val_) {
 		  abits_val_ = WORD_X_ABITS;
 		  bbits_val_ = WORD_X_BBITS;
+		  two_state_ = false;
 	    } else {
 		  abits_val_ -= that.abits_val_;
+		  two_state_ = true;
 	    }
 	    return;
       }
 
       int cnt = size_ / BITS_PER_WORD;
-      unsigned long carry = 1;
-      for (int idx = 0 ; idx < cnt ; idx += 1) {
-	    if (bbits_ptr_[idx] | that.bbits_ptr_[idx])
-		  goto x_out;
 
-	    abits_ptr_[idx] = add_with_carry(abits_ptr_[idx], ~that.abits_ptr_[idx], carry);
-      }
+	// Check for X/Z bits ahead of time. This is free if the
+	// operands are already known to be two-state.
+      if (has_xz() || that.has_xz())
+	    goto x_out;
 
-      if (unsigned tail = size_ % BITS_PER_WORD) {
-	    unsigned long mask = ~( -1UL << tail );
-	    if ((bbits_ptr_[cnt] | that.bbits_ptr_[cnt])&mask)
-		  goto x_out;
+      {
+	    unsigned long carry = 1;
+	    for (int idx = 0 ; idx < cnt ; idx += 1)
+		  abits_ptr_[idx] = add_with_carry(abits_ptr_[idx], ~that.abits_ptr_[idx], carry);
 
-	    abits_ptr_[cnt] = add_with_carry(abits_ptr_[cnt], ~that.abits_ptr_[cnt], carry);
-	    abits_ptr_[cnt] &= mask;
+	    if (unsigned tail = size_ % BITS_PER_WORD) {
+		  unsigned long mask = ~( -1UL << tail );
+		  abits_ptr_[cnt] = add_with_carry(abits_ptr_[cnt], ~that.abits_ptr_[cnt], carry);
+		  abits_ptr_[cnt] &= mask;
+	    }
       }
 
       return;
 
  x_out:
+      two_state_ = false;
       for (int idx = 0 ; idx < cnt ; idx += 1) {
 	    abits_ptr_[idx] = WORD_X_ABITS;
 	    bbits_ptr_[idx] = WORD_X_BBITS;
@@ -1622,11 +1889,13 @@ void vvp_vector4_t::mul(const vvp_vector4_t&that)
 	    if ((bbits_val_|that.bbits_val_) & mask) {
 		  abits_val_ |= mask;
 		  bbits_val_ |= mask;
+		  two_state_ = false;
 		  return;
 	    }
 
 	    abits_val_ *= that.abits_val_;
 	    abits_val_ &= mask;
+	    two_state_ = true;
 	    return;
       }
 
@@ -1634,8 +1903,10 @@ void vvp_vector4_t::mul(const vvp_vector4_t&that)
 	    if (bbits_val_ || that.bbits_val_) {
 		  abits_val_ = WORD_X_ABITS;
 		  bbits_val_ = WORD_X_BBITS;
+		  two_state_ = false;
 	    } else {
 		  abits_val_ *= that.abits_val_;
+		  two_state_ = true;
 	    }
 	    return;
       }
@@ -1649,25 +1920,18 @@ void vvp_vector4_t::mul(const vvp_vector4_t&that)
 	    mask = ~0UL;
       }
 
-	// Check for any XZ values ahead of time in a first pass. If
-	// we find any, then force the entire result to be X and be
-	// done.
-      for (int idx = 0 ; idx < cnt ; idx += 1) {
-	    unsigned long lval = bbits_ptr_[idx];
-	    unsigned long rval = that.bbits_ptr_[idx];
-	    if (idx == (cnt-1)) {
-		  lval &= mask;
-		  rval &= mask;
-	    }
-	    if (lval || rval) {
-		  for (int xdx = 0 ; xdx < cnt-1 ; xdx += 1) {
-			abits_ptr_[xdx] = WORD_X_ABITS;
-			bbits_ptr_[xdx] = WORD_X_BBITS;
-		  }
-		  abits_ptr_[cnt-1] = WORD_X_ABITS & mask;
-		  bbits_ptr_[cnt-1] = WORD_X_BBITS & mask;
-		  return;
+	// Check for any XZ values ahead of time. If we find any,
+	// then force the entire result to be X and be done. This is
+	// free if the operands are already known to be two-state.
+      if (has_xz() || that.has_xz()) {
+	    for (int xdx = 0 ; xdx < cnt-1 ; xdx += 1) {
+		  abits_ptr_[xdx] = WORD_X_ABITS;
+		  bbits_ptr_[xdx] = WORD_X_BBITS;
 	    }
+	    abits_ptr_[cnt-1] = WORD_X_ABITS & mask;
+	    bbits_ptr_[cnt-1] = WORD_X_BBITS & mask;
+	    two_state_ = false;
+	    return;
       }
 
 	// Calculate the result into a res array. We need to keep is
@@ -1716,6 +1980,23 @@ bool vvp_vector4_t::eeq(const vvp_vector4_t&that) const
       if (size_ != that.size_)
 	    return false;
 
+	// If both vectors are two-state, then only the abits need to
+	// be compared.
+      if (two_state_ && that.two_state_) {
+	    unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
+	    unsigned idx = 0;
+	    if (words >= VVP_SIMD_MIN_WORDS) {
+		  idx = size_ / BITS_PER_WORD;
+		  if (! vvp_simd->eq(abits_ptr_, that.abits_ptr_, idx))
+			return false;
+	    }
+	    for ( ;  idx < words ;  idx += 1) {
+		  if (two_state_word(idx) != that.two_state_word(idx))
+			return false;
+	    }
+	    return true;
+      }
+
       if (size_ < BITS_PER_WORD) {
 	    unsigned long mask = (1UL << size_) - 1;
 	    return (abits_val_&mask) == (that.abits_val_&mask)
@@ -1728,7 +2009,12 @@ bool vvp_vector4_t::eeq(const vvp_vector4_t&that) const
       }
 
       unsigned words = size_ / BITS_PER_WORD;
-      for (unsigned idx = 0 ;  idx < words ;  idx += 1) {
+      if (words >= VVP_SIMD_MIN_WORDS) {
+	    if (! vvp_simd->eq(abits_ptr_, that.abits_ptr_, words))
+		  return false;
+	    if (! vvp_simd->eq(bbits_ptr_, that.bbits_ptr_, words))
+		  return false;
+      } else for (unsigned idx = 0 ;  idx < words ;  idx += 1) {
 	    if (abits_ptr_[idx] != that.abits_ptr_[idx])
 		  return false;
 	    if (bbits_ptr_[idx] != that.bbits_ptr_[idx])
@@ -1762,7 +2048,11 @@ bool vvp_vector4_t::eq_xz(const vvp_vector4_t&that) const
       }
 
       unsigned words = size_ / BITS_PER_WORD;
-      for (unsigned idx = 0 ;  idx < words ;  idx += 1) {
+      if (words >= VVP_SIMD_MIN_WORDS) {
+	    if (! vvp_simd->eq_xz(abits_ptr_, bbits_ptr_,
+				  that.abits_ptr_, that.bbits_ptr_, words))
+		  return false;
+      } else for (unsigned idx = 0 ;  idx < words ;  idx += 1) {
 	    if ((abits_ptr_[idx]|bbits_ptr_[idx]) != (that.abits_ptr_[idx]|that.bbits_ptr_[idx]))
 		  return false;
 	    if (bbits_ptr_[idx] != that.bbits_ptr_[idx])
@@ -1781,28 +2071,118 @@ bool vvp_vector4_t::eq_xz(const vvp_vector4_t&that) const
 
 bool vvp_vector4_t::has_xz() const
 {
+      if (two_state_)
+	    return false;
+
+      bool res = false;
       if (size_ < BITS_PER_WORD) {
 	    unsigned long mask = -1UL >> (BITS_PER_WORD - size_);
-	    return bbits_val_&mask;
-      }
+	    res = bbits_val_&mask;
 
-      if (size_ == BITS_PER_WORD) {
-	    return bbits_val_;
-      }
+      } else if (size_ == BITS_PER_WORD) {
+	    res = bbits_val_;
 
-      unsigned words = size_ / BITS_PER_WORD;
-      for (unsigned idx = 0 ; idx < words ; idx += 1) {
-	    if (bbits_ptr_[idx])
-		  return true;
+      } else {
+	    unsigned words = size_ / BITS_PER_WORD;
+	    if (words >= VVP_SIMD_MIN_WORDS) {
+		  res = vvp_simd->any(bbits_ptr_, words);
+	    } else for (unsigned idx = 0 ; idx < words && !res ; idx += 1) {
+		  if (bbits_ptr_[idx])
+			res = true;
+	    }
+
+	    unsigned long mask = size_%BITS_PER_WORD;
+	    if (!res && mask > 0) {
+		  mask = -1UL >> (BITS_PER_WORD - mask);
+		  res = bbits_ptr_[words]&mask;
+	    }
       }
 
-      unsigned long mask = size_%BITS_PER_WORD;
-      if (mask > 0) {
-	    mask = -1UL >> (BITS_PER_WORD - mask);
-	    return bbits_ptr_[words]&mask;
+	// Remember a clean result so that the next test is free.
+      if (! res)
+	    two_state_ = true;
+
+      return res;
+}
+
+/*
+ * Collect the masks that the reduction operators need. The whole
+ * words go through the vvp_simd kernel, and the bits past the end of
+ * the vector in the last word are masked away so that they do not
+ * count as anything.
+ */
+void vvp_vector4_t::reduce_masks_(vvp_simd_reduce_s&res) const
+{
+      res.zeros = 0;
+      res.ones = 0;
+      res.xz = 0;
+      res.parity = 0;
+
+      unsigned long abits, bbits;
+      unsigned long mask;
+      if (size_ <= BITS_PER_WORD) {
+	    mask = (size_ < BITS_PER_WORD)? (1UL<<size_)-1UL : -1UL;
+	    abits = abits_val_;
+	    bbits = bbits_val_;
+
+      } else {
+	    unsigned words = size_ / BITS_PER_WORD;
+	    vvp_simd->reduce(abits_ptr_, bbits_ptr_, words, res);
+
+	    unsigned remaining = size_ % BITS_PER_WORD;
+	    if (remaining == 0)
+		  return;
+	    mask = (1UL<<remaining) - 1UL;
+	    abits = abits_ptr_[words];
+	    bbits = bbits_ptr_[words];
       }
 
-      return false;
+      abits &= mask;
+      bbits &= mask;
+      res.zeros  |= ~(abits | bbits) & mask;
+      res.ones   |= abits & ~bbits;
+      res.xz     |= bbits;
+      res.parity ^= abits;
+}
+
+vvp_bit4_t vvp_vector4_t::and_reduce() const
+{
+      vvp_simd_reduce_s res;
+      reduce_masks_(res);
+
+      if (res.zeros)
+	    return BIT4_0;
+      if (res.xz)
+	    return BIT4_X;
+      return BIT4_1;
+}
+
+vvp_bit4_t vvp_vector4_t::or_reduce() const
+{
+      vvp_simd_reduce_s res;
+      reduce_masks_(res);
+
+      if (res.ones)
+	    return BIT4_1;
+      if (res.xz)
+	    return BIT4_X;
+      return BIT4_0;
+}
+
+vvp_bit4_t vvp_vector4_t::xor_reduce() const
+{
+      vvp_simd_reduce_s res;
+      reduce_masks_(res);
+
+      if (res.xz)
+	    return BIT4_X;
+
+	// Fold the parity word down to a single bit.
+      unsigned long parity = res.parity;
+      for (unsigned shift = BITS_PER_WORD/2 ; shift > 0 ; shift /= 2)
+	    parity ^= parity >> shift;
+
+      return (parity & 1)? BIT4_1 : BIT4_0;
 }
 
 void vvp_vector4_t::change_z2x()
@@ -1824,6 +2204,7 @@ void vvp_vector4_t::change_z2x()
 
 void vvp_vector4_t::set_to_x()
 {
+      two_state_ = false;
       if (size_ <= BITS_PER_WORD) {
 	    abits_val_ = vvp_vector4_t::WORD_X_ABITS;
             bbits_val_ = vvp_vector4_t::WORD_X_BBITS;
@@ -1875,6 +2256,11 @@ void vvp_vector4_t::invert()
       } else {
 	    unsigned remaining = size_;
 	    unsigned idx = 0;
+	    if (size_ >= VVP_SIMD_MIN_WORDS*BITS_PER_WORD) {
+		  idx = size_ / BITS_PER_WORD;
+		  remaining = size_ % BITS_PER_WORD;
+		  vvp_simd->invert4(abits_ptr_, bbits_ptr_, idx);
+	    }
 	    while (remaining >= BITS_PER_WORD) {
 		  abits_ptr_[idx] = ~abits_ptr_[idx];
 		  abits_ptr_[idx] |= bbits_ptr_[idx];
@@ -1897,6 +2283,18 @@ vvp_vector4_t& vvp_vector4_t::operator &= (const vvp_vector4_t&that)
 	//  01 00 01 11 11
 	//  11 00 11 11 11
 	//  10 00 11 11 11
+      if (two_state_ && that.two_state_) {
+	    if (size_ <= BITS_PER_WORD) {
+		  abits_val_ &= that.abits_val_;
+	    } else {
+		  unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
+		  for (unsigned idx = 0; idx < words ; idx += 1)
+			abits_ptr_[idx] &= that.abits_ptr_[idx];
+	    }
+	    return *this;
+      }
+
+      two_state_ = false;
       if (size_ <= BITS_PER_WORD) {
 	    unsigned long tmp1 = abits_val_ | bbits_val_;
 	    unsigned long tmp2 = that.abits_val_ | that.bbits_val_;
@@ -1904,7 +2302,10 @@ vvp_vector4_t& vvp_vector4_t::operator &= (const vvp_vector4_t&that)
 	    bbits_val_ = (tmp1 & that.bbits_val_) | (tmp2 & bbits_val_);
       } else {
 	    unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
-	    for (unsigned idx = 0; idx < words ; idx += 1) {
+	    if (words >= VVP_SIMD_MIN_WORDS) {
+		  vvp_simd->and4(abits_ptr_, bbits_ptr_,
+				 that.abits_ptr_, that.bbits_ptr_, words);
+	    } else for (unsigned idx = 0; idx < words ; idx += 1) {
 		  unsigned long tmp1 = abits_ptr_[idx] | bbits_ptr_[idx];
 		  unsigned long tmp2 = that.abits_ptr_[idx] |
 		                       that.bbits_ptr_[idx];
@@ -1925,6 +2326,18 @@ vvp_vector4_t& vvp_vector4_t::operator |= (const vvp_vector4_t&that)
 	//  01 01 01 01 01
 	//  11 11 01 11 11
 	//  10 11 01 11 11
+      if (two_state_ && that.two_state_) {
+	    if (size_ <= BITS_PER_WORD) {
+		  abits_val_ |= that.abits_val_;
+	    } else {
+		  unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
+		  for (unsigned idx = 0; idx < words ; idx += 1)
+			abits_ptr_[idx] |= that.abits_ptr_[idx];
+	    }
+	    return *this;
+      }
+
+      two_state_ = false;
       if (size_ <= BITS_PER_WORD) {
 	    unsigned long tmp = abits_val_ | bbits_val_ |
 	                        that.abits_val_ | that.bbits_val_;
@@ -1934,7 +2347,10 @@ vvp_vector4_t& vvp_vector4_t::operator |= (const vvp_vector4_t&that)
 
       } else {
 	    unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
-	    for (unsigned idx = 0; idx < words ; idx += 1) {
+	    if (words >= VVP_SIMD_MIN_WORDS) {
+		  vvp_simd->or4(abits_ptr_, bbits_ptr_,
+				that.abits_ptr_, that.bbits_ptr_, words);
+	    } else for (unsigned idx = 0; idx < words ; idx += 1) {
 		  unsigned long tmp = abits_ptr_[idx] | bbits_ptr_[idx] |
 	                        that.abits_ptr_[idx] | that.bbits_ptr_[idx];
 		  bbits_ptr_[idx] = ((~abits_ptr_[idx] | bbits_ptr_[idx]) &
@@ -1948,6 +2364,29 @@ vvp_vector4_t& vvp_vector4_t::operator |= (const vvp_vector4_t&that)
       return *this;
 }
 
+vvp_vector4_t& vvp_vector4_t::operator ^= (const vvp_vector4_t&that)
+{
+	// Any X or Z bit in either operand makes an X result bit,
+	// and X has both the abit and bbit set.
+      if (size_ <= BITS_PER_WORD) {
+	    bbits_val_ |= that.bbits_val_;
+	    abits_val_ = (abits_val_ ^ that.abits_val_) | bbits_val_;
+      } else {
+	    unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
+	    if (words >= VVP_SIMD_MIN_WORDS) {
+		  vvp_simd->xor4(abits_ptr_, bbits_ptr_,
+				 that.abits_ptr_, that.bbits_ptr_, words);
+	    } else for (unsigned idx = 0; idx < words ; idx += 1) {
+		  bbits_ptr_[idx] |= that.bbits_ptr_[idx];
+		  abits_ptr_[idx] = (abits_ptr_[idx] ^ that.abits_ptr_[idx])
+			| bbits_ptr_[idx];
+	    }
+      }
+
+      two_state_ = two_state_ && that.two_state_;
+      return *this;
+}
+
 /*
 * Add an integer to the vvp_vector4_t in place, bit by bit so that
 * there is no size limitations.
@@ -3233,6 +3672,7 @@ ostream& operator<<(ostream&out, const vvp_vector8_t&that)
 }
 
 vvp_net_fun_t::vvp_net_fun_t()
+: kind_(KIND_GENERIC)
 {
       count_functors += 1;
 }
@@ -3347,6 +3787,10 @@ void vvp_net_fun_t::force_flag(bool)
 {
 }
 
+void vvp_net_fun_t::checkpoint(vvp_checkpoint_t&)
+{
+}
+
 /* **** vvp_fun_drive methods **** */
 
 vvp_fun_drive::vvp_fun_drive(unsigned str0, unsigned str1)
@@ -3392,6 +3836,29 @@ vvp_wide_fun_core::~vvp_wide_fun_core()
       delete[] port_rvalues_;
 }
 
+/*
+ * The port value arrays are made on demand, so save a flag for each
+ * that tells whether it exists.
+ */
+void vvp_wide_fun_core::checkpoint(vvp_checkpoint_t&cp)
+{
+      bool have_vec4 = port_values_ != 0;
+      cp.io(have_vec4);
+      if (have_vec4) {
+	    if (port_values_ == 0) port_values_ = new vvp_vector4_t [nports_];
+	    for (unsigned idx = 0 ; idx < nports_ ; idx += 1)
+		  cp.io(port_values_[idx]);
+      }
+
+      bool have_real = port_rvalues_ != 0;
+      cp.io(have_real);
+      if (have_real) {
+	    if (port_rvalues_ == 0) port_rvalues_ = new double [nports_];
+	    for (unsigned idx = 0 ; idx < nports_ ; idx += 1)
+		  cp.io(port_rvalues_[idx]);
+      }
+}
+
 void vvp_wide_fun_core::propagate_vec4(const vvp_vector4_t&bit,
 				       vvp_time64_t delay)
 {
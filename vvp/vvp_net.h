@@ -24,12 +24,16 @@
 # include  "vvp_vpi_callback.h"
 # include  "permaheap.h"
 # include  "vvp_object.h"
+# include  "activity.h"
 # include  <cstddef>
 # include  <cstdlib>
 # include  <cstring>
 # include  <string>
 # include  <new>
 # include  <cassert>
+#if __cplusplus >= 201103L
+# include  <utility>
+#endif
 
 #ifdef HAVE_IOSFWD
 # include  <iosfwd>
@@ -41,6 +45,17 @@ class ostream;
 
 using namespace std;
 
+/*
+ * Compilers that support rvalue references get move constructors
+ * and move assignment for the vector types. VVP_MOVE marks values
+ * that may be moved from, and is a plain copy for older compilers.
+ */
+#if __cplusplus >= 201103L
+# define VVP_MOVE(x) std::move(x)
+#else
+# define VVP_MOVE(x) (x)
+#endif
+
 
 /* Data types */
 class  vvp_scalar_t;
@@ -49,9 +64,12 @@ class vvp_vector2_t;
 class vvp_vector4_t;
 class vvp_vector8_t;
 
+struct vvp_simd_reduce_s;
+
 /* Basic netlist types. */
 class  vvp_net_t;
 class  vvp_net_fun_t;
+class  vvp_checkpoint_t;
 class  vvp_net_fil_t;
 
 /* Core net function types. */
@@ -267,6 +285,10 @@ class vvp_vector4_t {
       vvp_vector4_t(const vvp_vector4_t&that);
       vvp_vector4_t(const vvp_vector4_t&that, bool invert_flag);
       vvp_vector4_t& operator= (const vvp_vector4_t&that);
+#if __cplusplus >= 201103L
+      vvp_vector4_t(vvp_vector4_t&&that);
+      vvp_vector4_t& operator= (vvp_vector4_t&&that);
+#endif
 
       ~vvp_vector4_t();
 
@@ -312,6 +334,31 @@ class vvp_vector4_t {
 	// Return true if there is an X or Z anywhere in the vector.
       bool has_xz() const;
 
+	// Return true if the vector is already known to have no X or
+	// Z bits. This is a cheap test, but if it returns false the
+	// vector may still turn out to have only 0 and 1 bits.
+      inline bool is_two_state() const { return two_state_; }
+
+	// Get the word of bits at the given word index. This is only
+	// meaningful for vectors that have no X or Z bits. The bits
+	// past the end of the vector are 0.
+      unsigned long two_state_word(unsigned idx) const;
+
+	// Get the abits and bbits words of the vector, least
+	// significant word first. The bits past the end of the vector
+	// in the last word are undefined. The pointers are only valid
+	// until the vector is next changed.
+      inline const unsigned long* abits_words() const
+      { return (size_ > BITS_PER_WORD)? abits_ptr_ : &abits_val_; }
+      inline const unsigned long* bbits_words() const
+      { return (size_ > BITS_PER_WORD)? bbits_ptr_ : &bbits_val_; }
+
+	// Reduce the vector to a single bit with the AND, OR or XOR
+	// operator. The inverted reductions are the ~ of these.
+      vvp_bit4_t and_reduce() const;
+      vvp_bit4_t or_reduce() const;
+      vvp_bit4_t xor_reduce() const;
+
 	// Change all Z bits to X bits.
       void change_z2x();
 
@@ -324,11 +371,15 @@ class vvp_vector4_t {
       void invert();
       vvp_vector4_t& operator &= (const vvp_vector4_t&that);
       vvp_vector4_t& operator |= (const vvp_vector4_t&that);
+      vvp_vector4_t& operator ^= (const vvp_vector4_t&that);
       vvp_vector4_t& operator += (int64_t);
 
     private:
 	// Number of vvp_bit4_t bits that can be shoved into a word.
       enum { BITS_PER_WORD = 8*sizeof(unsigned long) };
+	// Vectors of up to this many words (of abits, and of bbits)
+	// get their storage from a free list instead of the heap.
+      enum { SLAB_WORDS = 2 };
 	// The double value constructor requires that WORD_0_BBITS
 	// and WORD_1_BBITS have the same value!
 #if SIZEOF_UNSIGNED_LONG == 8
@@ -357,6 +408,15 @@ class vvp_vector4_t {
 
       void allocate_words_(unsigned long inita, unsigned long initb);
 
+	// Get the storage for cnt words of abits followed by cnt
+	// words of bbits, and release the storage of this vector,
+	// which must be wider than a word. The size_ of the vector
+	// selects where put_words_ returns the storage to.
+      static unsigned long*get_words_(unsigned cnt);
+      void put_words_();
+      void move_from_(vvp_vector4_t&that);
+      void reduce_masks_(vvp_simd_reduce_s&res) const;
+
 	// Values in the vvp_vector4_t are stored split across two
 	// arrays. For each bit in the vector, there is an abit and a
 	// bbit. the encoding of a vvp_vector4_t is:
@@ -369,6 +429,12 @@ class vvp_vector4_t {
 	// BIT4_Z    0    1
 
       unsigned size_;
+	// This is true if the vector is known to have no X or Z
+	// bits, so that operators can skip the bbits entirely. It is
+	// only a hint: all the methods that may write X or Z bits
+	// clear it, but not all the methods that remove them set
+	// it. The has_xz method sets it when it finds no X or Z bits.
+      mutable bool two_state_;
       union {
 	    unsigned long abits_val_;
 	    unsigned long*abits_ptr_;
@@ -413,28 +479,80 @@ inline vvp_vector4_t::vvp_vector4_t(unsigned size__, vvp_bit4_t val)
 inline vvp_vector4_t::~vvp_vector4_t()
 {
       if (size_ > BITS_PER_WORD) {
-	    delete[] abits_ptr_;
+	    put_words_();
 	      // bbits_ptr_ actually points half-way into a
 	      // double-length array started at abits_ptr_
       }
 }
 
+inline unsigned long vvp_vector4_t::two_state_word(unsigned idx) const
+{
+      assert(idx*BITS_PER_WORD < size_);
+
+      unsigned long res = (size_ > BITS_PER_WORD)? abits_ptr_[idx] : abits_val_;
+      unsigned tail = size_ - idx*BITS_PER_WORD;
+      if (tail < BITS_PER_WORD)
+	    res &= (1UL << tail) - 1UL;
+
+      return res;
+}
+
 inline vvp_vector4_t& vvp_vector4_t::operator= (const vvp_vector4_t&that)
 {
       if (this == &that)
 	    return *this;
 
       if (size_ > BITS_PER_WORD)
-	    delete[] abits_ptr_;
+	    put_words_();
 
       copy_from_(that);
 
       return *this;
 }
 
+#if __cplusplus >= 201103L
+inline vvp_vector4_t::vvp_vector4_t(vvp_vector4_t&&that)
+{
+      move_from_(that);
+}
+
+inline vvp_vector4_t& vvp_vector4_t::operator= (vvp_vector4_t&&that)
+{
+      if (this == &that)
+	    return *this;
+
+      if (size_ > BITS_PER_WORD)
+	    put_words_();
+
+      move_from_(that);
+
+      return *this;
+}
+#endif
+
+/*
+ * Take the value of that vector, leaving that vector empty. The
+ * storage of the words is taken over instead of copied.
+ */
+inline void vvp_vector4_t::move_from_(vvp_vector4_t&that)
+{
+      if (that.size_ > BITS_PER_WORD) {
+	    size_ = that.size_;
+	    two_state_ = that.two_state_;
+	    abits_ptr_ = that.abits_ptr_;
+	    bbits_ptr_ = that.bbits_ptr_;
+      } else {
+	    copy_from_(that);
+      }
+
+      that.size_ = 0;
+      that.two_state_ = true;
+}
+
 inline void vvp_vector4_t::copy_from_(const vvp_vector4_t&that)
 {
       size_ = that.size_;
+      two_state_ = that.two_state_;
       if (size_ <= BITS_PER_WORD) {
 	    abits_val_ = that.abits_val_;
 	    bbits_val_ = that.bbits_val_;
@@ -481,6 +599,9 @@ inline void vvp_vector4_t::set_bit(unsigned idx, vvp_bit4_t val)
       unsigned long off = idx % BITS_PER_WORD;
       unsigned long mask = 1UL << off;
 
+      if (bit4_is_xz(val))
+	    two_state_ = false;
+
       if (size_ > BITS_PER_WORD) {
 	    unsigned wdx = idx / BITS_PER_WORD;
 	    switch (val) {
@@ -817,6 +938,7 @@ class vvp_scalar_t {
 	// so allow vvp_vector8_t access to the raw encoding so that
 	// it can do compact vectoring of vvp_scalar_t objects.
       friend class vvp_vector8_t;
+      friend class vvp_checkpoint_t;
       explicit vvp_scalar_t(unsigned char val) : value_(val) { }
       unsigned char raw() const { return value_; }
 
@@ -1155,6 +1277,9 @@ class vvp_net_t {
     private:
       vvp_net_ptr_t out_;
 
+	// The levelizer follows the out_ chain of the nets.
+      friend void vvp_net_levelize(void);
+
     public: // Need a better new for these objects.
       static void* operator new(std::size_t size);
       static void operator delete(void*); // not implemented
@@ -1165,6 +1290,22 @@ class vvp_net_t {
 #endif
 };
 
+/*
+ * The vvp_net_t objects of a design are allocated in the same order
+ * every time the design is loaded, so the position of a net in the
+ * allocation order identifies it across runs. The vvp_net_index
+ * function returns ULONG_MAX for a net that is not from the pool.
+ */
+extern vvp_net_t* vvp_net_at(unsigned long idx);
+extern unsigned long vvp_net_index(const vvp_net_t*net);
+
+/*
+ * Give the boolean functors their levels for the levelized
+ * evaluation mode (see schedule_set_eval()). This is called once,
+ * after the compile has linked the design.
+ */
+extern void vvp_net_levelize(void);
+
 /*
  * Instances of this class represent the functionality of a
  * node. vvp_net_t objects hold pointers to the vvp_net_fun_t
@@ -1230,7 +1371,22 @@ class vvp_net_fun_t {
 	// do something about it.
       virtual void force_flag(bool run_now);
 
+	// Save or restore the state that the functor keeps between
+	// events. Functors that only hold their configuration need
+	// not implement this.
+      virtual void checkpoint(vvp_checkpoint_t&cp);
+
+	// vvp_send_vec4 calls recv_vec4 of the most common functors
+	// directly instead of through the vtable. Those functors set
+	// their kind in the constructor, and no class derived from
+	// them may override recv_vec4.
+      enum kind_t { KIND_GENERIC = 0, KIND_BOOLEAN, KIND_PART_SA,
+		    KIND_CONCAT, KIND_ARITH_SUM, KIND_SIGNAL4_SA };
+      kind_t kind() const { return kind_; }
+
    protected:
+      kind_t kind_;
+
       void recv_vec4_pv_(vvp_net_ptr_t p, const vvp_vector4_t&bit,
 			 unsigned base, unsigned wid, unsigned vwid,
                          vvp_context_t context);
@@ -1310,6 +1466,11 @@ class vvp_net_fil_t  : public vvp_vpi_callback {
       virtual void force_fil_vec8(const vvp_vector8_t&val, const vvp_vector2_t&mask) =0;
       virtual void force_fil_real(double val, const vvp_vector2_t&mask) =0;
 
+	// Save or restore the filter state. The base class takes
+	// care of the force mask and force link, and the derived
+	// classes add the values that they track.
+      virtual void checkpoint(vvp_checkpoint_t&cp);
+
     public: // These objects are only permallocated.
       static void* operator new(std::size_t size) { return heap_.alloc(size); }
       static void operator delete(void*); // not implemented
@@ -1388,6 +1549,8 @@ class vvp_fun_concat  : public vvp_net_fun_t {
       void recv_vec4_pv(vvp_net_ptr_t port, const vvp_vector4_t&bit,
 			unsigned base, unsigned wid, unsigned vwid,
                         vvp_context_t);
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       unsigned wid_[4];
       vvp_vector4_t val_;
@@ -1410,6 +1573,8 @@ class vvp_fun_concat8  : public vvp_net_fun_t {
       void recv_vec8_pv(vvp_net_ptr_t p, const vvp_vector8_t&bit,
 			unsigned base, unsigned wid, unsigned vwid);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       unsigned wid_[4];
       vvp_vector8_t val_;
@@ -1548,6 +1713,9 @@ class vvp_wide_fun_core : public vvp_net_fun_t {
       vvp_vector4_t& value(unsigned);
       double value_r(unsigned);
 
+	// The derived classes that keep more state add to this.
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
 	// the derived class implements this to receive an indication
 	// that one of the port input values changed.
@@ -1594,18 +1762,8 @@ class vvp_wide_fun_t : public vvp_net_fun_t {
 };
 
 
-inline void vvp_send_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&val, vvp_context_t context)
-{
-      while (class vvp_net_t*cur = ptr.ptr()) {
-	    vvp_net_ptr_t next = cur->port[ptr.port()];
-
-	    if (cur->fun)
-		  cur->fun->recv_vec4(ptr, val, context);
-
-	    ptr = next;
-      }
-}
-
+extern void vvp_send_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&val,
+			  vvp_context_t context);
 extern void vvp_send_vec8(vvp_net_ptr_t ptr, const vvp_vector8_t&val);
 extern void vvp_send_real(vvp_net_ptr_t ptr, double val,
                           vvp_context_t context);
@@ -1618,6 +1776,7 @@ inline void vvp_send_string(vvp_net_ptr_t ptr, const std::string&val, vvp_contex
       while (vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
+	    if (activity_flag) activity_recv(cur);
 	    if (cur->fun)
 		  cur->fun->recv_string(ptr, val, context);
 
@@ -1630,6 +1789,7 @@ inline void vvp_send_object(vvp_net_ptr_t ptr, vvp_object_t val, vvp_context_t c
       while (vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
+	    if (activity_flag) activity_recv(cur);
 	    if (cur->fun)
 		  cur->fun->recv_object(ptr, val, context);
 
@@ -1663,6 +1823,7 @@ inline void vvp_send_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&val,
       while (class vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
+	    if (activity_flag) activity_recv(cur);
 	    if (cur->fun)
 		  cur->fun->recv_vec4_pv(ptr, val, base, wid, vwid, context);
 
@@ -1676,6 +1837,7 @@ inline void vvp_send_vec8_pv(vvp_net_ptr_t ptr, const vvp_vector8_t&val,
       while (class vvp_net_t*cur = ptr.ptr()) {
 	    vvp_net_ptr_t next = cur->port[ptr.port()];
 
+	    if (activity_flag) activity_recv(cur);
 	    if (cur->fun)
 		  cur->fun->recv_vec8_pv(ptr, val, base, wid, vwid);
 
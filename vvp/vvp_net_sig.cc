@@ -22,6 +22,7 @@
 # include  "vvp_net_sig.h"
 # include  "statistics.h"
 # include  "vpi_priv.h"
+# include  "checkpoint.h"
 # include  <vector>
 # include  <cassert>
 #ifdef CHECK_WITH_VALGRIND
@@ -117,6 +118,11 @@ double vvp_signal_value::real_value() const
       return 0;
 }
 
+const vvp_vector4_t* vvp_signal_value::vec4_value_ref() const
+{
+      return 0;
+}
+
 void vvp_net_t::force_vec4(const vvp_vector4_t&val, const vvp_vector2_t&mask)
 {
       assert(fil);
@@ -151,9 +157,24 @@ vvp_fun_signal_base::vvp_fun_signal_base()
       count_functors_sig += 1;
 }
 
+/*
+ * The continuous assign link is remade from the saved source when
+ * the checkpoint is restored, the same way %cassign/link makes it.
+ */
+void vvp_fun_signal_base::checkpoint(vvp_checkpoint_t&cp)
+{
+      cp.io(continuous_assign_active_);
+      cp.io(assign_mask_);
+      cp.io(needs_init_);
+      cp.io_net(cassign_link);
+      if (cp.restoring() && cassign_link)
+	    cassign_link->link(vvp_net_ptr_t(cp.current_net(), 1));
+}
+
 vvp_fun_signal4_sa::vvp_fun_signal4_sa(unsigned wid, vvp_bit4_t init)
 : bits4_(wid, init)
 {
+      kind_ = KIND_SIGNAL4_SA;
 }
 
 /*
@@ -332,6 +353,12 @@ const vvp_vector4_t& vvp_fun_signal4_sa::vec4_unfiltered_value() const
       return bits4_;
 }
 
+void vvp_fun_signal4_sa::checkpoint(vvp_checkpoint_t&cp)
+{
+      vvp_fun_signal_base::checkpoint(cp);
+      cp.io(bits4_);
+}
+
 vvp_fun_signal4_aa::vvp_fun_signal4_aa(unsigned wid, vvp_bit4_t init)
 {
 	/* To make init work we would need to save it and then use the
@@ -469,6 +496,12 @@ double vvp_fun_signal_real_sa::real_unfiltered_value() const
       return bits_;
 }
 
+void vvp_fun_signal_real_sa::checkpoint(vvp_checkpoint_t&cp)
+{
+      vvp_fun_signal_base::checkpoint(cp);
+      cp.io(bits_);
+}
+
 void vvp_fun_signal_real_sa::recv_real(vvp_net_ptr_t ptr, double bit,
                                        vvp_context_t)
 {
@@ -615,6 +648,12 @@ const string& vvp_fun_signal_string_sa::get_string() const
       return value_;
 }
 
+void vvp_fun_signal_string_sa::checkpoint(vvp_checkpoint_t&cp)
+{
+      vvp_fun_signal_base::checkpoint(cp);
+      cp.io(value_);
+}
+
 vvp_fun_signal_string_aa::vvp_fun_signal_string_aa()
 {
       context_idx_ = vpip_add_item_to_context(this, vpip_peek_context_scope());
@@ -742,6 +781,17 @@ vvp_object_t vvp_fun_signal_object_sa::get_object() const
       return value_;
 }
 
+/*
+ * Class objects and dynamic arrays are not saved, so only a nil
+ * object variable can be restored.
+ */
+void vvp_fun_signal_object_sa::checkpoint(vvp_checkpoint_t&cp)
+{
+      vvp_fun_signal_base::checkpoint(cp);
+      if (! cp.restoring() && ! value_.test_nil())
+	    cp.unsupported("class object or dynamic array variable");
+}
+
 vvp_fun_signal_object_aa::vvp_fun_signal_object_aa()
 {
       context_idx_ = vpip_add_item_to_context(this, vpip_peek_context_scope());
@@ -1044,6 +1094,13 @@ void vvp_wire_vec4::vec4_value(vvp_vector4_t&val) const
 	    val.set_bit(idx, filtered_value_(idx));
 }
 
+const vvp_vector4_t* vvp_wire_vec4::vec4_value_ref() const
+{
+      if (test_force_mask_is_zero())
+	    return &bits4_;
+      return 0;
+}
+
 vvp_bit4_t vvp_wire_vec4::driven_value(unsigned idx) const
 {
       return bits4_.value(idx);
@@ -1054,6 +1111,14 @@ bool vvp_wire_vec4::is_forced(unsigned idx) const
       return test_force_mask(idx);
 }
 
+void vvp_wire_vec4::checkpoint(vvp_checkpoint_t&cp)
+{
+      vvp_net_fil_t::checkpoint(cp);
+      cp.io(needs_init_);
+      cp.io(bits4_);
+      cp.io(force4_);
+}
+
 vvp_wire_vec8::vvp_wire_vec8(unsigned wid)
 : bits8_(wid)
 {
@@ -1223,6 +1288,14 @@ bool vvp_wire_vec8::is_forced(unsigned idx) const
       return test_force_mask(idx);
 }
 
+void vvp_wire_vec8::checkpoint(vvp_checkpoint_t&cp)
+{
+      vvp_net_fil_t::checkpoint(cp);
+      cp.io(needs_init_);
+      cp.io(bits8_);
+      cp.io(force8_);
+}
+
 vvp_wire_real::vvp_wire_real()
 : bit_(0.0), force_(0.0)
 {
@@ -1328,6 +1401,13 @@ double vvp_wire_real::real_value() const
 	    return bit_;
 }
 
+void vvp_wire_real::checkpoint(vvp_checkpoint_t&cp)
+{
+      vvp_net_fil_t::checkpoint(cp);
+      cp.io(bit_);
+      cp.io(force_);
+}
+
 #if 0
 vvp_wire_string::vvp_wire_string()
 {
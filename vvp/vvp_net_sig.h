@@ -75,6 +75,8 @@ class vvp_fun_signal_base : public vvp_net_fun_t {
       void deassign();
       void deassign_pv(unsigned base, unsigned wid);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     public:
 
 	/* The %cassign/link instruction needs a place to write the
@@ -103,6 +105,10 @@ class vvp_signal_value {
       virtual vvp_scalar_t scalar_value(unsigned idx) const =0;
       virtual void vec4_value(vvp_vector4_t&) const =0;
       virtual double real_value() const;
+	// Return the vector that holds the value, if there is one,
+	// so that the value can be read without making a copy. This
+	// returns nil if the value must be made with vec4_value().
+      virtual const vvp_vector4_t* vec4_value_ref() const;
 
       virtual void get_signal_value(struct t_vpi_value*vp);
 };
@@ -153,6 +159,8 @@ class vvp_fun_signal4_sa : public vvp_fun_signal_vec {
 	// Get information about the vector value.
       const vvp_vector4_t& vec4_unfiltered_value() const;
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       vvp_vector4_t bits4_;
 };
@@ -221,6 +229,8 @@ class vvp_fun_signal_real_sa : public vvp_fun_signal_real {
 	// Get information about the vector value.
       double real_unfiltered_value() const;
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       double bits_;
 };
@@ -289,6 +299,8 @@ class vvp_fun_signal_string_sa : public vvp_fun_signal_string {
 
       const std::string& get_string() const;
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       std::string value_;
 };
@@ -349,6 +361,8 @@ class vvp_fun_signal_object_sa : public vvp_fun_signal_object {
 
       vvp_object_t get_object() const;
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       vvp_object_t value_;
 };
@@ -446,11 +460,14 @@ class vvp_wire_vec4 : public vvp_wire_base {
       vvp_bit4_t value(unsigned idx) const;
       vvp_scalar_t scalar_value(unsigned idx) const;
       void vec4_value(vvp_vector4_t&) const;
+      const vvp_vector4_t* vec4_value_ref() const;
 
         // Support for $countdrivers
       vvp_bit4_t driven_value(unsigned idx) const;
       bool is_forced(unsigned idx) const;
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       vvp_bit4_t filtered_value_(unsigned idx) const;
 
@@ -498,6 +515,8 @@ class vvp_wire_vec8 : public vvp_wire_base {
       vvp_bit4_t driven_value(unsigned idx) const;
       bool is_forced(unsigned idx) const;
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       vvp_scalar_t filtered_value_(unsigned idx) const;
 
@@ -534,6 +553,8 @@ class vvp_wire_real : public vvp_wire_base {
 
       void get_signal_value(struct t_vpi_value*vp);
 
+      void checkpoint(vvp_checkpoint_t&cp);
+
     private:
       double bit_;
       double force_;
@@ -0,0 +1,524 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "vvp_simd.h"
+# include  <cstring>
+
+/*
+ * The x86 kernels are compiled with per-function target attributes,
+ * so the rest of vvp does not need any special compiler flags and
+ * the choice of kernel is made at run time. Other compilers and
+ * machines get only the scalar kernels.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) \
+    && (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+# define VVP_SIMD_X86 1
+# include  <immintrin.h>
+#endif
+
+/*
+ * The scalar kernels. These are the reference implementation, and
+ * the vector kernels also use them to finish the words that do not
+ * fill a whole vector register.
+ */
+
+static void scalar_and4(unsigned long*ra, unsigned long*rb,
+			const unsigned long*xa, const unsigned long*xb,
+			unsigned n)
+{
+      for (unsigned idx = 0 ; idx < n ; idx += 1) {
+	    unsigned long tmp1 = ra[idx] | rb[idx];
+	    unsigned long tmp2 = xa[idx] | xb[idx];
+	    ra[idx] = tmp1 & tmp2;
+	    rb[idx] = (tmp1 & xb[idx]) | (tmp2 & rb[idx]);
+      }
+}
+
+static void scalar_or4(unsigned long*ra, unsigned long*rb,
+		       const unsigned long*xa, const unsigned long*xb,
+		       unsigned n)
+{
+      for (unsigned idx = 0 ; idx < n ; idx += 1) {
+	    unsigned long tmp = ra[idx] | rb[idx] | xa[idx] | xb[idx];
+	    rb[idx] = ((~ra[idx] | rb[idx]) & xb[idx]) |
+		      ((~xa[idx] | xb[idx]) & rb[idx]);
+	    ra[idx] = tmp;
+      }
+}
+
+static void scalar_xor4(unsigned long*ra, unsigned long*rb,
+			const unsigned long*xa, const unsigned long*xb,
+			unsigned n)
+{
+      for (unsigned idx = 0 ; idx < n ; idx += 1) {
+	    rb[idx] |= xb[idx];
+	    ra[idx] = (ra[idx] ^ xa[idx]) | rb[idx];
+      }
+}
+
+static void scalar_invert4(unsigned long*ra, const unsigned long*rb, unsigned n)
+{
+      for (unsigned idx = 0 ; idx < n ; idx += 1)
+	    ra[idx] = ~ra[idx] | rb[idx];
+}
+
+static bool scalar_eq(const unsigned long*x, const unsigned long*y, unsigned n)
+{
+      for (unsigned idx = 0 ; idx < n ; idx += 1) {
+	    if (x[idx] != y[idx])
+		  return false;
+      }
+      return true;
+}
+
+static bool scalar_eq_xz(const unsigned long*aa, const unsigned long*ab,
+			 const unsigned long*ba, const unsigned long*bb,
+			 unsigned n)
+{
+      for (unsigned idx = 0 ; idx < n ; idx += 1) {
+	    if ((aa[idx]|ab[idx]) != (ba[idx]|bb[idx]))
+		  return false;
+	    if (ab[idx] != bb[idx])
+		  return false;
+      }
+      return true;
+}
+
+static bool scalar_any(const unsigned long*x, unsigned n)
+{
+      for (unsigned idx = 0 ; idx < n ; idx += 1) {
+	    if (x[idx])
+		  return true;
+      }
+      return false;
+}
+
+static void scalar_reduce(const unsigned long*a, const unsigned long*b,
+			  unsigned n, vvp_simd_reduce_s&res)
+{
+      for (unsigned idx = 0 ; idx < n ; idx += 1) {
+	    res.zeros  |= ~(a[idx] | b[idx]);
+	    res.ones   |= a[idx] & ~b[idx];
+	    res.xz     |= b[idx];
+	    res.parity ^= a[idx];
+      }
+}
+
+static const vvp_simd_ops_s simd_scalar = {
+      "scalar",
+      scalar_and4,
+      scalar_or4,
+      scalar_xor4,
+      scalar_invert4,
+      scalar_eq,
+      scalar_eq_xz,
+      scalar_any,
+      scalar_reduce
+};
+
+#ifdef VVP_SIMD_X86
+
+/*
+ * The SSE4.2 kernels. Only the SSE4.1 ptest instruction is needed
+ * beyond SSE2, but SSE4.2 is the level that CPUs report together.
+ */
+
+# define SSE_WORDS (sizeof(__m128i) / sizeof(unsigned long))
+
+#define SSE_LOAD(p) _mm_loadu_si128((const __m128i*)(p))
+#define SSE_STORE(p,v) _mm_storeu_si128((__m128i*)(p), (v))
+
+__attribute__((target("sse4.2")))
+static void sse_and4(unsigned long*ra, unsigned long*rb,
+		     const unsigned long*xa, const unsigned long*xb,
+		     unsigned n)
+{
+      unsigned idx = 0;
+      for ( ; idx+SSE_WORDS <= n ; idx += SSE_WORDS) {
+	    __m128i va = SSE_LOAD(ra+idx), vb = SSE_LOAD(rb+idx);
+	    __m128i wa = SSE_LOAD(xa+idx), wb = SSE_LOAD(xb+idx);
+	    __m128i tmp1 = _mm_or_si128(va, vb);
+	    __m128i tmp2 = _mm_or_si128(wa, wb);
+	    SSE_STORE(ra+idx, _mm_and_si128(tmp1, tmp2));
+	    SSE_STORE(rb+idx, _mm_or_si128(_mm_and_si128(tmp1, wb),
+					   _mm_and_si128(tmp2, vb)));
+      }
+      scalar_and4(ra+idx, rb+idx, xa+idx, xb+idx, n-idx);
+}
+
+__attribute__((target("sse4.2")))
+static void sse_or4(unsigned long*ra, unsigned long*rb,
+		    const unsigned long*xa, const unsigned long*xb,
+		    unsigned n)
+{
+      unsigned idx = 0;
+      for ( ; idx+SSE_WORDS <= n ; idx += SSE_WORDS) {
+	    __m128i va = SSE_LOAD(ra+idx), vb = SSE_LOAD(rb+idx);
+	    __m128i wa = SSE_LOAD(xa+idx), wb = SSE_LOAD(xb+idx);
+	      // (~a | b) & c is ~(a & ~b) & c, which is andnot(andnot(b,a),c)
+	    __m128i tmp = _mm_or_si128(_mm_or_si128(va, vb), _mm_or_si128(wa, wb));
+	    __m128i one_v = _mm_andnot_si128(vb, va);
+	    __m128i one_w = _mm_andnot_si128(wb, wa);
+	    SSE_STORE(rb+idx, _mm_or_si128(_mm_andnot_si128(one_v, wb),
+					   _mm_andnot_si128(one_w, vb)));
+	    SSE_STORE(ra+idx, tmp);
+      }
+      scalar_or4(ra+idx, rb+idx, xa+idx, xb+idx, n-idx);
+}
+
+__attribute__((target("sse4.2")))
+static void sse_xor4(unsigned long*ra, unsigned long*rb,
+		     const unsigned long*xa, const unsigned long*xb,
+		     unsigned n)
+{
+      unsigned idx = 0;
+      for ( ; idx+SSE_WORDS <= n ; idx += SSE_WORDS) {
+	    __m128i vb = _mm_or_si128(SSE_LOAD(rb+idx), SSE_LOAD(xb+idx));
+	    __m128i va = _mm_xor_si128(SSE_LOAD(ra+idx), SSE_LOAD(xa+idx));
+	    SSE_STORE(rb+idx, vb);
+	    SSE_STORE(ra+idx, _mm_or_si128(va, vb));
+      }
+      scalar_xor4(ra+idx, rb+idx, xa+idx, xb+idx, n-idx);
+}
+
+__attribute__((target("sse4.2")))
+static void sse_invert4(unsigned long*ra, const unsigned long*rb, unsigned n)
+{
+      unsigned idx = 0;
+      __m128i ones = _mm_set1_epi32(-1);
+      for ( ; idx+SSE_WORDS <= n ; idx += SSE_WORDS) {
+	    __m128i va = SSE_LOAD(ra+idx), vb = SSE_LOAD(rb+idx);
+	    SSE_STORE(ra+idx, _mm_or_si128(_mm_xor_si128(va, ones), vb));
+      }
+      scalar_invert4(ra+idx, rb+idx, n-idx);
+}
+
+__attribute__((target("sse4.2")))
+static bool sse_eq(const unsigned long*x, const unsigned long*y, unsigned n)
+{
+      unsigned idx = 0;
+      for ( ; idx+SSE_WORDS <= n ; idx += SSE_WORDS) {
+	    __m128i diff = _mm_xor_si128(SSE_LOAD(x+idx), SSE_LOAD(y+idx));
+	    if (! _mm_testz_si128(diff, diff))
+		  return false;
+      }
+      return scalar_eq(x+idx, y+idx, n-idx);
+}
+
+__attribute__((target("sse4.2")))
+static bool sse_eq_xz(const unsigned long*aa, const unsigned long*ab,
+		      const unsigned long*ba, const unsigned long*bb,
+		      unsigned n)
+{
+      unsigned idx = 0;
+      for ( ; idx+SSE_WORDS <= n ; idx += SSE_WORDS) {
+	    __m128i vb = SSE_LOAD(ab+idx), wb = SSE_LOAD(bb+idx);
+	    __m128i diff = _mm_xor_si128(_mm_or_si128(SSE_LOAD(aa+idx), vb),
+					 _mm_or_si128(SSE_LOAD(ba+idx), wb));
+	    diff = _mm_or_si128(diff, _mm_xor_si128(vb, wb));
+	    if (! _mm_testz_si128(diff, diff))
+		  return false;
+      }
+      return scalar_eq_xz(aa+idx, ab+idx, ba+idx, bb+idx, n-idx);
+}
+
+__attribute__((target("sse4.2")))
+static bool sse_any(const unsigned long*x, unsigned n)
+{
+      unsigned idx = 0;
+      for ( ; idx+SSE_WORDS <= n ; idx += SSE_WORDS) {
+	    __m128i val = SSE_LOAD(x+idx);
+	    if (! _mm_testz_si128(val, val))
+		  return true;
+      }
+      return scalar_any(x+idx, n-idx);
+}
+
+__attribute__((target("sse4.2")))
+static void sse_reduce(const unsigned long*a, const unsigned long*b,
+		       unsigned n, vvp_simd_reduce_s&res)
+{
+      unsigned idx = 0;
+      __m128i zeros = _mm_setzero_si128();
+      __m128i ones = _mm_setzero_si128();
+      __m128i xz = _mm_setzero_si128();
+      __m128i parity = _mm_setzero_si128();
+      __m128i all = _mm_set1_epi32(-1);
+      for ( ; idx+SSE_WORDS <= n ; idx += SSE_WORDS) {
+	    __m128i va = SSE_LOAD(a+idx), vb = SSE_LOAD(b+idx);
+	    zeros  = _mm_or_si128(zeros, _mm_andnot_si128(_mm_or_si128(va, vb), all));
+	    ones   = _mm_or_si128(ones, _mm_andnot_si128(vb, va));
+	    xz     = _mm_or_si128(xz, vb);
+	    parity = _mm_xor_si128(parity, va);
+      }
+	// Fold the lanes of the accumulators into the result words.
+	// OR folding keeps every set bit, and XOR folding keeps the
+	// parity.
+      unsigned long tmp[4][SSE_WORDS];
+      SSE_STORE(tmp[0], zeros);
+      SSE_STORE(tmp[1], ones);
+      SSE_STORE(tmp[2], xz);
+      SSE_STORE(tmp[3], parity);
+      for (unsigned lane = 0 ; lane < SSE_WORDS ; lane += 1) {
+	    res.zeros  |= tmp[0][lane];
+	    res.ones   |= tmp[1][lane];
+	    res.xz     |= tmp[2][lane];
+	    res.parity ^= tmp[3][lane];
+      }
+      scalar_reduce(a+idx, b+idx, n-idx, res);
+}
+
+static const vvp_simd_ops_s simd_sse = {
+      "sse4.2",
+      sse_and4,
+      sse_or4,
+      sse_xor4,
+      sse_invert4,
+      sse_eq,
+      sse_eq_xz,
+      sse_any,
+      sse_reduce
+};
+
+/*
+ * The AVX2 kernels. These are the SSE kernels again, but with twice
+ * the words per register. The upper register halves are cleared
+ * before the scalar tail, because the compiler does not do it for a
+ * tail call and the stale state slows down any SSE code that runs
+ * next.
+ */
+
+# define AVX_WORDS (sizeof(__m256i) / sizeof(unsigned long))
+
+#define AVX_LOAD(p) _mm256_loadu_si256((const __m256i*)(p))
+#define AVX_STORE(p,v) _mm256_storeu_si256((__m256i*)(p), (v))
+
+__attribute__((target("avx2")))
+static void avx_and4(unsigned long*ra, unsigned long*rb,
+		     const unsigned long*xa, const unsigned long*xb,
+		     unsigned n)
+{
+      unsigned idx = 0;
+      for ( ; idx+AVX_WORDS <= n ; idx += AVX_WORDS) {
+	    __m256i va = AVX_LOAD(ra+idx), vb = AVX_LOAD(rb+idx);
+	    __m256i wa = AVX_LOAD(xa+idx), wb = AVX_LOAD(xb+idx);
+	    __m256i tmp1 = _mm256_or_si256(va, vb);
+	    __m256i tmp2 = _mm256_or_si256(wa, wb);
+	    AVX_STORE(ra+idx, _mm256_and_si256(tmp1, tmp2));
+	    AVX_STORE(rb+idx, _mm256_or_si256(_mm256_and_si256(tmp1, wb),
+					      _mm256_and_si256(tmp2, vb)));
+      }
+      _mm256_zeroupper();
+      scalar_and4(ra+idx, rb+idx, xa+idx, xb+idx, n-idx);
+}
+
+__attribute__((target("avx2")))
+static void avx_or4(unsigned long*ra, unsigned long*rb,
+		    const unsigned long*xa, const unsigned long*xb,
+		    unsigned n)
+{
+      unsigned idx = 0;
+      for ( ; idx+AVX_WORDS <= n ; idx += AVX_WORDS) {
+	    __m256i va = AVX_LOAD(ra+idx), vb = AVX_LOAD(rb+idx);
+	    __m256i wa = AVX_LOAD(xa+idx), wb = AVX_LOAD(xb+idx);
+	    __m256i tmp = _mm256_or_si256(_mm256_or_si256(va, vb),
+					  _mm256_or_si256(wa, wb));
+	    __m256i one_v = _mm256_andnot_si256(vb, va);
+	    __m256i one_w = _mm256_andnot_si256(wb, wa);
+	    AVX_STORE(rb+idx, _mm256_or_si256(_mm256_andnot_si256(one_v, wb),
+					      _mm256_andnot_si256(one_w, vb)));
+	    AVX_STORE(ra+idx, tmp);
+      }
+      _mm256_zeroupper();
+      scalar_or4(ra+idx, rb+idx, xa+idx, xb+idx, n-idx);
+}
+
+__attribute__((target("avx2")))
+static void avx_xor4(unsigned long*ra, unsigned long*rb,
+		     const unsigned long*xa, const unsigned long*xb,
+		     unsigned n)
+{
+      unsigned idx = 0;
+      for ( ; idx+AVX_WORDS <= n ; idx += AVX_WORDS) {
+	    __m256i vb = _mm256_or_si256(AVX_LOAD(rb+idx), AVX_LOAD(xb+idx));
+	    __m256i va = _mm256_xor_si256(AVX_LOAD(ra+idx), AVX_LOAD(xa+idx));
+	    AVX_STORE(rb+idx, vb);
+	    AVX_STORE(ra+idx, _mm256_or_si256(va, vb));
+      }
+      _mm256_zeroupper();
+      scalar_xor4(ra+idx, rb+idx, xa+idx, xb+idx, n-idx);
+}
+
+__attribute__((target("avx2")))
+static void avx_invert4(unsigned long*ra, const unsigned long*rb, unsigned n)
+{
+      unsigned idx = 0;
+      __m256i ones = _mm256_set1_epi32(-1);
+      for ( ; idx+AVX_WORDS <= n ; idx += AVX_WORDS) {
+	    __m256i va = AVX_LOAD(ra+idx), vb = AVX_LOAD(rb+idx);
+	    AVX_STORE(ra+idx, _mm256_or_si256(_mm256_xor_si256(va, ones), vb));
+      }
+      _mm256_zeroupper();
+      scalar_invert4(ra+idx, rb+idx, n-idx);
+}
+
+__attribute__((target("avx2")))
+static bool avx_eq(const unsigned long*x, const unsigned long*y, unsigned n)
+{
+      unsigned idx = 0;
+      for ( ; idx+AVX_WORDS <= n ; idx += AVX_WORDS) {
+	    __m256i diff = _mm256_xor_si256(AVX_LOAD(x+idx), AVX_LOAD(y+idx));
+	    if (! _mm256_testz_si256(diff, diff))
+		  return false;
+      }
+      _mm256_zeroupper();
+      return scalar_eq(x+idx, y+idx, n-idx);
+}
+
+__attribute__((target("avx2")))
+static bool avx_eq_xz(const unsigned long*aa, const unsigned long*ab,
+		      const unsigned long*ba, const unsigned long*bb,
+		      unsigned n)
+{
+      unsigned idx = 0;
+      for ( ; idx+AVX_WORDS <= n ; idx += AVX_WORDS) {
+	    __m256i vb = AVX_LOAD(ab+idx), wb = AVX_LOAD(bb+idx);
+	    __m256i diff = _mm256_xor_si256(_mm256_or_si256(AVX_LOAD(aa+idx), vb),
+					    _mm256_or_si256(AVX_LOAD(ba+idx), wb));
+	    diff = _mm256_or_si256(diff, _mm256_xor_si256(vb, wb));
+	    if (! _mm256_testz_si256(diff, diff))
+		  return false;
+      }
+      _mm256_zeroupper();
+      return scalar_eq_xz(aa+idx, ab+idx, ba+idx, bb+idx, n-idx);
+}
+
+__attribute__((target("avx2")))
+static bool avx_any(const unsigned long*x, unsigned n)
+{
+      unsigned idx = 0;
+      for ( ; idx+AVX_WORDS <= n ; idx += AVX_WORDS) {
+	    __m256i val = AVX_LOAD(x+idx);
+	    if (! _mm256_testz_si256(val, val))
+		  return true;
+      }
+      _mm256_zeroupper();
+      return scalar_any(x+idx, n-idx);
+}
+
+__attribute__((target("avx2")))
+static void avx_reduce(const unsigned long*a, const unsigned long*b,
+		       unsigned n, vvp_simd_reduce_s&res)
+{
+      unsigned idx = 0;
+      __m256i zeros = _mm256_setzero_si256();
+      __m256i ones = _mm256_setzero_si256();
+      __m256i xz = _mm256_setzero_si256();
+      __m256i parity = _mm256_setzero_si256();
+      __m256i all = _mm256_set1_epi32(-1);
+      for ( ; idx+AVX_WORDS <= n ; idx += AVX_WORDS) {
+	    __m256i va = AVX_LOAD(a+idx), vb = AVX_LOAD(b+idx);
+	    zeros  = _mm256_or_si256(zeros, _mm256_andnot_si256(_mm256_or_si256(va, vb), all));
+	    ones   = _mm256_or_si256(ones, _mm256_andnot_si256(vb, va));
+	    xz     = _mm256_or_si256(xz, vb);
+	    parity = _mm256_xor_si256(parity, va);
+      }
+	// Fold the lanes of the accumulators into the result words.
+	// OR folding keeps every set bit, and XOR folding keeps the
+	// parity.
+      unsigned long tmp[4][AVX_WORDS];
+      AVX_STORE(tmp[0], zeros);
+      AVX_STORE(tmp[1], ones);
+      AVX_STORE(tmp[2], xz);
+      AVX_STORE(tmp[3], parity);
+      for (unsigned lane = 0 ; lane < AVX_WORDS ; lane += 1) {
+	    res.zeros  |= tmp[0][lane];
+	    res.ones   |= tmp[1][lane];
+	    res.xz     |= tmp[2][lane];
+	    res.parity ^= tmp[3][lane];
+      }
+      _mm256_zeroupper();
+      scalar_reduce(a+idx, b+idx, n-idx, res);
+}
+
+static const vvp_simd_ops_s simd_avx2 = {
+      "avx2",
+      avx_and4,
+      avx_or4,
+      avx_xor4,
+      avx_invert4,
+      avx_eq,
+      avx_eq_xz,
+      avx_any,
+      avx_reduce
+};
+
+static bool cpu_supports(const vvp_simd_ops_s*ops)
+{
+      __builtin_cpu_init();
+      if (ops == &simd_avx2)
+	    return __builtin_cpu_supports("avx2");
+      if (ops == &simd_sse)
+	    return __builtin_cpu_supports("sse4.2");
+      return true;
+}
+
+static const vvp_simd_ops_s*const simd_tables[] = {
+      &simd_avx2, &simd_sse, &simd_scalar
+};
+
+#else
+
+static bool cpu_supports(const vvp_simd_ops_s*)
+{
+      return true;
+}
+
+static const vvp_simd_ops_s*const simd_tables[] = { &simd_scalar };
+
+#endif
+
+/*
+ * The pointer starts out with the scalar table, so that anything
+ * that runs during static initialization gets correct results, and
+ * is switched to the best supported table by the initializer below.
+ */
+const vvp_simd_ops_s*vvp_simd = &simd_scalar;
+
+const vvp_simd_ops_s*vvp_simd_find(const char*name)
+{
+      for (unsigned idx = 0 ; idx < sizeof simd_tables/sizeof simd_tables[0] ; idx += 1) {
+	    if (strcmp(simd_tables[idx]->name, name) != 0)
+		  continue;
+	    return cpu_supports(simd_tables[idx])? simd_tables[idx] : 0;
+      }
+      return 0;
+}
+
+static struct vvp_simd_init_s {
+      vvp_simd_init_s()
+      {
+	    for (unsigned idx = 0 ; idx < sizeof simd_tables/sizeof simd_tables[0] ; idx += 1) {
+		  if (cpu_supports(simd_tables[idx])) {
+			vvp_simd = simd_tables[idx];
+			break;
+		  }
+	    }
+      }
+} vvp_simd_init;
@@ -0,0 +1,85 @@
+#ifndef IVL_vvp_simd_H
+#define IVL_vvp_simd_H
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * These are the word kernels that the wide vvp_vector4_t operators
+ * use. Each kernel works on whole words of the abits/bbits arrays
+ * and leaves any partial last word to the caller, which knows how to
+ * mask it. The kernels are collected in a table, and the vvp_simd
+ * pointer selects at startup the best table that the running CPU
+ * supports. The scalar table is always available and all the tables
+ * produce bit-identical results.
+ */
+
+/*
+ * Accumulated masks for the reduction operators. The zeros, ones and
+ * xz members are the OR of the respective bit classes over all the
+ * words, and the parity member is the XOR of the abits words.
+ */
+struct vvp_simd_reduce_s {
+      unsigned long zeros;
+      unsigned long ones;
+      unsigned long xz;
+      unsigned long parity;
+};
+
+struct vvp_simd_ops_s {
+      const char*name;
+
+	// (ra,rb) &= (xa,xb), with the 4-value truth table.
+      void (*and4)(unsigned long*ra, unsigned long*rb,
+		   const unsigned long*xa, const unsigned long*xb, unsigned n);
+	// (ra,rb) |= (xa,xb), with the 4-value truth table.
+      void (*or4)(unsigned long*ra, unsigned long*rb,
+		  const unsigned long*xa, const unsigned long*xb, unsigned n);
+	// (ra,rb) ^= (xa,xb), with the 4-value truth table.
+      void (*xor4)(unsigned long*ra, unsigned long*rb,
+		   const unsigned long*xa, const unsigned long*xb, unsigned n);
+	// ra = ~ra | rb
+      void (*invert4)(unsigned long*ra, const unsigned long*rb, unsigned n);
+	// True if the word arrays are equal.
+      bool (*eq)(const unsigned long*x, const unsigned long*y, unsigned n);
+	// True if the (aa,ab) and (ba,bb) values match with X == Z.
+      bool (*eq_xz)(const unsigned long*aa, const unsigned long*ab,
+		    const unsigned long*ba, const unsigned long*bb, unsigned n);
+	// True if any bit of the array is set.
+      bool (*any)(const unsigned long*x, unsigned n);
+	// Accumulate the reduction masks into res.
+      void (*reduce)(const unsigned long*a, const unsigned long*b, unsigned n,
+		     struct vvp_simd_reduce_s&res);
+};
+
+/*
+ * Vectors with fewer words than this are handled inline by the
+ * vvp_vector4_t methods. The call through the table is not worth it
+ * for them.
+ */
+enum { VVP_SIMD_MIN_WORDS = 4 };
+
+extern const struct vvp_simd_ops_s*vvp_simd;
+
+/*
+ * Return the table with the given name ("scalar", "sse4.2" or
+ * "avx2"), or nil if this build or this CPU does not support it.
+ */
+extern const struct vvp_simd_ops_s*vvp_simd_find(const char*name);
+
+#endif /* IVL_vvp_simd_H */